@@ -0,0 +1,38 @@
+#include "AnimationClip.h"
+
+AnimationClip::AnimationClip()
+	: firstFrame (0)
+	, frameCount (0)
+	, frameDelay (1.0f)
+	, frameRate (1.0f)
+	, loop (true)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool AnimationClip::Initialize(int width, int height, int ncols, int first, int last, float delay, bool lp)
+{
+	if (width <= 0 || height <= 0 || first < 0 || last < first || delay <= 0.0f)
+		return false;
+	if (ncols == 0)
+		ncols = 1;
+
+	firstFrame = first;
+	frameCount = last - first + 1;
+	frameDelay = delay;
+	frameRate = 1.0f / delay;
+	loop = lp;
+
+	// Same layout as Image::SetRect
+	rects.resize(frameCount);
+	for (int i = 0; i < frameCount; ++i)
+	{
+		int frame = first + i;
+		rects[i].left = (frame % ncols) * width;
+		rects[i].right = rects[i].left + width;
+		rects[i].top = (frame / ncols) * height;
+		rects[i].bottom = rects[i].top + height;
+	}
+	return true;
+}
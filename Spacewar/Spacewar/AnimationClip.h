@@ -0,0 +1,63 @@
+#ifndef _ANIMATION_CLIP_H_
+#define _ANIMATION_CLIP_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+
+#include "Constants.h"
+#include "Graphics.h"
+
+// Time the animations run on. Advanced once per tick while the world runs,
+// an animated sprite works out its frame from this clock when it is drawn.
+// Kept in double and never reset, so times taken from it stay exact on long sessions;
+// subtract two of them before converting to float.
+class AnimationClock
+{
+public:
+	AnimationClock() : time (0.0) {}
+
+	void Update(float frameTime)	{ time += frameTime; }
+	void Reset()					{ time = 0.0; }
+	double GetTime() const			{ return time; }
+
+private:
+	double time;
+};
+
+// Frames of an animation with their source rects worked out once.
+// A clip is shared by every sprite playing it, each sprite keeps only the time it started.
+class AnimationClip
+{
+public:
+	AnimationClip();
+
+	// Frames firstFrame to lastFrame of a texture with ncols frames of width x height per row
+	bool Initialize(int width, int height, int ncols, int firstFrame, int lastFrame, float frameDelay, bool loop = true);
+
+	// Frame of the clip, 0 to GetFrameCount() - 1, elapsed seconds after it started
+	int GetFrameAt(float elapsed) const
+	{
+		int frame = elapsed > 0.0f ? (int)(elapsed * frameRate) : 0;
+		if (frame >= frameCount)
+			frame = loop ? frame % frameCount : frameCount - 1;
+		return frame;
+	}
+	// True once a clip that does not loop has shown its last frame for a whole delay
+	bool IsComplete(float elapsed) const	{ return !loop && elapsed * frameRate >= frameCount; }
+
+	const RECT& GetRect(int frame) const	{ return rects[frame]; }
+	int GetFirstFrame() const				{ return firstFrame; }
+	int GetFrameCount() const				{ return frameCount; }
+	float GetFrameDelay() const				{ return frameDelay; }
+	bool GetLoop() const					{ return loop; }
+
+private:
+	std::vector<RECT> rects;
+	int firstFrame;
+	int frameCount;
+	float frameDelay;
+	float frameRate;		// 1 / frameDelay
+	bool loop;
+};
+
+#endif // _ANIMATION_CLIP_H_
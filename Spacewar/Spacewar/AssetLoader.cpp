@@ -0,0 +1,182 @@
+#include "AssetLoader.h"
+#include "GameError.h"
+
+AssetLoader::AssetLoader()
+	: sink (NULL)
+	, pending (0)
+	, stopping (false)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+AssetLoader::~AssetLoader()
+{
+	Shutdown();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void AssetLoader::Initialize(TextureSink *s, uint32_t workers)
+{
+	sink = s;
+	stopping = false;
+
+	// The main thread creates the device textures, the rest of the cores decode
+	if (workers == 0)
+	{
+		uint32_t processors = GetProcessorCount();
+		workers = processors > 1 ? processors - 1 : 1;
+	}
+	if (workers > AssetLoaderNS::MAX_WORKERS)
+		workers = AssetLoaderNS::MAX_WORKERS;
+
+	if (!requestReady.IsCreated() || !loadDone.IsCreated())
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error creating asset loader events"));
+
+	for (uint32_t i = 0; i < workers; ++i)
+	{
+		Thread *thread = new Thread;
+		threads.push_back(thread);
+		if (!thread->Start(WorkerProc, this))
+			throw(GameError(GameErrorNS::FATAL_ERROR, "Error creating asset loader thread"));
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void AssetLoader::Shutdown()
+{
+	if (!threads.empty())
+	{
+		// Requests not started are dropped, the ones being decoded finish
+		lock.Enter();
+		stopping = true;
+		pending -= (uint32_t)requests.size();
+		requests.clear();
+		lock.Leave();
+
+		requestReady.Release((uint32_t)threads.size());
+		for (size_t i = 0; i < threads.size(); ++i)
+		{
+			threads[i]->Join();
+			delete threads[i];
+		}
+		threads.clear();
+	}
+
+	for (size_t i = 0; i < completed.size(); ++i)
+		Release(completed[i]);
+	completed.clear();
+	pending = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void AssetLoader::Queue(uint32_t id, const char *file, uint32_t transcolor)
+{
+	if (file == NULL || threads.empty())
+		return;
+
+	AssetLoad load;
+	load.id = id;
+	load.file = file;
+	load.transcolor = transcolor;
+	load.copy = NULL;
+
+	lock.Enter();
+	requests.push_back(load);
+	pending++;
+	lock.Leave();
+	requestReady.Release(1);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool AssetLoader::Poll(AssetLoad &load)
+{
+	bool taken = false;
+	lock.Enter();
+	if (!completed.empty())
+	{
+		load = completed.front();
+		completed.pop_front();
+		pending--;
+		taken = true;
+	}
+	lock.Leave();
+	return taken;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool AssetLoader::Wait(AssetLoad &load)
+{
+	while (!Poll(load))
+	{
+		if (GetPending() == 0)
+			return false;
+		// Auto reset, a completion landing between Poll and here leaves it set
+		loadDone.Wait();
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void AssetLoader::Release(AssetLoad &load)
+{
+	if (load.copy && sink)
+		sink->ReleaseImage(load.copy);
+	load.copy = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t AssetLoader::GetPending()
+{
+	lock.Enter();
+	uint32_t count = pending;
+	lock.Leave();
+	return count;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void AssetLoader::WorkerProc(void *param)
+{
+	((AssetLoader*)param)->Work();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void AssetLoader::Work()
+{
+	for (;;)
+	{
+		requestReady.Wait();
+
+		// Releases left over from dropped requests or an earlier Shutdown find the queue empty
+		lock.Enter();
+		if (stopping)
+		{
+			lock.Leave();
+			return;
+		}
+		if (requests.empty())
+		{
+			lock.Leave();
+			continue;
+		}
+		AssetLoad load = requests.front();
+		requests.pop_front();
+		lock.Leave();
+
+		load.copy = sink->DecodeImage(load.file.c_str(), load.transcolor);
+
+		lock.Enter();
+		completed.push_back(load);
+		lock.Leave();
+		loadDone.Set();
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef _ASSET_LOADER_H_
+#define _ASSET_LOADER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "TextureSink.h"
+#include "Threading.h"
+
+namespace AssetLoaderNS
+{
+	const uint32_t MAX_WORKERS = 8;
+}
+
+// A file decoded by a worker, the image is owned by whoever takes the load
+struct AssetLoad
+{
+	uint32_t id;			// as queued
+	std::string file;
+	uint32_t transcolor;
+	void *copy;				// from TextureSink::DecodeImage, NULL if decoding failed
+};
+
+// Decodes image files on worker threads. Loads are queued from the main thread, the workers
+// decode them through the sink and put them on a completion queue. With Graphics as the sink
+// the copies are system memory textures, creating the device textures is left to the main thread
+// through Graphics::AddDecodedTexture.
+class AssetLoader
+{
+public:
+	AssetLoader();
+	virtual ~AssetLoader();
+
+	// Start the workers, 0 = one per core besides the main thread.
+	// Pre: with Graphics as the sink, the device was created multithreaded, Graphics::Initialize does
+	void Initialize(TextureSink *s, uint32_t workers = 0);	// throws GameError
+	void Shutdown();		// stop the workers, call before the sink is released
+
+	void Queue(uint32_t id, const char *file, uint32_t transcolor);
+
+	// Take a completed load without waiting.
+	// Post: returns false if none has completed yet
+	bool Poll(AssetLoad &load);
+
+	// Take a completed load, waiting for one if needed.
+	// Post: returns false if no load is queued or being decoded
+	bool Wait(AssetLoad &load);
+
+	// Free the copy of a taken load that is not used
+	void Release(AssetLoad &load);
+
+	uint32_t GetPending();	// queued or being decoded or completed but not taken
+	uint32_t GetWorkerCount() const		{ return (uint32_t)threads.size(); }
+
+private:
+	static void WorkerProc(void *param);
+	void Work();
+
+private:
+	TextureSink *sink;
+	std::vector<Thread*> threads;
+	std::deque<AssetLoad> requests;
+	std::deque<AssetLoad> completed;
+	Lock lock;					// guards the queues, pending and stopping
+	Semaphore requestReady;		// counts the requests
+	Signal loadDone;			// set each time a load completes
+	uint32_t pending;
+	bool stopping;
+};
+
+#endif // _ASSET_LOADER_H_
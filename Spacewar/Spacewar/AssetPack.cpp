@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "AssetPack.h"
+
+AssetPack::AssetPack()
+	: file (INVALID_HANDLE_VALUE)
+	, mapping (NULL)
+	, view (NULL)
+	, index (NULL)
+	, count (0)
+	, size (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+AssetPack::~AssetPack()
+{
+	Close();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool AssetPack::Open(const char *packFile)
+{
+	Close();
+
+	file = CreateFile(packFile, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	size = GetFileSize(file, NULL);
+	if (size >= sizeof(AssetPackNS::Header) && size != INVALID_FILE_SIZE)
+		mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping)
+		view = (const BYTE*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL)
+	{
+		Close();
+		return false;
+	}
+
+	// The index and every entry have to lie inside the file
+	const AssetPackNS::Header *header = (const AssetPackNS::Header*)view;
+	bool valid = memcmp(header->magic, AssetPackNS::MAGIC, sizeof(header->magic)) == 0
+		&& header->version == AssetPackNS::VERSION
+		&& header->dataOffset <= size
+		&& sizeof(AssetPackNS::Header) + (UINT64)header->count * sizeof(AssetPackNS::Entry) <= header->dataOffset;
+	if (valid)
+	{
+		index = (const AssetPackNS::Entry*)(view + sizeof(AssetPackNS::Header));
+		count = header->count;
+		for (UINT i = 0; i < count && valid; ++i)
+			valid = index[i].offset >= header->dataOffset && (UINT64)index[i].offset + index[i].size <= size
+				&& (i == 0 || index[i - 1].hash < index[i].hash);
+	}
+	if (!valid)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void AssetPack::Close()
+{
+	if (view)
+		UnmapViewOfFile(view);
+	if (mapping)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+	file = INVALID_HANDLE_VALUE;
+	mapping = NULL;
+	view = NULL;
+	index = NULL;
+	count = 0;
+	size = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool AssetPack::Find(UINT64 hash, const BYTE *&data, UINT &dataSize) const
+{
+	// Binary search of the sorted index
+	UINT low = 0;
+	UINT high = count;
+	while (low < high)
+	{
+		UINT middle = (low + high) / 2;
+		if (index[middle].hash < hash)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	if (low == count || index[low].hash != hash)
+		return false;
+	data = view + index[low].offset;
+	dataSize = index[low].size;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINT64 AssetPack::HashPath(const char *path)
+{
+	if (path == NULL)
+		return 0;
+	if (path[0] == '.' && (path[1] == '/' || path[1] == '\\'))
+		path += 2;
+
+	// FNV-1a, 64 bit
+	UINT64 hash = 14695981039346656037ULL;
+	for (const char *c = path; *c; ++c)
+	{
+		BYTE b = (BYTE)(*c == '\\' ? '/' : tolower((unsigned char)*c));
+		hash = (hash ^ b) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int AssetPack::Build(const char *sourceDir, const char *packFile)
+{
+	std::vector<std::string> files;
+	ListFiles(sourceDir, files);
+
+	// Index sorted by hash, two paths with the same hash cannot be told apart
+	std::vector<AssetPackNS::Entry> entries(files.size());
+	std::vector<std::pair<UINT64, size_t> > order(files.size());
+	for (size_t i = 0; i < files.size(); ++i)
+		order[i] = std::make_pair(HashPath(files[i].c_str()), i);
+	std::sort(order.begin(), order.end());
+	for (size_t i = 1; i < order.size(); ++i)
+	{
+		if (order[i].first == order[i - 1].first)
+			return -1;
+	}
+
+	FILE *fp = fopen(packFile, "wb");
+	if (fp == NULL)
+		return -1;
+
+	AssetPackNS::Header header;
+	memcpy(header.magic, AssetPackNS::MAGIC, sizeof(header.magic));
+	header.version = AssetPackNS::VERSION;
+	header.reserved = 0;
+	header.count = (UINT32)files.size();
+	header.dataOffset = sizeof(header) + header.count * sizeof(AssetPackNS::Entry);
+	header.dataOffset = (header.dataOffset + AssetPackNS::ALIGNMENT - 1) / AssetPackNS::ALIGNMENT * AssetPackNS::ALIGNMENT;
+
+	// Contents first, the index is written over its place once the offsets are known
+	bool written = fseek(fp, header.dataOffset, SEEK_SET) == 0;
+	UINT offset = header.dataOffset;
+	std::vector<BYTE> contents;
+	for (size_t i = 0; i < order.size() && written; ++i)
+	{
+		const std::string &path = files[order[i].second];
+		FILE *source = fopen(path.c_str(), "rb");
+		if (source == NULL)
+		{
+			written = false;
+			break;
+		}
+		fseek(source, 0, SEEK_END);
+		long length = ftell(source);
+		fseek(source, 0, SEEK_SET);
+		contents.resize(length > 0 ? length + AssetPackNS::ALIGNMENT : AssetPackNS::ALIGNMENT, 0);
+		written = length >= 0 && (length == 0 || fread(&contents[0], 1, length, source) == (size_t)length);
+		fclose(source);
+
+		UINT padded = (length + AssetPackNS::ALIGNMENT - 1) / AssetPackNS::ALIGNMENT * AssetPackNS::ALIGNMENT;
+		memset(&contents[0] + length, 0, padded - length);
+		written = written && (padded == 0 || fwrite(&contents[0], 1, padded, fp) == padded);
+
+		entries[i].hash = order[i].first;
+		entries[i].offset = offset;
+		entries[i].size = (UINT32)length;
+		offset += padded;
+	}
+
+	written = written && fseek(fp, 0, SEEK_SET) == 0
+		&& fwrite(&header, 1, sizeof(header), fp) == sizeof(header)
+		&& (entries.empty() || fwrite(&entries[0], sizeof(AssetPackNS::Entry), entries.size(), fp) == entries.size());
+	fclose(fp);
+	if (!written)
+	{
+		remove(packFile);
+		return -1;
+	}
+	return (int)files.size();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void AssetPack::ListFiles(const std::string &dir, std::vector<std::string> &files)
+{
+	WIN32_FIND_DATA found;
+	HANDLE search = FindFirstFile((dir + "/*").c_str(), &found);
+	if (search == INVALID_HANDLE_VALUE)
+		return;
+	do
+	{
+		std::string name = found.cFileName;
+		if (name == "." || name == "..")
+			continue;
+		if (found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			ListFiles(dir + "/" + name, files);
+		else
+			files.push_back(dir + "/" + name);
+	} while (FindNextFile(search, &found));
+	FindClose(search);
+}
@@ -0,0 +1,76 @@
+#ifndef _ASSET_PACK_H_
+#define _ASSET_PACK_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <string>
+#include <vector>
+
+#include "Constants.h"
+
+// All asset files in one file that is mapped into memory.
+// The pack starts with a Header, then Header.count Entries sorted by hash, then the file contents.
+// Paths are hashed the way TextureRegistry interns them: case, slash direction and a leading "./" do not matter.
+namespace AssetPackNS
+{
+	const char MAGIC[4] = { 'M', 'R', 'P', 'K' };
+	const WORD VERSION = 1;
+	const char DEFAULT_FILE[] = "./assets.mrp";
+	const char SOURCE_DIR[] = "./Assets";
+	const UINT ALIGNMENT = 16;		// file contents start on this boundary
+
+	struct Header
+	{
+		char magic[4];
+		WORD version;
+		WORD reserved;
+		UINT32 count;
+		UINT32 dataOffset;		// first byte after the index
+	};
+
+	struct Entry
+	{
+		UINT64 hash;			// of the normalized path
+		UINT32 offset;			// from the start of the pack
+		UINT32 size;
+	};
+}
+
+class AssetPack
+{
+public:
+	AssetPack();
+	virtual ~AssetPack();
+
+	// Map a pack into memory.
+	// Post: returns false if it is missing or damaged
+	bool Open(const char *file = AssetPackNS::DEFAULT_FILE);
+	void Close();
+
+	// Contents of file, pointing into the mapped pack. Safe to call from any thread once open.
+	// Post: returns false if the pack does not hold file
+	bool Find(const char *file, const BYTE *&data, UINT &size) const		{ return Find(HashPath(file), data, size); }
+	bool Find(UINT64 hash, const BYTE *&data, UINT &size) const;
+
+	// Pack every file under sourceDir, paths are stored as sourceDir/relative path.
+	// Post: returns the number of files packed, -1 if the pack cannot be written
+	static int Build(const char *sourceDir, const char *file);
+
+	static UINT64 HashPath(const char *file);
+
+	// Every file under dir and its subfolders, as dir/relative path
+	static void ListFiles(const std::string &dir, std::vector<std::string> &files);
+
+	bool IsOpen() const			{ return view != NULL; }
+	UINT GetCount() const		{ return count; }
+	UINT GetSize() const		{ return size; }
+
+private:
+	HANDLE file;
+	HANDLE mapping;
+	const BYTE *view;
+	const AssetPackNS::Entry *index;
+	UINT count;
+	UINT size;
+};
+
+#endif // _ASSET_PACK_H_
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "BakedTexture.h"
+#include "ShadowCache.h"
+
+BakedTexture::BakedTexture()
+{
+	ZeroMemory(&header, sizeof(header));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+std::string BakedTexture::GetCachePath(const char *file, COLOR_ARGB transcolor)
+{
+	// One flat folder, the path separators become part of the name
+	std::string path = BakedTextureNS::CACHE_DIR;
+	if (file[0] == '.' && (file[1] == '/' || file[1] == '\\'))
+		file += 2;
+	for (const char *c = file; *c; ++c)
+		path += (*c == '/' || *c == '\\' || *c == ':') ? '_' : *c;
+
+	char color[16];
+	_snprintf(color, sizeof(color), "_%08X", (UINT)transcolor);
+	return path + color + BakedTextureNS::EXTENSION;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINT64 BakedTexture::HashSource(const BYTE *data, UINT size, COLOR_ARGB transcolor)
+{
+	UINT64 hash = Hash(14695981039346656037ULL, data, size);
+	BYTE key[4] = { (BYTE)transcolor, (BYTE)(transcolor >> 8), (BYTE)(transcolor >> 16), (BYTE)(transcolor >> 24) };
+	return Hash(hash, key, sizeof(key));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINT64 BakedTexture::Hash(UINT64 hash, const BYTE *bytes, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	return hash;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool BakedTexture::Open(const char *cacheFile, UINT64 hash)
+{
+	data.clear();
+	FILE *fp = fopen(cacheFile, "rb");
+	if (fp == NULL)
+		return false;
+
+	bool valid = fread(&header, 1, sizeof(header), fp) == sizeof(header)
+		&& memcmp(header.magic, BakedTextureNS::MAGIC, sizeof(header.magic)) == 0
+		&& header.version == BakedTextureNS::VERSION && header.sourceHash == hash
+		&& header.width > 0 && header.height > 0 && header.dataSize > 0;
+	if (valid && !(header.flags & BakedTextureNS::PACKED))
+		valid = header.dataSize == header.width * header.height;
+	if (valid)
+	{
+		data.resize(header.dataSize);
+		valid = fread(&data[0], sizeof(DWORD), data.size(), fp) == data.size();
+	}
+	fclose(fp);
+
+	if (!valid)
+	{
+		data.clear();
+		ZeroMemory(&header, sizeof(header));
+	}
+	return valid;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void BakedTexture::CopyTo(DWORD *dest, UINT pitch) const
+{
+	if (data.empty())
+		return;
+	if (header.flags & BakedTextureNS::PACKED)
+	{
+		ShadowCache::Unpack((const uint32_t*)&data[0], data.size(), (uint32_t*)dest, pitch, header.width);
+		return;
+	}
+	for (UINT y = 0; y < header.height; ++y)
+		memcpy(dest + y * pitch, &data[y * header.width], header.width * sizeof(DWORD));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool BakedTexture::Write(const char *cacheFile, UINT64 hash, COLOR_ARGB transcolor, const DWORD *pixels, UINT pitch, UINT width, UINT height)
+{
+	if (pixels == NULL || width == 0 || height == 0)
+		return false;
+
+	BakedTextureNS::Header out;
+	ZeroMemory(&out, sizeof(out));
+	memcpy(out.magic, BakedTextureNS::MAGIC, sizeof(out.magic));
+	out.version = BakedTextureNS::VERSION;
+	out.sourceHash = hash;
+	out.width = width;
+	out.height = height;
+	out.transcolor = transcolor;
+	for (UINT y = 0; y < height; ++y)
+	{
+		const DWORD *row = pixels + y * pitch;
+		UINT x = 0;
+		while (x < width && (row[x] >> 24) == 0xff)
+			++x;
+		if (x == width)
+			out.opaqueRows++;
+	}
+	if (out.opaqueRows == height)
+		out.flags |= BakedTextureNS::OPAQUE;
+
+	// Packed when it saves at least a quarter, like the shadows
+	std::vector<uint32_t> runs;
+	if (ShadowCache::Pack((const uint32_t*)pixels, pitch, width, height, runs, width * height * 3 / 4) > 0)
+		out.flags |= BakedTextureNS::PACKED;
+	out.dataSize = (out.flags & BakedTextureNS::PACKED) ? (UINT32)runs.size() : width * height;
+
+	CreateDirectory(BakedTextureNS::CACHE_DIR, NULL);
+	FILE *fp = fopen(cacheFile, "wb");
+	if (fp == NULL)
+		return false;
+	bool written = fwrite(&out, 1, sizeof(out), fp) == sizeof(out);
+	if (out.flags & BakedTextureNS::PACKED)
+		written = written && fwrite(&runs[0], sizeof(uint32_t), runs.size(), fp) == runs.size();
+	else
+	{
+		for (UINT y = 0; y < height && written; ++y)
+			written = fwrite(pixels + y * pitch, sizeof(DWORD), width, fp) == width;
+	}
+	fclose(fp);
+
+	// A half written bake would be read as damaged, but is not left behind
+	if (!written)
+		remove(cacheFile);
+	return written;
+}
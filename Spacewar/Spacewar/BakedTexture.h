@@ -0,0 +1,75 @@
+#ifndef _BAKED_TEXTURE_H_
+#define _BAKED_TEXTURE_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <string>
+#include <vector>
+
+#include "Constants.h"
+#include "Graphics.h"
+
+// Image files decoded once and saved as 32 bit ARGB pixels with the color key applied.
+// Loading a baked texture is a file read and a copy into the texture.
+// The file starts with a Header followed by the pixels, row after row or as runs of equal pixels.
+namespace BakedTextureNS
+{
+	const char MAGIC[4] = { 'M', 'R', 'B', 'T' };
+	const WORD VERSION = 1;
+	const char CACHE_DIR[] = "./Cache/";
+	const char EXTENSION[] = ".mbt";
+
+	// Header flags
+	const WORD PACKED = 0x01;		// pixels stored as ShadowCache runs
+	const WORD OPAQUE = 0x02;		// every pixel has alpha 255
+
+	struct Header
+	{
+		char magic[4];
+		WORD version;
+		WORD flags;
+		UINT64 sourceHash;		// content of the source file and the color key, a different hash means a stale bake
+		UINT32 width;
+		UINT32 height;
+		UINT32 transcolor;
+		UINT32 dataSize;		// DWORDs after the header
+		UINT32 opaqueRows;		// rows with alpha 255 in every pixel
+		UINT32 reserved;
+	};
+}
+
+class BakedTexture
+{
+public:
+	BakedTexture();
+
+	// Cache file of file baked with transcolor, in CACHE_DIR
+	static std::string GetCachePath(const char *file, COLOR_ARGB transcolor);
+
+	// Hash of the bytes of a source file and transcolor
+	static UINT64 HashSource(const BYTE *data, UINT size, COLOR_ARGB transcolor);
+
+	// Read a cache file.
+	// Post: returns false if it is missing, damaged or not baked from a source with hash
+	bool Open(const char *cacheFile, UINT64 hash);
+
+	// Copy the pixels into dest, rows pitch pixels apart. Pre: Open succeeded
+	void CopyTo(DWORD *dest, UINT pitch) const;
+
+	// Bake width x height pixels, rows pitch pixels apart, into cacheFile.
+	// Post: returns false if the file cannot be written
+	static bool Write(const char *cacheFile, UINT64 hash, COLOR_ARGB transcolor, const DWORD *pixels, UINT pitch, UINT width, UINT height);
+
+	UINT GetWidth() const			{ return header.width; }
+	UINT GetHeight() const			{ return header.height; }
+	WORD GetFlags() const			{ return header.flags; }
+	UINT GetOpaqueRows() const		{ return header.opaqueRows; }
+
+private:
+	static UINT64 Hash(UINT64 hash, const BYTE *bytes, size_t count);	// FNV-1a, 64 bit
+
+private:
+	BakedTextureNS::Header header;
+	std::vector<DWORD> data;
+};
+
+#endif // _BAKED_TEXTURE_H_
@@ -0,0 +1,16 @@
+#ifndef _BENCHMARK_FILES_H_
+#define _BENCHMARK_FILES_H_
+#define WIN32_LEAN_AND_MEAN
+
+// Files the benchmarks decode, shared by the /bench commands and the benchmarks in Spacewar/Tests
+namespace BenchmarkFilesNS
+{
+	// Startup textures and a few backgrounds, decoded by the load benchmarks
+	const char *const STARTUP_FILES[] = { "./Assets/Platforms/grassMid.png", "./Assets/Player/player_red.png",
+		"./Assets/Enemies/spinnerHalf.png", "./Assets/Enemies/fly.png", "./Assets/Items/coinGold.png",
+		"./Assets/Items/gemBlue.png", "./Assets/HUD/hud.png", "./Assets/Background/uncolored_forest.png",
+		"./Assets/Background/uncolored_plain.png", "./Assets/Background/uncolored_castle.png" };
+	const int STARTUP_COUNT = sizeof(STARTUP_FILES) / sizeof(STARTUP_FILES[0]);
+}
+
+#endif // _BENCHMARK_FILES_H_
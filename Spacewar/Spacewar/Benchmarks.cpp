@@ -0,0 +1,297 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "BenchmarkFiles.h"
+#include "Benchmarks.h"
+#include "RleSprite.h"
+
+using namespace BenchmarkFilesNS;
+
+namespace
+{
+	// Sprites blitted by the blit benchmark
+	const char *SPRITE_FILES[] = { "./Assets/Player/player_red.png", "./Assets/Enemies/spinnerHalf.png",
+		"./Assets/Enemies/fly.png", "./Assets/Items/coinGold.png", "./Assets/Items/gemBlue.png", "./Assets/HUD/hud.png" };
+	const int SPRITE_COUNT = sizeof(SPRITE_FILES) / sizeof(SPRITE_FILES[0]);
+	const int BLITS_PER_SPRITE = 50;
+}
+
+Benchmarks::Benchmarks()
+	: graphics (NULL)
+	, console (NULL)
+	, frequency (1)
+{
+	buffer[0] = '\0';
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Benchmarks::Initialize(Graphics *g, Console *c)
+{
+	graphics = g;
+	console = c;
+	LARGE_INTEGER f;
+	QueryPerformanceFrequency(&f);
+	frequency = f.QuadPart;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Benchmarks::Run(const std::string &command)
+{
+	if (graphics == NULL || console == NULL)
+		return false;
+
+	if (command == "/bench blit")
+		Blit();
+	else if (command == "/bench load")
+		Load();
+	else if (command == "/bench bake")
+		Bake();
+	else if (command == "/bench png")
+		Png();
+	else
+		return false;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Benchmarks::PrintHelp()
+{
+	console->print("/bench blit - time run length encoded sprite blits against blending every texel");
+	console->print("/bench load - time decoding the startup textures on one thread against the loader threads");
+	console->print("/bench bake - time decoding the startup textures from their image files against their bakes");
+	console->print("/bench png - time D3DX against PngDecoder on every PNG in the Assets folder");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Benchmarks::Blit()
+{
+	// Both blitters draw the same sprites at the same places into their own screen sized buffer
+	std::vector<DWORD> rlePixels(GAME_WIDTH * GAME_HEIGHT, GraphicsNS::BACK_COLOR);
+	std::vector<DWORD> texelPixels(rlePixels);
+	PixelBuffer rleBuffer = { &rlePixels[0], GAME_WIDTH, GAME_WIDTH, GAME_HEIGHT };
+	PixelBuffer texelBuffer = { &texelPixels[0], GAME_WIDTH, GAME_WIDTH, GAME_HEIGHT };
+	double rleMs = 0.0;
+	double texelMs = 0.0;
+
+	for (int i = 0; i < SPRITE_COUNT; ++i)
+	{
+		RleSprite sprite;
+		if (!sprite.Initialize(graphics, SPRITE_FILES[i]))
+		{
+			Print("Unable to load %s", SPRITE_FILES[i]);
+			continue;
+		}
+
+		RECT rect = { 0, 0, (LONG)sprite.GetWidth(), (LONG)sprite.GetHeight() };
+		LONGLONG start = Now();
+		for (int j = 0; j < BLITS_PER_SPRITE; ++j)
+			sprite.Blit(rleBuffer, j * 37 % GAME_WIDTH, j * 53 % GAME_HEIGHT, rect);
+		rleMs += GetMs(start);
+
+		start = Now();
+		for (int j = 0; j < BLITS_PER_SPRITE; ++j)
+			RleSprite::BlitTexels(texelBuffer, sprite.GetTexels(), sprite.GetWidth(), j * 37 % GAME_WIDTH, j * 53 % GAME_HEIGHT, rect);
+		texelMs += GetMs(start);
+
+		Print("%s: %u runs, %.0f%% transparent", SPRITE_FILES[i], sprite.GetRunCount(), sprite.GetSkipFraction() * 100.0f);
+	}
+
+	bool match = rlePixels == texelPixels;
+	Print("Runs %.2f ms, texels %.2f ms (%.1fx), output %s", rleMs, texelMs,
+		rleMs > 0.0 ? texelMs / rleMs : 0.0, match ? "matches" : "differs");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Benchmarks::Load()
+{
+	// Only the decoding is timed, nothing is uploaded or drawn
+	int failed = 0;
+	LONGLONG start = Now();
+	for (int i = 0; i < STARTUP_COUNT; ++i)
+	{
+		LP_TEXTURE copy = NULL;
+		if (FAILED(graphics->DecodeTexture(STARTUP_FILES[i], TRANSCOLOR, copy)))
+			failed++;
+		SafeRelease(copy);
+	}
+	double serialMs = GetMs(start);
+
+	// A loader of its own, the game's one may be busy with the background
+	AssetLoader workers;
+	workers.Initialize(graphics);
+	start = Now();
+	for (int i = 0; i < STARTUP_COUNT; ++i)
+		workers.Queue(i, STARTUP_FILES[i], TRANSCOLOR);
+	AssetLoad load;
+	while (workers.Wait(load))
+	{
+		if (load.copy == NULL)
+			failed++;
+		workers.Release(load);
+	}
+	double parallelMs = GetMs(start);
+	UINT threads = workers.GetWorkerCount();
+	workers.Shutdown();
+
+	Print("%d files: 1 thread %.1f ms, %u threads %.1f ms (%.1fx)%s", STARTUP_COUNT, serialMs, threads, parallelMs,
+		parallelMs > 0.0 ? serialMs / parallelMs : 0.0, failed ? ", some files failed" : "");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Benchmarks::Bake()
+{
+	bool baking = graphics->GetBaking();
+	double ms[2];
+	int failed = 0;
+
+	// First pass decodes the image files, the second reads their bakes (written now if missing)
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		graphics->SetBaking(pass == 1);
+		if (pass == 1)
+		{
+			for (int i = 0; i < STARTUP_COUNT; ++i)
+			{
+				LP_TEXTURE copy = NULL;
+				graphics->DecodeTexture(STARTUP_FILES[i], TRANSCOLOR, copy);
+				SafeRelease(copy);
+			}
+		}
+
+		LONGLONG start = Now();
+		for (int i = 0; i < STARTUP_COUNT; ++i)
+		{
+			LP_TEXTURE copy = NULL;
+			if (FAILED(graphics->DecodeTexture(STARTUP_FILES[i], TRANSCOLOR, copy)))
+				failed++;
+			SafeRelease(copy);
+		}
+		ms[pass] = GetMs(start);
+	}
+	graphics->SetBaking(baking);
+
+	Print("%d files: image files %.1f ms, baked %.1f ms (%.1fx)%s", STARTUP_COUNT, ms[0], ms[1],
+		ms[1] > 0.0 ? ms[0] / ms[1] : 0.0, failed ? ", some files failed" : "");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Benchmarks::Png()
+{
+	std::vector<std::string> files;
+	AssetPack::ListFiles(AssetPackNS::SOURCE_DIR, files);
+	for (size_t i = files.size(); i-- > 0; )
+	{
+		if (files[i].size() < 4 || _stricmp(files[i].c_str() + files[i].size() - 4, ".png") != 0)
+			files.erase(files.begin() + i);
+	}
+
+	// Bakes are turned off so every pass decodes, the files are read in every pass
+	bool baking = graphics->GetBaking();
+	bool pngDecoding = graphics->GetPngDecoding();
+	graphics->SetBaking(false);
+	double ms[2] = { 0.0, 0.0 };
+	int failed = 0;
+	int differ = 0;
+
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		// D3DX then PngDecoder, the pixels have to match
+		LP_TEXTURE copies[2] = { NULL, NULL };
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			graphics->SetPngDecoding(pass == 1);
+			LONGLONG start = Now();
+			if (FAILED(graphics->DecodeTexture(files[i].c_str(), TRANSCOLOR, copies[pass])))
+				failed++;
+			ms[pass] += GetMs(start);
+		}
+
+		D3DSURFACE_DESC desc[2];
+		D3DLOCKED_RECT locked[2];
+		if (copies[0] && copies[1] && SUCCEEDED(copies[0]->GetLevelDesc(0, &desc[0])) && SUCCEEDED(copies[1]->GetLevelDesc(0, &desc[1]))
+			&& desc[0].Format == desc[1].Format && desc[0].Width == desc[1].Width && desc[0].Height == desc[1].Height
+			&& SUCCEEDED(copies[0]->LockRect(0, &locked[0], NULL, D3DLOCK_READONLY)))
+		{
+			if (SUCCEEDED(copies[1]->LockRect(0, &locked[1], NULL, D3DLOCK_READONLY)))
+			{
+				for (UINT y = 0; y < desc[0].Height; ++y)
+				{
+					if (memcmp((BYTE*)locked[0].pBits + y * locked[0].Pitch, (BYTE*)locked[1].pBits + y * locked[1].Pitch,
+						desc[0].Width * sizeof(DWORD)) != 0)
+					{
+						differ++;
+						console->print(files[i] + " differs");
+						break;
+					}
+				}
+				copies[1]->UnlockRect(0);
+			}
+			copies[0]->UnlockRect(0);
+		}
+		else if (copies[0] && copies[1])
+		{
+			differ++;
+			console->print(files[i] + " decodes to another format");
+		}
+		SafeRelease(copies[0]);
+		SafeRelease(copies[1]);
+	}
+
+	// Every file at once on the loader threads
+	AssetLoader workers;
+	workers.Initialize(graphics);
+	LONGLONG start = Now();
+	for (size_t i = 0; i < files.size(); ++i)
+		workers.Queue((UINT)i, files[i].c_str(), TRANSCOLOR);
+	AssetLoad load;
+	while (workers.Wait(load))
+		workers.Release(load);
+	double parallelMs = GetMs(start);
+	UINT threads = workers.GetWorkerCount();
+	workers.Shutdown();
+
+	graphics->SetBaking(baking);
+	graphics->SetPngDecoding(pngDecoding);
+	Print("%u files: D3DX %.1f ms, PngDecoder %.1f ms (%.1fx), %u threads %.1f ms",
+		(UINT)files.size(), ms[0], ms[1], ms[1] > 0.0 ? ms[0] / ms[1] : 0.0, threads, parallelMs);
+	Print("%d differ, %d failed", differ, failed);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+LONGLONG Benchmarks::Now() const
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return now.QuadPart;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+double Benchmarks::GetMs(LONGLONG start) const
+{
+	return (Now() - start) * 1000.0 / frequency;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Benchmarks::Print(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	_vsnprintf(buffer, BenchmarksNS::BUFFER_SIZE, format, args);
+	va_end(args);
+	buffer[BenchmarksNS::BUFFER_SIZE - 1] = '\0';	// not terminated when truncated
+	console->print(buffer);
+}
@@ -0,0 +1,47 @@
+#ifndef _BENCHMARKS_H_
+#define _BENCHMARKS_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <string>
+
+#include "Console.h"
+#include "Constants.h"
+#include "Graphics.h"
+
+namespace BenchmarksNS
+{
+	const int BUFFER_SIZE = 128;	// characters of a line printed
+}
+
+// Asset pipeline benchmarks run from the console with /bench. Each one decodes or blits
+// the game's image files the ways the engine can and prints how long each way took.
+class Benchmarks
+{
+public:
+	Benchmarks();
+
+	void Initialize(Graphics *g, Console *c);
+
+	// Run the benchmark of a "/bench name" console command.
+	// Post: returns false if command is not one
+	bool Run(const std::string &command);
+	void PrintHelp();
+
+	void Blit();	// run length encoded sprite blits against blending every texel
+	void Load();	// the startup textures decoded on one thread against the loader threads
+	void Bake();	// the startup textures decoded from their image files against their bakes
+	void Png();		// D3DX against PngDecoder on every PNG in the Assets folder
+
+private:
+	LONGLONG Now() const;
+	double GetMs(LONGLONG start) const;		// milliseconds since start, a value of Now
+	void Print(const char *format, ...);
+
+private:
+	Graphics *graphics;
+	Console *console;
+	LONGLONG frequency;		// performance counter ticks per second
+	char buffer[BenchmarksNS::BUFFER_SIZE];
+};
+
+#endif // _BENCHMARKS_H_
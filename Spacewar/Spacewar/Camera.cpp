@@ -0,0 +1,35 @@
+#include <math.h>
+
+#include "Camera.h"
+
+Camera::Camera()
+	: x (0.0f)
+	, y (0.0f)
+	, speed (0.0f)
+	, origin (0.0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Camera::Reset()
+{
+	x = 0.0f;
+	y = 0.0f;
+	speed = 0.0f;
+	origin = 0.0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float Camera::Rebase()
+{
+	if (x < CameraNS::REBASE_DISTANCE)
+		return 0.0f;
+
+	// Whole pixels, positions near the camera are shifted without rounding
+	float shift = floorf(x);
+	x -= shift;
+	origin += shift;
+	return shift;
+}
@@ -0,0 +1,52 @@
+#ifndef _CAMERA_H_
+#define _CAMERA_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include "Constants.h"
+#include "Graphics.h"
+
+namespace CameraNS
+{
+	const float REBASE_DISTANCE = 32768.0f;	// the origin follows the camera once it is this far away
+}
+
+// Scroll position over the world. Level content keeps fixed world coordinates while the
+// camera moves over it, drawing subtracts the camera position (see Graphics::SetView).
+// Floats lose precision far from the origin, so Rebase moves the origin to the camera
+// once it passed REBASE_DISTANCE and everything in world coordinates is shifted back with it.
+class Camera
+{
+public:
+	Camera();
+
+	void Reset();	// back to the origin, stopped
+
+	// Scroll by speed * frameTime to the right
+	void Update(float frameTime)	{ x += speed * frameTime; }
+	void SetSpeed(float s)			{ speed = s; }
+	float GetSpeed() const			{ return speed; }
+
+	// Edges of the screen in world coordinates
+	float GetX() const				{ return x; }
+	float GetY() const				{ return y; }
+	float GetRight() const			{ return x + GAME_WIDTH; }
+	// Distance scrolled since Reset, not affected by rebasing
+	double GetDistance() const		{ return origin + x; }
+	// Distance the camera left edge reaches world x at
+	double ToDistance(float worldX) const	{ return origin + worldX; }
+
+	// Move the origin to the camera when it is far enough.
+	// Post: returns the distance the origin moved, subtract it from every world x. 0 if it did not move
+	float Rebase();
+
+	// Draw in world coordinates from now on, until the view is set back to 0, 0
+	void Apply(Graphics *graphics) const	{ graphics->SetView(x, y); }
+
+private:
+	float x;
+	float y;
+	float speed;
+	double origin;	// world distance of x = 0
+};
+
+#endif // _CAMERA_H_
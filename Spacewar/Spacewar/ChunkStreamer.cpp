@@ -0,0 +1,161 @@
+#include <limits.h>
+#include <process.h>
+
+#include "ChunkStreamer.h"
+
+ChunkStreamer::ChunkStreamer()
+	: generator (NULL)
+	, thread (NULL)
+	, freeReady (NULL)
+	, seed (0)
+	, nextIndex (0)
+	, restarts (0)
+	, stopping (false)
+{
+	InitializeCriticalSection(&lock);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ChunkStreamer::~ChunkStreamer()
+{
+	Shutdown();
+	DeleteCriticalSection(&lock);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::Initialize(const LevelGenerator *g, UINT s)
+{
+	generator = g;
+	seed = s;
+	nextIndex = 0;
+	stopping = false;
+	readyChunks.clear();
+	freeChunks.clear();
+	for (int i = 0; i < ChunkStreamerNS::POOL_SIZE; ++i)
+		freeChunks.push_back(&pool[i]);
+
+	freeReady = CreateSemaphore(NULL, ChunkStreamerNS::POOL_SIZE, LONG_MAX, NULL);
+	if (freeReady == NULL)
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error creating chunk streamer semaphore"));
+
+	thread = (HANDLE)_beginthreadex(NULL, 0, WorkerProc, this, 0, NULL);
+	if (thread == NULL)
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error creating chunk streamer thread"));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::Shutdown()
+{
+	if (thread)
+	{
+		EnterCriticalSection(&lock);
+		stopping = true;
+		LeaveCriticalSection(&lock);
+
+		ReleaseSemaphore(freeReady, 1, NULL);
+		WaitForSingleObject(thread, INFINITE);
+		CloseHandle(thread);
+		thread = NULL;
+	}
+
+	if (freeReady)
+		CloseHandle(freeReady);
+	freeReady = NULL;
+	readyChunks.clear();
+	freeChunks.clear();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::Restart(UINT s)
+{
+	EnterCriticalSection(&lock);
+	seed = s;
+	nextIndex = 0;
+	restarts++;
+	LONG dropped = (LONG)readyChunks.size();
+	while (!readyChunks.empty())
+	{
+		freeChunks.push_back(readyChunks.front());
+		readyChunks.pop_front();
+	}
+	LeaveCriticalSection(&lock);
+
+	// A chunk being generated now goes back to the pool when it is done
+	if (dropped > 0)
+		ReleaseSemaphore(freeReady, dropped, NULL);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+LevelChunk* ChunkStreamer::Poll()
+{
+	LevelChunk *chunk = NULL;
+	EnterCriticalSection(&lock);
+	if (!readyChunks.empty())
+	{
+		chunk = readyChunks.front();
+		readyChunks.pop_front();
+	}
+	LeaveCriticalSection(&lock);
+	return chunk;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::Retire(LevelChunk *chunk)
+{
+	if (chunk == NULL || freeReady == NULL)
+		return;
+
+	EnterCriticalSection(&lock);
+	freeChunks.push_back(chunk);
+	LeaveCriticalSection(&lock);
+	ReleaseSemaphore(freeReady, 1, NULL);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+unsigned __stdcall ChunkStreamer::WorkerProc(void *param)
+{
+	((ChunkStreamer*)param)->Work();
+	return 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ChunkStreamer::Work()
+{
+	for (;;)
+	{
+		WaitForSingleObject(freeReady, INFINITE);
+
+		EnterCriticalSection(&lock);
+		if (stopping || freeChunks.empty())
+		{
+			LeaveCriticalSection(&lock);
+			return;
+		}
+		LevelChunk *chunk = freeChunks.back();
+		freeChunks.pop_back();
+		UINT chunkSeed = seed;
+		int index = nextIndex++;
+		UINT restart = restarts;
+		LeaveCriticalSection(&lock);
+
+		generator->Generate(chunkSeed, index, *chunk);
+
+		EnterCriticalSection(&lock);
+		bool current = restart == restarts;
+		if (current)
+			readyChunks.push_back(chunk);
+		else
+			freeChunks.push_back(chunk);
+		LeaveCriticalSection(&lock);
+		if (!current)
+			ReleaseSemaphore(freeReady, 1, NULL);
+	}
+}
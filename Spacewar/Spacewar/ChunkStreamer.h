@@ -0,0 +1,60 @@
+#ifndef _CHUNK_STREAMER_H_
+#define _CHUNK_STREAMER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <deque>
+#include <vector>
+
+#include "Constants.h"
+#include "GameError.h"
+#include "LevelGenerator.h"
+
+namespace ChunkStreamerNS
+{
+	// Chunks in the pool. The game holds the ones queued or on screen, the worker fills
+	// the rest ahead of them, which bounds how far ahead the level is generated.
+	const int POOL_SIZE = 10;
+}
+
+// Generates level chunks on a worker thread, in order, from a pool of chunks.
+// The worker fills free chunks as long as there are any and the game takes them with Poll
+// without waiting. Chunks the camera passed go back to the pool with Retire.
+class ChunkStreamer
+{
+public:
+	ChunkStreamer();
+	virtual ~ChunkStreamer();
+
+	// Start the worker on chunk 0 of seed.
+	// Pre: the generator has its tiles set and outlives the streamer
+	void Initialize(const LevelGenerator *g, UINT seed);	// throws GameError
+	void Shutdown();
+
+	// Start over from chunk 0 of seed. Pre: every chunk taken was retired
+	void Restart(UINT seed);
+
+	// Post: returns the next chunk if it is generated, NULL if not yet
+	LevelChunk* Poll();
+	void Retire(LevelChunk *chunk);
+
+	UINT GetSeed() const		{ return seed; }
+
+private:
+	static unsigned __stdcall WorkerProc(void *param);
+	void Work();
+
+private:
+	const LevelGenerator *generator;
+	LevelChunk pool[ChunkStreamerNS::POOL_SIZE];
+	std::vector<LevelChunk*> freeChunks;
+	std::deque<LevelChunk*> readyChunks;	// in chunk order
+	HANDLE thread;
+	CRITICAL_SECTION lock;			// guards the lists, seed, nextIndex, restarts and stopping
+	HANDLE freeReady;				// semaphore, counts the free chunks
+	UINT seed;
+	int nextIndex;					// next chunk the worker generates
+	UINT restarts;					// chunks generated before a restart are dropped
+	bool stopping;
+};
+
+#endif // _CHUNK_STREAMER_H_
@@ -0,0 +1,255 @@
+#include <math.h>
+
+#include "CoverageGrid.h"
+
+CoverageGrid::CoverageGrid()
+	: screenWidth (0)
+	, screenHeight (0)
+	, bandCount (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void CoverageGrid::Reset(int w, int h)
+{
+	const int band = CoverageGridNS::BAND_HEIGHT;
+
+	screenWidth = w;
+	screenHeight = h;
+	bandCount = (h + band - 1) / band;
+	if ((int)bands.size() < bandCount)
+		bands.resize(bandCount);
+	for (int i = 0; i < bandCount; ++i)
+		bands[i].clear();	// keeps the capacity between flushes
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool CoverageGrid::IsCovered(float left, float top, float right, float bottom) const
+{
+	const int band = CoverageGridNS::BAND_HEIGHT;
+
+	// Only the on screen part matters
+	if (left < 0.0f)
+		left = 0.0f;
+	if (top < 0.0f)
+		top = 0.0f;
+	if (right > (float)screenWidth)
+		right = (float)screenWidth;
+	if (bottom > (float)screenHeight)
+		bottom = (float)screenHeight;
+	if (left >= right || top >= bottom)
+		return false;
+
+	int lastBand = ((int)ceilf(bottom) - 1) / band;
+	for (int i = (int)top / band; i <= lastBand; ++i)
+	{
+		// Spans are merged, one of them has to hold the whole width
+		const std::vector<Span> &spans = bands[i];
+		bool covered = false;
+		for (size_t j = 0; j < spans.size() && spans[j].left <= left; ++j)
+		{
+			if (spans[j].right >= right)
+			{
+				covered = true;
+				break;
+			}
+		}
+		if (!covered)
+			return false;
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void CoverageGrid::CoverOpaque(const SpriteData &spriteData, COLOR_ARGB color, const OpacityMap &opacity)
+{
+	const int band = CoverageGridNS::BAND_HEIGHT;
+	const LONG block = (LONG)OpacityMapNS::BLOCK_SIZE;
+	const RECT &rect = spriteData.rect;
+	const float scale = spriteData.scale;
+
+	if (spriteData.angle != 0.0f || scale <= 0.0f || (color >> 24) != 0xff)
+		return;
+	if (rect.right - rect.left != spriteData.width || rect.bottom - rect.top != spriteData.height)
+		return;
+
+	float left = spriteData.x;
+	float top = spriteData.y;
+	float bottom = top + spriteData.height * scale;
+
+	// Bands lying inside the sprite, the last band only needs its on screen part inside
+	int firstBand = (int)ceilf(top / band);
+	if (firstBand < 0)
+		firstBand = 0;
+
+	for (int i = firstBand; i < bandCount; ++i)
+	{
+		float bandTop = (float)(i * band);
+		float bandBottom = (float)((i + 1) * band < screenHeight ? (i + 1) * band : screenHeight);
+		if (bandBottom > bottom)
+			break;
+
+		// Texel rows under the band, widened by one texel inside the texture for filtering
+		float v0 = (bandTop - top) / scale;
+		float v1 = (bandBottom - top) / scale;
+		LONG texTop = spriteData.flipVertical ? rect.bottom - (LONG)ceilf(v1) : rect.top + (LONG)floorf(v0);
+		LONG texBottom = spriteData.flipVertical ? rect.bottom - (LONG)floorf(v0) : rect.top + (LONG)ceilf(v1);
+		texTop = texTop > 0 ? texTop - 1 : 0;
+		texBottom = texBottom < (LONG)opacity.GetHeight() ? texBottom + 1 : (LONG)opacity.GetHeight();
+
+		// Runs of opaque texel columns, one opacity block at a time
+		LONG runStart = -1;
+		for (LONG x = rect.left; x <= rect.right; )
+		{
+			LONG next = (x / block + 1) * block;
+			if (next > rect.right)
+				next = rect.right;
+			bool opaque = x < rect.right && opacity.IsOpaque(x, texTop, next, texBottom);
+			if (opaque && runStart < 0)
+				runStart = x;
+			else if (!opaque && runStart >= 0)
+			{
+				// Columns next to a transparent texel inside the rect are blended by filtering
+				float runLeft = (float)(runStart > rect.left ? runStart + 1 : runStart);
+				float runRight = (float)(x < rect.right ? x - 1 : x);
+				if (runRight > runLeft)
+				{
+					if (spriteData.flipHorizontal)
+						AddSpan(i, left + (rect.right - runRight) * scale, left + (rect.right - runLeft) * scale);
+					else
+						AddSpan(i, left + (runLeft - rect.left) * scale, left + (runRight - rect.left) * scale);
+				}
+				runStart = -1;
+			}
+			if (x == rect.right)
+				break;
+			x = next;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void CoverageGrid::AddSpan(int band, float left, float right)
+{
+	if (left < 0.0f)
+		left = 0.0f;
+	if (right > (float)screenWidth)
+		right = (float)screenWidth;
+	if (left >= right)
+		return;
+
+	// Merge with every span it touches, spans stay sorted and apart
+	std::vector<Span> &spans = bands[band];
+	size_t first = 0;
+	while (first < spans.size() && spans[first].right + CoverageGridNS::SEAM < left)
+		++first;
+	size_t last = first;
+	while (last < spans.size() && spans[last].left - CoverageGridNS::SEAM <= right)
+	{
+		if (spans[last].left < left)
+			left = spans[last].left;
+		if (spans[last].right > right)
+			right = spans[last].right;
+		++last;
+	}
+
+	Span span;
+	span.left = left;
+	span.right = right;
+	spans.erase(spans.begin() + first, spans.begin() + last);
+	spans.insert(spans.begin() + first, span);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float CoverageGrid::Trim(SpriteData &spriteData) const
+{
+	const float cell = (float)CoverageGridNS::CELL_SIZE;
+	RECT &rect = spriteData.rect;
+	const float scale = spriteData.scale;
+
+	if (spriteData.angle != 0.0f || scale <= 0.0f || spriteData.flipHorizontal || spriteData.flipVertical)
+		return 0.0f;
+	if (rect.right - rect.left != spriteData.width || rect.bottom - rect.top != spriteData.height)
+		return 0.0f;
+
+	float before = (rect.right - rect.left) * (rect.bottom - rect.top) * scale * scale;
+	bool trimmed = true;
+	while (trimmed && rect.right > rect.left && rect.bottom > rect.top)
+	{
+		trimmed = false;
+		float left = spriteData.x;
+		float top = spriteData.y;
+		float right = left + (rect.right - rect.left) * scale;
+		float bottom = top + (rect.bottom - rect.top) * scale;
+
+		// Bottom: the cell row holding the last pixel row
+		float edge = floorf((bottom - 1.0f) / cell) * cell;
+		if (edge < top)
+			edge = top;
+		if (IsCovered(left, edge, right, bottom))
+		{
+			LONG newBottom = rect.top + (LONG)ceilf((edge - top) / scale);
+			if (newBottom < rect.bottom)
+			{
+				rect.bottom = newBottom;
+				trimmed = true;
+				continue;
+			}
+		}
+
+		// Top: the cell row holding the first pixel row
+		edge = (floorf(top / cell) + 1.0f) * cell;
+		if (edge > bottom)
+			edge = bottom;
+		if (IsCovered(left, top, right, edge))
+		{
+			LONG newTop = rect.top + (LONG)floorf((edge - top) / scale);
+			if (newTop > rect.top)
+			{
+				spriteData.y += (newTop - rect.top) * scale;
+				rect.top = newTop;
+				trimmed = true;
+				continue;
+			}
+		}
+
+		// Right
+		edge = floorf((right - 1.0f) / cell) * cell;
+		if (edge < left)
+			edge = left;
+		if (IsCovered(edge, top, right, bottom))
+		{
+			LONG newRight = rect.left + (LONG)ceilf((edge - left) / scale);
+			if (newRight < rect.right)
+			{
+				rect.right = newRight;
+				trimmed = true;
+				continue;
+			}
+		}
+
+		// Left
+		edge = (floorf(left / cell) + 1.0f) * cell;
+		if (edge > right)
+			edge = right;
+		if (IsCovered(left, top, edge, bottom))
+		{
+			LONG newLeft = rect.left + (LONG)floorf((edge - left) / scale);
+			if (newLeft > rect.left)
+			{
+				spriteData.x += (newLeft - rect.left) * scale;
+				rect.left = newLeft;
+				trimmed = true;
+			}
+		}
+	}
+
+	spriteData.width = rect.right - rect.left;
+	spriteData.height = rect.bottom - rect.top;
+	return before - spriteData.width * spriteData.height * scale * scale;
+}
@@ -0,0 +1,58 @@
+#ifndef _COVERAGE_GRID_H_
+#define _COVERAGE_GRID_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+
+#include "Constants.h"
+#include "Graphics.h"
+#include "OpacityMap.h"
+
+namespace CoverageGridNS
+{
+	const int BAND_HEIGHT = 32;		// screen rows per band
+	const int CELL_SIZE = 32;		// step used when trimming sprite edges
+	const float SEAM = 0.01f;		// spans closer than this are merged so sprites placed edge to edge leave no gap
+}
+
+// Screen mask of the area already covered by opaque sprites.
+// The screen is cut in horizontal bands, each band keeps sorted spans of x covered over its whole height.
+// Sprites are walked front to back: a sprite whose area is covered can be skipped,
+// and covered rows or columns at the edges of a sprite do not need to be drawn.
+class CoverageGrid
+{
+public:
+	CoverageGrid();
+
+	// Clear the mask for a screen of the given size
+	void Reset(int screenWidth, int screenHeight);
+
+	// True if the on screen part of the rectangle is covered in every band it touches.
+	// A rectangle that is completely off screen is not covered.
+	bool IsCovered(float left, float top, float right, float bottom) const;
+
+	// Add the fully opaque parts of an unrotated sprite to the bands it spans from top to bottom.
+	// Does nothing for rotated sprites or a translucent color filter.
+	void CoverOpaque(const SpriteData &spriteData, COLOR_ARGB color, const OpacityMap &opacity);
+
+	// Shrink the source rect of an unrotated, unflipped sprite so it does not draw the
+	// covered rows and columns at its edges, CELL_SIZE at a time. Returns the screen pixels removed.
+	float Trim(SpriteData &spriteData) const;
+
+private:
+	struct Span
+	{
+		float left;
+		float right;
+	};
+
+	void AddSpan(int band, float left, float right);
+
+private:
+	int screenWidth;
+	int screenHeight;
+	int bandCount;
+	std::vector< std::vector<Span> > bands;
+};
+
+#endif // _COVERAGE_GRID_H_
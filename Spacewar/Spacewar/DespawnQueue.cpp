@@ -0,0 +1,82 @@
+#include <algorithm>
+
+#include "DespawnQueue.h"
+
+DespawnQueue::DespawnQueue()
+	: count (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void DespawnQueue::Clear()
+{
+	heap.clear();
+	serials.clear();
+	scheduled.clear();
+	count = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void DespawnQueue::Schedule(int id, double distance)
+{
+	if (id < 0)
+		return;
+	if (id >= (int)serials.size())
+	{
+		serials.resize(id + 1, 0);
+		scheduled.resize(id + 1, false);
+	}
+
+	// The old event is left in the heap, it is dropped when it comes up
+	if (!scheduled[id])
+		count++;
+	serials[id]++;
+	scheduled[id] = true;
+
+	Event e;
+	e.distance = distance;
+	e.id = id;
+	e.serial = serials[id];
+	heap.push_back(e);
+	std::push_heap(heap.begin(), heap.end(), Later());
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void DespawnQueue::Cancel(int id)
+{
+	if (id < 0 || id >= (int)scheduled.size() || !scheduled[id])
+		return;
+	scheduled[id] = false;
+	count--;
+
+	// Nothing left to wait for, drop the stale events at once
+	if (count == 0)
+		heap.clear();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int DespawnQueue::PopDue(double distance)
+{
+	while (!heap.empty())
+	{
+		const Event &next = heap.front();
+		bool current = IsCurrent(next);
+		if (current && next.distance >= distance)
+			return -1;
+
+		int id = next.id;
+		std::pop_heap(heap.begin(), heap.end(), Later());
+		heap.pop_back();
+		if (current)
+		{
+			scheduled[id] = false;
+			count--;
+			return id;
+		}
+	}
+	return -1;
+}
@@ -0,0 +1,50 @@
+#ifndef _DESPAWN_QUEUE_H_
+#define _DESPAWN_QUEUE_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+
+#include "Constants.h"
+
+// Entities waiting to leave the screen, ordered by the camera distance at which they leave
+// (see Camera::ToDistance). Only the ones that are due are looked at, an entity that stays
+// put costs nothing per tick. Distances do not change with the scroll speed or a rebase.
+// Entities are known by a small id chosen by the game.
+class DespawnQueue
+{
+public:
+	DespawnQueue();
+
+	void Clear();
+
+	// Leave once the camera is past distance, replaces an earlier Schedule of id
+	void Schedule(int id, double distance);
+	void Cancel(int id);	// left some other way
+
+	// Post: returns the id of an entity due at camera distance, -1 if none is
+	int PopDue(double distance);
+
+	UINT GetCount() const		{ return count; }	// entities scheduled
+
+private:
+	struct Event
+	{
+		double distance;
+		int id;
+		UINT serial;	// stale once the id is scheduled again or cancelled
+	};
+	struct Later
+	{
+		bool operator()(const Event &a, const Event &b) const	{ return a.distance > b.distance; }
+	};
+
+	bool IsCurrent(const Event &e) const	{ return e.id < (int)serials.size() && serials[e.id] == e.serial && scheduled[e.id]; }
+
+private:
+	std::vector<Event> heap;		// min-heap on distance, may hold stale events
+	std::vector<UINT> serials;		// by id
+	std::vector<bool> scheduled;	// by id
+	UINT count;
+};
+
+#endif // _DESPAWN_QUEUE_H_
@@ -20,6 +20,10 @@ Entity::Entity() : Image()
 	collisionType = EntityNS::CIRCLE;
 	health = 100;
 	gravity = EntityNS::GRAVITY;
+	camera = NULL;
+	launchX = 0.0f;
+	launchTime = 0.0;
+	drift = 0.0f;
 }
 
 //=============================================================================
@@ -35,6 +39,8 @@ bool Entity::Initialize(Game *gamePtr, int width, int height, int ncols,
 	TextureManager *textureM)
 {
 	input = gamePtr->getInput();                // the input system
+	camera = gamePtr->GetCamera();              // world the entity lives in
+	SetClock(gamePtr->GetAnimationClock());     // animations run on game time
 	return(Image::Initialize(gamePtr->GetGraphics(), width, height, ncols, textureM));
 }
 
@@ -35,6 +35,12 @@ protected:
 	float   force;          // Force of gravity
 	float   gravity;        // gravitational constant of the game universe
 	Input   *input;         // pointer to the input system
+	const Camera *camera;   // screen edges in world coordinates
+	// Drift along x in world coordinates, worked out from the clock instead of integrated
+	// every tick: x = launchX + drift * (time - launchTime)
+	float   launchX;
+	double  launchTime;
+	float   drift;          // pixels per second, 0 for entities that stay put
 	HRESULT hr;             // standard return type
 	bool    active;         // only active entities may collide
 	bool    rotatedBoxReady;    // true when rotated collision box is ready
@@ -85,6 +91,7 @@ public:
 	virtual float GetMass()           const {return mass;}
 	virtual float GetGravity()        const {return gravity;}
 	virtual float GetHealth()         const {return health;}
+	virtual float GetDrift()          const {return drift;}
 	virtual EntityNS::COLLISION_TYPE GetCollisionType() {return collisionType;}
 
 	virtual void SetVelocity(VECTOR2 v)    {velocity = v;}
@@ -94,8 +101,27 @@ public:
 	virtual void SetMass(float m)          {mass = m;}
 	virtual void SetGravity(float g)       {gravity = g;}
 	virtual void SetCollisionRadius(float r)    {radius = r;}
+	virtual void SetX(float newX)
+	{
+		spriteData.x = newX;
+		launchX = newX;
+		launchTime = GetClockTime();
+	}
 #pragma endregion
 
+	// Drift at vx pixels per second from where the entity is now
+	void Launch(float vx)
+	{
+		SetX(spriteData.x);
+		drift = vx;
+	}
+	// Bring x up to the clock, call before the position is used. Nothing to do without drift.
+	void Advance()
+	{
+		if (drift != 0.0f)
+			spriteData.x = launchX + drift * (float)(GetClockTime() - launchTime);
+	}
+
 	virtual void Update(float frameTime);
 	virtual bool Initialize(Game *gamePtr, int width, int height, int ncols, TextureManager *textureM);
 	virtual void Activate();
@@ -13,10 +13,7 @@ Fly::Fly() : Entity()
 	spriteData.rect.right = FlyNS::WIDTH;
 	velocity.x = 0;
 	velocity.y = 0;
-	frameDelay = FlyNS::ANIMATION_DELAY;
-	startFrame = FlyNS::START_FRAME;
-	endFrame = FlyNS::END_FRAME;
-	currentFrame = startFrame;
+	currentFrame = FlyNS::START_FRAME;
 	radius = FlyNS::HEIGHT/2.0f;
 	collisionType = EntityNS::CIRCLE;
 	active = false;
@@ -52,12 +49,5 @@ void Fly::Update(float frameTime)
 		return;
 
 	Entity::Update(frameTime);
-	spriteData.x += FlyNS::SPEED * frameTime * velocity.x; // move Fly along X 
-
-	if (spriteData.x + spriteData.width < 0) // if hit left screen edge
-	{
-		active = false;
-		visible = false;
-		spriteData.x = GAME_WIDTH; // position at right screen edge
-	}
+	Advance(); // x from its launch, leaving the screen is scheduled by the game
 }
\ No newline at end of file
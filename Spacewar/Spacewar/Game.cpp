@@ -8,6 +8,8 @@ Game::Game()
 	, initialized(false)
 	, fps(100)
 	, fpsOn(false)
+	, statsOn(false)
+	, replayTime(0)
 {
 	input = new Input(); // initialize keyboard input immediately
 	// additional initialization is handled in later call to input->Initialize()
@@ -28,6 +30,11 @@ void Game::Initialize(HWND hw)
 	hwnd = hw;
 	graphics = new Graphics();
 	graphics->Initialize(hwnd, GAME_WIDTH, GAME_HEIGHT, FULLSCREEN); // throws GameError
+	// Assets come from the pack when one was built (/pack)
+	if (pack.Open(AssetPackNS::DEFAULT_FILE))
+		graphics->SetPack(&pack);
+	loader.Initialize(graphics); // throws GameError
+	textures.Initialize(graphics, &loader);
 
 	// Initialize input, do not capture mouse
 	input->Initialize(hwnd, false); // throws GameError
@@ -58,6 +65,12 @@ void Game::Run(HWND hwnd)
 	if(graphics == NULL) // if graphics not initialized
 		return;
 
+	if (replay.IsPlaying())
+	{
+		ReplayFrame();
+		return;
+	}
+
 	// Calculate elapsed time of last frame, save in frameTime
 	QueryPerformanceCounter(&timeEnd);
 	frameTime = (float)(timeEnd.QuadPart - timeStart.QuadPart ) / (float)timerFreq.QuadPart;
@@ -79,6 +92,8 @@ void Game::Run(HWND hwnd)
 		frameTime = MAX_FRAME_TIME; // limit maximum frameTime
 	timeStart = timeEnd;
 
+	textures.PollPreloads(); // create the textures decoded since the last frame
+
 	// Update(), AI(), and Collisions() are pure virtual functions.
 	// These functions must be provided in the class that inherits from Game.
 	if (!paused)
@@ -90,6 +105,11 @@ void Game::Run(HWND hwnd)
 	}
 	RenderGame();
 
+	// Render scale of the next frame from the work time of this one, the sleep above is not part of it
+	LARGE_INTEGER workEnd;
+	QueryPerformanceCounter(&workEnd);
+	graphics->SetRenderScale(resolution.Update((float)(workEnd.QuadPart - timeStart.QuadPart) / (float)timerFreq.QuadPart));
+
 	//check for console key
 	if (input->WasKeyPressed(Key::TILDE))
 	{
@@ -122,14 +142,21 @@ void Game::RenderGame()
 
 	if (SUCCEEDED(graphics->BeginScene()))
 	{
+		recorder.BeginFrame();
+		graphics->BeginScaledScene();
 		Render();
+		graphics->EndScaledScene();
+		RenderOverlay();
 		graphics->SpriteBegin();
 		if(fpsOn)
 		{
 			_snprintf(buffer, bufferSize, "Fps %d", (int)fps);
 			DXFont.print(buffer, GAME_WIDTH - 100, GAME_HEIGHT - 28);
 		}
+		if (statsOn)
+			DrawStats();
 		graphics->SpriteEnd();
+		recorder.EndFrame(); // the console is not part of the capture
 		console->draw();
 		graphics->EndScene();
 	}
@@ -141,8 +168,149 @@ void Game::RenderGame()
 
 //----------------------------------------------------------------------------------------------------
 
+void Game::DrawStats()
+{
+	const int bufferSize = 128;
+	static char buffer[bufferSize];
+	const GraphicsNS::FrameStats &stats = graphics->GetFrameStats();
+
+	_snprintf(buffer, bufferSize, "Sprites %u drawn, %u culled%s", stats.spritesSubmitted, stats.spritesCulled,
+		graphics->GetCulling() ? "" : " (culling off)");
+	DXFont.print(buffer, 10, GAME_HEIGHT - 28);
+	_snprintf(buffer, bufferSize, "Transforms %u built, %u reused", stats.transformsBuilt, stats.transformsReused);
+	DXFont.print(buffer, 10, GAME_HEIGHT - 52);
+	// Overdraw = pixel writes per screen pixel
+	_snprintf(buffer, bufferSize, "Overdraw %.2fx, %u occluded, %u pixels trimmed%s",
+		(float)stats.pixelsDrawn / (GAME_WIDTH * GAME_HEIGHT), stats.spritesOccluded, stats.pixelsTrimmed,
+		graphics->GetOcclusion() ? "" : " (occlusion off)");
+	DXFont.print(buffer, 10, GAME_HEIGHT - 76);
+	_snprintf(buffer, bufferSize, "Resolution %u x %u (%d%%), %.1f ms of %.1f ms, %u down, %u up%s",
+		graphics->GetScaledWidth(), graphics->GetScaledHeight(), (int)(resolution.GetScale() * 100.0f + 0.5f),
+		resolution.GetAverage() * 1000.0f, resolution.GetTarget() * 1000.0f, resolution.GetScaleDowns(),
+		resolution.GetScaleUps(), resolution.GetEnabled() ? "" : " (dynamic resolution off)");
+	DXFont.print(buffer, 10, GAME_HEIGHT - 100);
+	_snprintf(buffer, bufferSize, "Textures %u resident, %.1f of %.1f MB, %u hits, %u misses, %u prefetched, %u evicted",
+		textures.GetResidentCount(), textures.GetBytesResident() / (1024.0f * 1024.0f),
+		textures.GetBudget() / (1024.0f * 1024.0f), textures.GetHits(), textures.GetMisses(),
+		textures.GetPrefetches(), textures.GetEvictions());
+	DXFont.print(buffer, 10, GAME_HEIGHT - 124);
+	// Reloads after a device reset or an eviction should come from the shadows, not the disk
+	const ShadowCache *shadows = graphics->GetShadows();
+	_snprintf(buffer, bufferSize, "Shadows %u images, %.1f MB (%.1f MB unpacked), %u restores, %u rejected, %u disk loads (%u baked)",
+		shadows->GetCount(), shadows->GetBytesHeld() / (1024.0f * 1024.0f),
+		shadows->GetBytesUnpacked() / (1024.0f * 1024.0f), shadows->GetRestores(), shadows->GetRejected(),
+		graphics->GetDiskLoads(), graphics->GetBakedLoads());
+	DXFont.print(buffer, 10, GAME_HEIGHT - 148);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Game::BenchmarkTransforms()
+{
+	const int bufferSize = 128;
+	static char buffer[bufferSize];
+	const int spriteCount = 1000;
+	const int passes = 100;
+
+	// A mix of plain, rotated and flipped sprites, every cache is current like a HUD that does not move
+	std::vector<SpriteData> sprites(spriteCount);
+	std::vector<SpriteTransform> transforms(spriteCount);
+	for (int i = 0; i < spriteCount; ++i)
+	{
+		ZeroMemory(&sprites[i], sizeof(SpriteData));
+		sprites[i].width = 64;
+		sprites[i].height = 64;
+		sprites[i].x = (float)(i * 37 % GAME_WIDTH);
+		sprites[i].y = (float)(i * 53 % GAME_HEIGHT);
+		sprites[i].scale = 1.0f + (i % 3) * 0.5f;
+		sprites[i].angle = (i % 4 == 0) ? 0.5f : 0.0f;
+		sprites[i].flipHorizontal = (i % 2 == 0);
+		Graphics::UpdateTransform(transforms[i], sprites[i]);
+	}
+
+	LARGE_INTEGER frequency, start, built, reused;
+	volatile float sink = 0.0f;	// keeps the compiler from dropping the work
+	D3DXMATRIX matrix;
+	UINT reuseCount = 0;
+
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (int i = 0; i < spriteCount; ++i)
+		{
+			Graphics::BuildSpriteMatrix(sprites[i], matrix);
+			sink = sink + matrix._41;
+		}
+	}
+	QueryPerformanceCounter(&built);
+	for (int pass = 0; pass < passes; ++pass)
+	{
+		for (int i = 0; i < spriteCount; ++i)
+		{
+			if (Graphics::IsTransformCurrent(transforms[i], sprites[i]))
+				reuseCount++;
+			else
+				Graphics::UpdateTransform(transforms[i], sprites[i]);
+			sink = sink + transforms[i].matrix._41;
+		}
+	}
+	QueryPerformanceCounter(&reused);
+
+	double builtMs = (built.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart;
+	double reusedMs = (reused.QuadPart - built.QuadPart) * 1000.0 / frequency.QuadPart;
+	_snprintf(buffer, bufferSize, "%d transforms: built %.3f ms, reused %.3f ms (%u hits)",
+		spriteCount * passes, builtMs, reusedMs, reuseCount);
+	console->print(buffer);
+	if (reusedMs > 0.0)
+	{
+		_snprintf(buffer, bufferSize, "Cached transforms are %.1fx faster", builtMs / reusedMs);
+		console->print(buffer);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Game::ReplayFrame()
+{
+	const int bufferSize = 128;
+	static char buffer[bufferSize];
+	LARGE_INTEGER frameStart, frameEnd;
+	bool more = true;
+
+	QueryPerformanceCounter(&frameStart);
+	if (SUCCEEDED(graphics->BeginScene()))
+	{
+		more = replay.PlayFrame();
+		graphics->EndScene();
+	}
+	HandleLostGraphicsDevice();
+	graphics->ShowBackBuffer();
+	QueryPerformanceCounter(&frameEnd);
+	replayTime += frameEnd.QuadPart - frameStart.QuadPart;
+
+	if (!more)
+	{
+		float ms = (float)replayTime * 1000.0f / (float)timerFreq.QuadPart;
+		UINT frames = replay.GetFrameCount();
+		_snprintf(buffer, bufferSize, "Replay: %u frames, %u draws in %.1f ms (%.3f ms/frame)",
+			frames, replay.GetCommandCount(), ms, frames > 0 ? ms / frames : 0.0f);
+		console->print(buffer);
+		replay.Close();
+	}
+
+	// Replay time does not count as game time
+	QueryPerformanceCounter(&timeStart);
+	input->Clear(InputNS::KEYS_PRESSED);
+}
+
+//----------------------------------------------------------------------------------------------------
+
 void Game::ReleaseAll()
 {
+	recorder.OnLostDevice();
+	replay.OnLostDevice();
+	textures.OnLostDevice();
 	SAFE_ON_LOST_DEVICE(console);
 	DXFont.onLostDevice();
 }
@@ -153,12 +321,17 @@ void Game::ResetAll()
 {
 	DXFont.onResetDevice();
 	SAFE_ON_RESET_DEVICE(console);
+	textures.OnResetDevice();
+	replay.OnResetDevice();
 }
 
 //----------------------------------------------------------------------------------------------------
 
 void Game::DeleteAll()
 {
+	recorder.Stop();
+	replay.Close();
+	loader.Shutdown(); // the workers use the device
 	ReleaseAll(); // call OnLostDevice() for every graphics item
 	SafeDelete(graphics);
 	SafeDelete(input);
@@ -283,6 +456,56 @@ void Game::ConsoleCommand()
 		console->print("/fps - toggle display of frames per second");
 		console->print("/quit - quit game");
 		console->print("/restart - restart game");
+		console->print("/stats - toggle display of renderer counters");
+		console->print("/cull - toggle view culling of sprites");
+		console->print("/occlude - toggle skipping sprites hidden behind opaque sprites");
+		console->print("/bench transforms - time sprite matrix building against the cache");
+		console->print("/dynres [min max] - toggle dynamic resolution or set its scale bounds");
+		console->print("/budget [MB] - show or set the texture memory budget");
+		console->print("/pack - pack the Assets folder into one file, read instead of the loose files");
+		console->print("/record [file] - start/stop capturing draw commands");
+		console->print("/replay [file] - play a capture back at full speed");
+		return;
+	}
+
+	if (command.compare(0, 7, "/record") == 0)
+	{
+		const int bufferSize = 128;
+		char buffer[bufferSize];
+		if (recorder.IsRecording())
+		{
+			recorder.Stop();
+			graphics->SetRecorder(NULL);
+			_snprintf(buffer, bufferSize, "Recording stopped: %u frames, %u bytes",
+				recorder.GetFrameCount(), recorder.GetBytesWritten());
+			console->print(buffer);
+		}
+		else
+		{
+			std::string file = command.length() > 8 ? command.substr(8) : RenderRecorderNS::DEFAULT_FILE;
+			if (recorder.Start(graphics, file.c_str()))
+			{
+				graphics->SetRecorder(&recorder);
+				console->print("Recording to " + file);
+			}
+			else
+				console->print("Unable to create " + file);
+		}
+		return;
+	}
+
+	if (command.compare(0, 7, "/replay") == 0)
+	{
+		std::string file = command.length() > 8 ? command.substr(8) : RenderRecorderNS::DEFAULT_FILE;
+		if (recorder.IsRecording())
+			console->print("Stop recording before replaying");
+		else if (replay.Open(graphics, &textures, file.c_str()))
+		{
+			console->print("Replaying " + file);
+			replayTime = 0;
+		}
+		else
+			console->print("Unable to replay " + file);
 		return;
 	}
 
@@ -295,6 +518,83 @@ void Game::ConsoleCommand()
 			console->print("fps Off");
     }
 
+	if (command == "/stats")
+	{
+		statsOn = !statsOn;
+		console->print(statsOn ? "stats On" : "stats Off");
+	}
+
+	if (command == "/cull")
+	{
+		graphics->SetCulling(!graphics->GetCulling());
+		console->print(graphics->GetCulling() ? "culling On" : "culling Off");
+	}
+
+	if (command == "/occlude")
+	{
+		graphics->SetOcclusion(!graphics->GetOcclusion());
+		console->print(graphics->GetOcclusion() ? "occlusion On" : "occlusion Off");
+	}
+
+	if (command == "/bench transforms")
+	{
+		BenchmarkTransforms();
+	}
+
+	if (command.compare(0, 7, "/dynres") == 0)
+	{
+		const int bufferSize = 128;
+		char buffer[bufferSize];
+		float minScale, maxScale;
+		if (sscanf(command.c_str() + 7, "%f %f", &minScale, &maxScale) == 2)
+		{
+			resolution.SetBounds(minScale, maxScale);
+			_snprintf(buffer, bufferSize, "Render scale between %.2f and %.2f",
+				resolution.GetMinScale(), resolution.GetMaxScale());
+			console->print(buffer);
+		}
+		else if (command == "/dynres")
+		{
+			resolution.SetEnabled(!resolution.GetEnabled());
+			console->print(resolution.GetEnabled() ? "dynamic resolution On" : "dynamic resolution Off");
+		}
+		else
+			console->print("/dynres [min max]");
+		graphics->SetRenderScale(resolution.GetScale());
+	}
+
+	if (command.compare(0, 7, "/budget") == 0)
+	{
+		const int bufferSize = 128;
+		char buffer[bufferSize];
+		float megabytes;
+		if (sscanf(command.c_str() + 7, "%f", &megabytes) == 1 && megabytes > 0.0f)
+			textures.SetBudget((UINT)(megabytes * 1024.0f * 1024.0f));
+		_snprintf(buffer, bufferSize, "Texture budget %.1f MB, %.1f MB resident in %u textures",
+			textures.GetBudget() / (1024.0f * 1024.0f), textures.GetBytesResident() / (1024.0f * 1024.0f),
+			textures.GetResidentCount());
+		console->print(buffer);
+	}
+
+	if (command == "/pack")
+	{
+		// The pack is written over, stop reading from it first
+		const int bufferSize = 128;
+		char buffer[bufferSize];
+		graphics->SetPack(NULL);
+		pack.Close();
+		int count = AssetPack::Build(AssetPackNS::SOURCE_DIR, AssetPackNS::DEFAULT_FILE);
+		if (count < 0)
+			console->print(std::string("Unable to write ") + AssetPackNS::DEFAULT_FILE);
+		else if (pack.Open(AssetPackNS::DEFAULT_FILE))
+		{
+			graphics->SetPack(&pack);
+			_snprintf(buffer, bufferSize, "Packed %d files into %s, %.1f MB", count, AssetPackNS::DEFAULT_FILE,
+				pack.GetSize() / (1024.0f * 1024.0f));
+			console->print(buffer);
+		}
+	}
+
 	if (command == "/quit")
 	{
 		ExitGame();
@@ -5,12 +5,21 @@
 #include <Windows.h>
 #include <MMSystem.h>
 
+#include "AnimationClip.h"
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "Camera.h"
 #include "Console.h"
 #include "Constants.h"
 #include "GameError.h"
 #include "Graphics.h"
 #include "Input.h"
+#include "RenderRecorder.h"
+#include "RenderReplay.h"
+#include "ResolutionController.h"
+#include "ShadowCache.h"
 #include "TextDX.h"
+#include "TextureRegistry.h"
 
 namespace GameNS
 {
@@ -74,6 +83,11 @@ public:
 	virtual void Render() = 0;
 #pragma endregion
 
+	// Render items that stay at native resolution when the scene is scaled down (HUD, text).
+	// Drawn over the upscaled scene, call graphics->SpriteBegin()/SpriteEnd() as in Render.
+	virtual void RenderOverlay() {}
+
+
 #pragma region Member Functions
 	// Window message handler
 	LRESULT MessageHandler(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -82,18 +96,40 @@ public:
 	void SetDisplayMode(GraphicsNS::DISPLAY_MODE mode = GraphicsNS::TOGGLE);
 
 	void ExitGame() { PostMessage(hwnd, WM_DESTROY, 0, 0); }
+
+	// Draw the next frame of a render replay at full speed, no game logic runs
+	void ReplayFrame();
+
+	// Print renderer counters of the last frame, call between SpriteBegin/SpriteEnd
+	virtual void DrawStats();
+
+	// Time building sprite matrices against reusing cached ones, prints the result to the console
+	void BenchmarkTransforms();
 #pragma endregion
 
 #pragma region Accessors/Mutators
 	Graphics* GetGraphics() { return graphics; }
 	Input* getInput() { return input; }
+	const AnimationClock* GetAnimationClock() { return &animationClock; }
+	const Camera* GetCamera() { return &camera; }
+	TextureRegistry* GetTextures() { return &textures; }
+	AssetLoader* GetLoader() { return &loader; }
 #pragma endregion
 
 protected:
 	Console*		console;
 	Graphics*		graphics;
 	Input*			input;
+	AssetPack		pack;			// declared before the loader, its threads read from it
+	AssetLoader		loader;			// decodes textures on worker threads
+	TextureRegistry	textures;		// declared before every member holding a TextureHandle
 	TextDX			DXFont;
+	RenderRecorder	recorder;		// captures draw submissions to a file (/record)
+	RenderReplay	replay;			// plays a capture back (/replay)
+	AnimationClock	animationClock;	// advanced by the derived game while its world runs
+	Camera			camera;			// scrolled by the derived game, entities live in its world coordinates
+	ResolutionController resolution;	// render scale that holds the frame time budget (/dynres)
+	LONGLONG		replayTime;		// performance counter ticks spent drawing the replay
 	HWND			hwnd;			// window handle
 	HRESULT			hr;				// standard return type
 	LARGE_INTEGER	timeStart;		// performance counter start value
@@ -103,6 +139,7 @@ protected:
 	float			fps;			// frames per second
 	DWORD			sleepTime;		// milliseconds to sleep between frames
 	bool			fpsOn;
+	bool			statsOn;		// display renderer counters (/stats)
 	bool			paused;			// true if game is paused
 	bool			initialized;
 	std::string		command;
@@ -1,17 +1,49 @@
 // Modified by : Johnny Wu
 
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #include "GameplayState.h"
 
+namespace
+{
+	// Entities of each kind outside of stress runs
+	const int SPINNER_COUNT = 5;
+	const int FLY_COUNT = 5;
+	const int PICKUP_COUNT = 10;
+
+	// Events of the spawn wheel, each schedules the next one when it spawns
+	const int SPAWN_ENEMY = 0;
+	const int SPAWN_PICKUP = 1;
+	const int SPAWN_STRESS = 2;			// a batch of a stress run instead of the two above
+	const float ENEMY_INTERVAL = 3.0f;	// seconds at time scale 1
+	const float PICKUP_INTERVAL = 1.5f;
+
+	// Pickups low enough to run through share the ground lane with spinners,
+	// the ones to jump for share the jump lane with flies
+	const int LANE_GROUND = 0;
+	const int LANE_JUMP = 1;
+	const float SPAWN_GAP = 8.0f;		// kept free on both sides of everything placed
+
+	// Ground tiles, in the order of GameplayState::platformTextures
+	const char *PLATFORM_FILES[] = {
+		"./Assets/Platforms/grassMid.png", "./Assets/Platforms/grassLeft.png", "./Assets/Platforms/grassRight.png",
+		"./Assets/Platforms/grassCenter.png", "./Assets/Platforms/spikesBottom.png" };
+	const int PLATFORM_COUNT = sizeof(PLATFORM_FILES) / sizeof(PLATFORM_FILES[0]);
+	const int MIN_QUEUED = 4;			// ground columns kept queued, more than enter in the longest tick
+}
+
 GameplayState::GameplayState()
 {
 	gameOverFont = new TextDX();
 	replayFont = new TextDX();
 	srand((unsigned int)time(NULL));
-	enemySpawnTimer = 0.0f;
-	pickupSpawnTimer = 0.0f;
+	enemyPending = false;
+	pickupPending = false;
+	levelSeed = 0;
+	firstFly = 0;
+	firstPickup = 0;
 	timeScale = 1.0f;
 	maxTimeScale = 3.0f;
 	life = 5;
@@ -33,7 +65,24 @@ GameplayState::~GameplayState()
 
 void GameplayState::Initialize(HWND hwnd)
 {
+	LARGE_INTEGER frequency, start, end;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&start);
+
 	Game::Initialize(hwnd);
+	benchmarks.Initialize(graphics, console);
+
+	// Textures are decoded on the loader threads while the fonts are created
+	const char *textureFiles[] = {
+		"./Assets/Platforms/grassMid.png", "./Assets/Platforms/grassLeft.png", "./Assets/Platforms/grassRight.png",
+		"./Assets/Platforms/grassCenter.png", "./Assets/Platforms/spikesBottom.png", "./Assets/Player/player_red.png",
+		"./Assets/Enemies/spinnerHalf.png", "./Assets/Enemies/fly.png", "./Assets/Items/coinGold.png",
+		"./Assets/Items/gemBlue.png", "./Assets/HUD/hud.png" };
+	const int textureCount = sizeof(textureFiles) / sizeof(textureFiles[0]);
+	AssetId textureIds[textureCount];
+	for (int i = 0; i < textureCount; ++i)
+		textureIds[i] = textures.Intern(textureFiles[i]);
+	textures.QueuePreloads(textureIds, textureCount);
 
 	 // Text
 	if(gameOverFont->initialize(graphics, 96, false, false, "Arial") == false)
@@ -42,139 +91,154 @@ void GameplayState::Initialize(HWND hwnd)
 		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing DirectX font"));
 
 	// Textures
-	// Background
-	if (!backgroundTextures[0].Initialize(graphics, "./Assets/Background/uncolored_forest.png"))
-		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing uncolored_forest.png"));
-	if (!backgroundTextures[1].Initialize(graphics, "./Assets/Background/uncolored_plain.png"))
-		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing uncolored_plain.png"));
-	// Platform
-	if (!platformTexture.Initialize(graphics, "./Assets/Platforms/grassMid.png"))
-		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing grassMid.png"));
+	textures.FinishPreloads();
+	// Platforms
+	for (int i = 0; i < PLATFORM_COUNT; ++i)
+	{
+		platformTextures[i] = textures.Acquire(PLATFORM_FILES[i]);
+		if (!platformTextures[i].IsValid())
+			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing platform textures"));
+	}
 	// Player
-	if (!playerTexture.Initialize(graphics, "./Assets/Player/player_red.png"))
+	playerTexture = textures.Acquire("./Assets/Player/player_red.png");
+	if (!playerTexture.IsValid())
 		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing player_red.png"));	
 	// Enemies
-	if (!spinnerTexture.Initialize(graphics, "./Assets/Enemies/spinnerHalf.png"))
+	spinnerTexture = textures.Acquire("./Assets/Enemies/spinnerHalf.png");
+	if (!spinnerTexture.IsValid())
 		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing spinner.png"));
-	if (!flyTexture.Initialize(graphics, "./Assets/Enemies/fly.png"))
+	flyTexture = textures.Acquire("./Assets/Enemies/fly.png");
+	if (!flyTexture.IsValid())
 		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing fly.png"));
 	// Pickups
-	if (!pickupTextures[0].Initialize(graphics, "./Assets/Items/coinGold.png"))
+	pickupTextures[0] = textures.Acquire("./Assets/Items/coinGold.png");
+	if (!pickupTextures[0].IsValid())
 		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing coinGold.png"));
-	if (!pickupTextures[1].Initialize(graphics, "./Assets/Items/gemBlue.png"))
+	pickupTextures[1] = textures.Acquire("./Assets/Items/gemBlue.png");
+	if (!pickupTextures[1].IsValid())
 		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing gemBlue.png"));
 	// UI
-	if (!uiTexture.Initialize(graphics, "./Assets/HUD/hud.png"))
+	uiTexture = textures.Acquire("./Assets/HUD/hud.png");
+	if (!uiTexture.IsValid())
 		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing hud.png"));
 
 	// Initialize Background/Platform Images
-	for (int i = 0; i < 3; ++i)
-	{
-		SetBackgroundImage(i);
-		// position them
-		if (i > 0)
-			backgroundImages[i].SetX(backgroundImages[i-1].GetX() + backgroundImages[i-1].GetWidth() * backgroundImages[i-1].GetScale());
-	}
-	for (int i = 0; i < 18; ++i)
-	{
-		if (!platforms[i].Initialize(this, 0, 0, 0, &platformTexture))
-			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing platforms"));
-		platforms[i].SetX(i * platforms[i].GetWidth());
-		platforms[i].SetY(GAME_HEIGHT - platforms[i].GetHeight());
-	}
+	// Backgrounds are rescaled to fit the screen, 900/1024 window height divided by image height.
+	// Only the ones on screen and the next few are loaded, the layer streams them in as it scrolls.
+	const char *backgroundFiles[] = {
+		"./Assets/Background/uncolored_forest.png", "./Assets/Background/uncolored_plain.png",
+		"./Assets/Background/uncolored_castle.png", "./Assets/Background/uncolored_desert.png",
+		"./Assets/Background/uncolored_hills.png", "./Assets/Background/uncolored_peaks.png",
+		"./Assets/Background/uncolored_piramids.png", "./Assets/Background/uncolored_talltrees.png",
+		"./Assets/Background/colored_castle.png", "./Assets/Background/colored_desert.png",
+		"./Assets/Background/colored_forest.png", "./Assets/Background/colored_talltrees.png" };
+	const int backgroundCount = sizeof(backgroundFiles) / sizeof(backgroundFiles[0]);
+	AssetId backgrounds[backgroundCount];
+	for (int i = 0; i < backgroundCount; ++i)
+		backgrounds[i] = textures.Intern(backgroundFiles[i]);
+	if (!background.Initialize(graphics, &textures, backgrounds, backgroundCount, 0.88f, 50.0f, 0.0f))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing background"));
+	// Ground is one row of tiles along the bottom of the screen, raised platforms stand on it
+	float tileSize = (float)platformTextures[0].Get()->GetWidth();
+	if (!ground.Initialize(graphics, tileSize, GAME_HEIGHT - tileSize))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing ground"));
+	LevelTiles tiles;
+	tiles.ground = ground.AddTileType(platformTextures[0].Get());
+	tiles.left = ground.AddTileType(platformTextures[1].Get());
+	tiles.right = ground.AddTileType(platformTextures[2].Get());
+	ground.SetBodyTile(ground.AddTileType(platformTextures[3].Get()));
+	tiles.hazard = ground.AddTileType(platformTextures[4].Get());
+	level.SetTiles(tiles);
+	heightfield.Initialize(tileSize, ground.GetTop());
+	FillGround(camera.GetX());
+	// The level is generated on a worker ahead of the camera from here on
+	levelSeed = (UINT)rand();
+	chunkStreamer.Initialize(&level, levelSeed);
+
+	// Initialize Animations
+	if (!walkClip.Initialize(PlayerNS::WIDTH, PlayerNS::HEIGHT, PlayerNS::TEXTURE_COLS,
+		PlayerNS::WALK_START_FRAME, PlayerNS::WALK_END_FRAME, PlayerNS::WALK_ANIMATION_DELAY))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing player animation"));
+	if (!spinnerClip.Initialize(SpinnerNS::WIDTH, SpinnerNS::HEIGHT, SpinnerNS::TEXTURE_COLS,
+		SpinnerNS::START_FRAME, SpinnerNS::END_FRAME, SpinnerNS::ANIMATION_DELAY))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing spinner animation"));
+	if (!flyClip.Initialize(FlyNS::WIDTH, FlyNS::HEIGHT, FlyNS::TEXTURE_COLS,
+		FlyNS::START_FRAME, FlyNS::END_FRAME, FlyNS::ANIMATION_DELAY))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing fly animation"));
 
 	// Initialize Entities
 	// Player
-	if (!player.Initialize(this, PlayerNS::WIDTH, PlayerNS::HEIGHT, PlayerNS::TEXTURE_COLS, &playerTexture))
+	if (!player.Initialize(this, PlayerNS::WIDTH, PlayerNS::HEIGHT, PlayerNS::TEXTURE_COLS, playerTexture.Get()))
 		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing player"));
-	player.SetFrames(PlayerNS::WALK_START_FRAME, PlayerNS::WALK_END_FRAME);
-	player.SetCurrentFrame(PlayerNS::WALK_START_FRAME);
+	player.SetWalkClip(&walkClip);
+	player.Play(&walkClip);
 	player.SetX(GAME_WIDTH / 3);
 	player.SetY(GAME_HEIGHT / 2);
 
-	// Spinners
-	for (int i = 0; i < 5; ++i)
-	{
-		if (!spinners[i].Initialize(this, SpinnerNS::WIDTH, SpinnerNS::HEIGHT, SpinnerNS::TEXTURE_COLS, &spinnerTexture))
-			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing spinner"));
-		spinners[i].SetX(GAME_WIDTH);
-		spinners[i].SetY(GAME_HEIGHT - platforms[0].GetHeight() - spinners[i].GetHeight() / 2);
-	}
-	
-	// Flies
-	for (int i = 0; i < 5; ++i)
-	{
-		if (!flies[i].Initialize(this, FlyNS::WIDTH, FlyNS::HEIGHT, FlyNS::TEXTURE_COLS, &flyTexture))
-			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing spinner"));
-		flies[i].SetX(GAME_WIDTH);
-		flies[i].SetY(GAME_HEIGHT - platforms[0].GetHeight() - flies[i].GetHeight() - player.GetWidth() - 16);
-	}
+	// Spinners, flies and coins, as many as a stress run from the command line needs
+	SetPools();
 
-	// Coins
-	for (int i = 0; i < 10; ++i)
-	{
-		if (!pickups[i].Initialize(this, 0, 0, 0, &pickupTextures[0]))
-			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing pickup image"));
-		pickups[i].SetX(GAME_WIDTH);
-	}
+	// First spawns, each one schedules the next
+	ScheduleSpawns();
 
 	// Initialize UI elements
-	// Player icon
-	if (!playerIcon.Initialize(this, 64, 64, 5, &uiTexture))
-			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing playerIcon"));
-	playerIcon.SetCurrentFrame(14);
-	playerIcon.SetX(32);
-	playerIcon.SetY(32);
-
-	// Hearts
+	// All HUD images are 64x64 frames of hud.png, digits 0-9 are frames 0 to 9
+	// Layout: [player icon, hearts] [coin icon, coin counter] [gem icon, gem counter]
+	if (!playerIcon.Initialize(uiTexture.Get(), 64, 64, 5, 14))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing playerIcon"));
 	for (int i = 0; i < 5; ++i)
 	{
-		if (!hearts[i].Initialize(this, 64, 64, 5, &uiTexture))
+		if (!hearts[i].Initialize(uiTexture.Get(), 64, 64, 5, 13))
 			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing hearts"));
-		hearts[i].SetCurrentFrame(13);
-		hearts[i].SetX( (i * hearts[i].GetWidth() +  64) + playerIcon.GetX() + 16);
-		hearts[i].SetY(32);
-	}
-
-	// Coin icon
-	if (!coinIcon.Initialize(this, 64, 64, 5, &uiTexture))
-			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing coinIcon"));
-	coinIcon.SetCurrentFrame(10);
-	coinIcon.SetX(hearts[4].GetX() + hearts[4].GetWidth() + 128);
-	coinIcon.SetY(32);
-
-	// coinText
-	for (int i = 0; i < 3; ++i)
-	{
-		if (!coinText[i].Initialize(this, 64, 64, 5, &uiTexture))
-			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing coinText"));
-		coinText[i].SetCurrentFrame(0);
-		coinText[i].SetX((i * coinText[i].GetWidth() + 64) + coinIcon.GetX() + 32);
-		coinText[i].SetY(32);
-	}
-
-	// Gem icon
-	if (!gemIcon.Initialize(this, 64, 64, 5, &uiTexture))
-			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing gemIcon"));
-	gemIcon.SetCurrentFrame(11);
-	gemIcon.SetX(coinText[2].GetX() + coinText[2].GetWidth() + 128);
-	gemIcon.SetY(32);
-
-	// gemText
-	for (int i = 0; i < 2; ++i)
-	{
-		if (!gemText[i].Initialize(this, 64, 64, 5, &uiTexture))
-			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing gemText"));
-		gemText[i].SetCurrentFrame(0);
-		gemText[i].SetX((i * gemText[i].GetWidth() + 64) + gemIcon.GetX() + 32);
-		gemText[i].SetY(32);
-	}
+		heartsRow.AddChild(&hearts[i]);
+	}
+	heartsRow.SetLayout(UINodeNS::ROW);
+	livesGroup.SetLayout(UINodeNS::ROW, 16);
+	livesGroup.AddChild(&playerIcon);
+	livesGroup.AddChild(&heartsRow);
+
+	if (!coinIcon.Initialize(uiTexture.Get(), 64, 64, 5, 10))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing coinIcon"));
+	if (!coinCounter.Initialize(uiTexture.Get(), 64, 64, 5, 3))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing coinCounter"));
+	coinGroup.SetLayout(UINodeNS::ROW, 32);
+	coinGroup.AddChild(&coinIcon);
+	coinGroup.AddChild(&coinCounter);
+
+	if (!gemIcon.Initialize(uiTexture.Get(), 64, 64, 5, 11))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing gemIcon"));
+	if (!gemCounter.Initialize(uiTexture.Get(), 64, 64, 5, 2))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing gemCounter"));
+	gemGroup.SetLayout(UINodeNS::ROW, 32);
+	gemGroup.AddChild(&gemIcon);
+	gemGroup.AddChild(&gemCounter);
+
+	hudRoot.SetLayout(UINodeNS::ROW, 128);
+	hudRoot.AddChild(&livesGroup);
+	hudRoot.AddChild(&coinGroup);
+	hudRoot.AddChild(&gemGroup);
+	if (!hud.Initialize(graphics, &hudRoot, 32, 32))
+		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing HUD"));
+
+	const int bufferSize = 128;
+	char buffer[bufferSize];
+	QueryPerformanceCounter(&end);
+	_snprintf(buffer, bufferSize, "Startup %.1f ms, %u loader threads",
+		(end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart, loader.GetWorkerCount());
+	console->print(buffer);
+
+	// A stress run from the command line logs from the first frame
+	if (stress.IsRunning() && !stressLog.empty() && !stress.OpenLog(stressLog.c_str()))
+		console->print("Unable to create " + stressLog);
 }
 
 //----------------------------------------------------------------------------------------------------
 
 void GameplayState::Update()
 {
+	LARGE_INTEGER start, end;
+	QueryPerformanceCounter(&start);
+
 	if (isPaused)
 	{
 		if (input->WasKeyPressed(Key::R))
@@ -184,8 +248,7 @@ void GameplayState::Update()
 	{
 		timeScale += frameTime * 0.01f;
 		timeScale = Clamp(timeScale, 1.0f, maxTimeScale);
-		enemySpawnTimer += frameTime;
-		pickupSpawnTimer += frameTime;
+		animationClock.Update(frameTime);	// the only per tick animation work
 
 		ScrollingBackground();
 		player.SetVelocity(VECTOR2(0.0f, 0.0f));
@@ -215,28 +278,35 @@ void GameplayState::Update()
 		// Update player
 		player.Update(frameTime);
 	
-		// Update enemies
-		SpawnEnemies();
-
-		// Update pickups
-		SpawnPickups();
-
-		// Update UI
-		playerIcon.Update(frameTime);
-		coinIcon.Update(frameTime);
-		gemIcon.Update(frameTime);
-		for (int i = 0; i < 5; ++i)
+		// Update enemies, only drifting ones move
+		for (size_t i = 0; i < spinners.size(); ++i)
 		{
-			hearts[i].Update(frameTime);
+			if (spinners[i].GetDrift() != 0.0f)
+				spinners[i].Update(frameTime);
 		}
-		for (int i = 0; i < 3; ++i)
+		for (size_t i = 0; i < flies.size(); ++i)
 		{
-			coinText[i].Update(frameTime);
-		}
-		for (int i = 0; i < 2; ++i)
-		{
-			gemText[i].Update(frameTime);
+			if (flies[i].GetDrift() != 0.0f)
+				flies[i].Update(frameTime);
 		}
+
+		// Spawn and despawn enemies and pickups
+		Spawn();
+		Despawn();
+
+		// Keep world coordinates small on long runs
+		float shift = camera.Rebase();
+		if (shift != 0.0f)
+			RebaseWorld(shift);
+	}
+
+	QueryPerformanceCounter(&end);
+	if (stress.IsRunning())
+	{
+		stress.AddTime(StressTestNS::TICK, end.QuadPart - start.QuadPart);
+		stress.EndFrame(frameTime, CountActive(), timerFreq.QuadPart);
+		if (stress.IsFinished())
+			ExitGame();
 	}
 }
 
@@ -253,140 +323,130 @@ void GameplayState::Collisions()
 	if (isPaused)
 		return;
 
+	LARGE_INTEGER start, end;
+	QueryPerformanceCounter(&start);
 	VECTOR2 collisionVector;
-	// collision between players and platforms
-	for (int i = 0; i < 18; ++i)
-	{
-		if (player.CollidesWith(platforms[i], collisionVector))
+	// collision between player and ground, a heightfield lookup for each column under the feet
+	GroundContact contact;
+	heightfield.Probe(player.GetFootLeft(), player.GetFootRight(), player.GetLastFootY(), player.GetFootY(), contact);
+	if (contact.wall)
+	{
+		// Ran into the side of a higher column, held left of it
+		player.SetX(player.GetX() - (player.GetFootRight() - contact.wallX));
+		if (player.GetX() < camera.GetX())
 		{
-			player.ResolveCollision(platforms[i]);
-			player.SetGrounded(true);
+			// Pushed off the screen, put on top of it instead
+			Hurt();
+			player.SetX(contact.wallX - (player.GetFootLeft() - player.GetX()));
+			contact.grounded = true;
+			contact.top = contact.wallTop;
+			contact.hazard = false;
 		}
 	}
+	if (contact.grounded)
+	{
+		player.SnapToGround(contact.top);
+		player.SetGrounded(true);
+		if (contact.hazard)
+			Hurt();
+	}
+	else
+		player.SetGrounded(false);	// over a gap or above the ground
+	if (player.GetY() > GAME_HEIGHT)
+		Fall();
 
-	for (int i = 0; i < 5; ++i)
+	for (size_t i = 0; i < spinners.size(); ++i)
 	{
-		if (!player.TookDamage())
-		{
-			if (player.CollidesWith(spinners[i], collisionVector) || player.CollidesWith(flies[i], collisionVector))
-			{
-				player.TakeDamage();
-				timeScale = 1.0f;
-				life--;
-				if (life > 0 && life < 5)
-					hearts[life].SetCurrentFrame(12);
-				else
-				{
-					hearts[0].SetCurrentFrame(12);
-					isPaused = true;
-				}
-			}
-		}
+		if (player.CollidesWith(spinners[i], collisionVector))
+			Hurt();
+	}
+	for (size_t i = 0; i < flies.size(); ++i)
+	{
+		if (player.CollidesWith(flies[i], collisionVector))
+			Hurt();
 	}
 
-	for (int i = 0; i < 10; ++i)
+	// Pickups never overlap enemies, they are placed in free room when they spawn
+	for (int i = 0; i < (int)pickups.size(); ++i)
 	{
-		for (int j = 0; j < 5; ++j)
-		{
-			if (pickups[i].CollidesWith(spinners[j], collisionVector) || pickups[i].CollidesWith(flies[j], collisionVector))
-			{
-				// Spawned on top of an enemy
-				pickups[i].Reset();
-			}
-		}
 		if (player.CollidesWith(pickups[i], collisionVector))
 		{
 			// collided with player
 			if (pickups[i].IsGem())
 			{
 				gemScore ++;
-				gemScore = Clamp(gemScore, 0, 99);
-				if (gemScore > 9)
-				{
-					gemText[0].SetCurrentFrame(gemScore / 10);
-					gemText[1].SetCurrentFrame(gemScore % 10);
-				}
-				else
-					gemText[1].SetCurrentFrame(gemScore);
+				gemScore = Clamp(gemScore, 0, gemCounter.GetMaxValue());
+				gemCounter.SetValue(gemScore);
 			}
 			else
 			{
 				coinScore ++;
-				coinScore = Clamp(coinScore, 0, 999);
-				if (coinScore > 99)
-				{
-					coinText[0].SetCurrentFrame(coinScore / 100);
-					coinText[1].SetCurrentFrame(coinScore % 100 / 10);
-					coinText[2].SetCurrentFrame(coinScore % 10);
-				}
-				else if (coinScore > 9)
-				{
-					coinText[1].SetCurrentFrame(coinScore / 10);
-					coinText[2].SetCurrentFrame(coinScore % 10);
-				}
-				else
-				{
-					coinText[2].SetCurrentFrame(coinScore);
-				}
+				coinScore = Clamp(coinScore, 0, coinCounter.GetMaxValue());
+				coinCounter.SetValue(coinScore);
 			}
 
 			pickups[i].Reset();
+			despawns.Cancel(firstPickup + i);
+			Vacate(firstPickup + i);
 		}
 	}
+
+	QueryPerformanceCounter(&end);
+	stress.AddTime(StressTestNS::COLLISIONS, end.QuadPart - start.QuadPart);
 }
 
 //----------------------------------------------------------------------------------------------------
 
 void GameplayState::Render()
 {
+	LARGE_INTEGER start, end;
+	QueryPerformanceCounter(&start);
+
 	graphics->SpriteBegin();
-	// Draw background/Platforms
-	for (int i = 0; i < 3; ++i)
-	{
-		backgroundImages[i].Draw();
-	}
-	
-	for (int i = 0; i < 18; ++i)
-	{
-		platforms[i].Draw();
-	}
+	// Draw background/Platforms, the background is in screen coordinates and the rest in world ones
+	background.Draw();
+	camera.Apply(graphics);
+	ground.Draw();
 
 	// Draw players
 	player.Draw();
 
 	// Draw enemies
-	for (int i = 0; i < 5; ++i)
+	for (size_t i = 0; i < spinners.size(); ++i)
 	{
 		spinners[i].Draw();
 	}
 
-	for (int i = 0; i < 5; ++i)
+	for (size_t i = 0; i < flies.size(); ++i)
 	{
 		flies[i].Draw();
 	}
 
 	// Draw pickups
-	for (int i = 0; i < 10; ++i)
+	for (size_t i = 0; i < pickups.size(); ++i)
 	{
 		pickups[i].Draw();
 	}
-	
+
+	graphics->SetView(0.0f, 0.0f);
+	graphics->SpriteEnd();
+
+	QueryPerformanceCounter(&end);
+	stress.AddTime(StressTestNS::RENDER, end.QuadPart - start.QuadPart);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::RenderOverlay()
+{
+	// Redraws the HUD texture only after score or life changed
+	hud.Compose();
+
+	graphics->SpriteBegin();
 	// Draw UI
-	playerIcon.Draw();
-	coinIcon.Draw();
-	gemIcon.Draw();
-	for (int i = 0; i < 5; ++i)
-	{
-		hearts[i].Draw();
-	}
-	for (int i = 0; i < 3; ++i)
-	{
-		coinText[i].Draw();
-	}
-	for (int i = 0; i < 2; ++i)
-	{
-		gemText[i].Draw();
-	}
+	hud.Draw();
+	if (stress.IsRunning())
+		DXFont.print(stress.GetReport(), 32, 112);
 
 	if (isPaused)
 	{
@@ -402,185 +462,457 @@ void GameplayState::Render()
 
 //----------------------------------------------------------------------------------------------------
 
-void GameplayState::SetBackgroundImage(int index)
+void GameplayState::ScrollingBackground()
 {
-	int rnd = rand() % 2;
-	if (!backgroundImages[index].Initialize(graphics, 0, 0, 0, &backgroundTextures[rnd]))
-		throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing background image"));
-	// Rescale background to fit screen
-		backgroundImages[index].SetScale(0.88f); // 900/1024 window height divided by image height
+	// Move slowly left, picks a random background texture when a tile wraps
+	background.Update(frameTime, timeScale);
+
+	// The camera moves over the level at the pickup speed, ground columns it passed are recycled.
+	// Level content keeps its world position.
+	camera.SetSpeed(PickupNS::SPEED * timeScale);
+	camera.Update(frameTime);
+	StreamLevel();
+	ground.Follow(camera.GetX());
 }
 
 //----------------------------------------------------------------------------------------------------
 
-void GameplayState::ScrollingBackground()
+void GameplayState::StreamLevel()
 {
-	for (int i = 0; i < 3; ++i)
+	// Chunks the camera passed go back to the pool for the worker to fill again
+	while (!streamedChunks.empty() && streamedChunks.front()->end <= camera.GetDistance())
 	{
-		// Check out of screen
-		if (backgroundImages[i].GetX() + backgroundImages[i].GetWidth() < 0) // if outside left screen edge
-		{
-			// Pick a random background texture
-			SetBackgroundImage(i);
-			// position at right of the last image
-			if (i == 0)
-				backgroundImages[i].SetX(backgroundImages[2].GetX() + backgroundImages[2].GetWidth() * backgroundImages[2].GetScale());
-			else
-				backgroundImages[i].SetX(backgroundImages[i-1].GetX() + backgroundImages[i-1].GetWidth() * backgroundImages[i-1].GetScale());
-		}
+		chunkStreamer.Retire(streamedChunks.front());
+		streamedChunks.pop_front();
+	}
 
-		// Move slowly left
-		backgroundImages[i].SetX(backgroundImages[i].GetX() - 50.0f * frameTime * timeScale);
+	// Take the chunks already generated while the ground has room for them, without waiting.
+	// Entering only copies the columns. If the worker falls behind the ground repeats its fill tile.
+	LevelChunk *chunk;
+	while (ground.GetQueueSpace() >= LevelGeneratorNS::CHUNK_COLUMNS && (chunk = chunkStreamer.Poll()) != NULL)
+	{
+		for (int i = 0; i < LevelGeneratorNS::CHUNK_COLUMNS; ++i)
+			ExtendGround(chunk->tiles[i], chunk->heights[i], chunk->flags[i]);
+		chunk->end = camera.ToDistance(ground.GetQueueEnd());
+		streamedChunks.push_back(chunk);
 	}
 
-	for (int i = 0; i < 18; ++i)
+	// If the worker falls behind the ground goes on flat, chunks start flat so they still join.
+	// The tile map never has to repeat its fill tile, which the heightfield would not know about.
+	while (TileMapNS::QUEUE_SIZE - ground.GetQueueSpace() < MIN_QUEUED)
+		ExtendGround(level.GetTiles().ground, 0, HeightfieldNS::SOLID);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::FillGround(float x)
+{
+	ground.Fill(level.GetTiles().ground, x);
+	heightfield.Reset(x);
+	for (int i = 0; i < ground.GetColumnCount(); ++i)
+		heightfield.Append(0, HeightfieldNS::SOLID);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::ExtendGround(BYTE tile, BYTE height, BYTE flags)
+{
+	ground.QueueColumn(tile, height);
+	heightfield.Append(height, flags);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::RestartLevel()
+{
+	while (!streamedChunks.empty())
 	{
-		// Check out of screen
-		if (platforms[i].GetX() + platforms[i].GetWidth() < 0) // if outside left screen edge
+		chunkStreamer.Retire(streamedChunks.front());
+		streamedChunks.pop_front();
+	}
+	levelSeed = (UINT)rand();
+	chunkStreamer.Restart(levelSeed);
+	FillGround(camera.GetX());
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::Hurt()
+{
+	// A stress run does not end
+	if (player.TookDamage() || stress.IsRunning())
+		return;
+
+	player.TakeDamage();
+	timeScale = 1.0f;
+	life--;
+	if (life > 0 && life < 5)
+		hearts[life].SetFrame(12);
+	else
+	{
+		hearts[0].SetFrame(12);
+		isPaused = true;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::Fall()
+{
+	Hurt();
+
+	// Dropped from mid screen above the first ground right of where the player fell
+	int column = heightfield.FindSolid(heightfield.GetColumnAt(player.GetCenterX()));
+	float x = column >= 0 ? heightfield.GetColumnX(column) : player.GetX();
+	if (x > camera.GetRight() - player.GetWidth())
+		x = camera.GetRight() - player.GetWidth();
+	player.SetX(x);
+	player.SetY(GAME_HEIGHT / 2);
+	player.SetGrounded(false);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::Spawn()
+{
+	// The next spawn is scheduled from the spawn, like the timer that was reset on it
+	spawnsDue.clear();
+	spawns.Advance(frameTime, spawnsDue);
+	for (size_t i = 0; i < spawnsDue.size(); ++i)
+	{
+		if (spawnsDue[i] == SPAWN_ENEMY)
+			enemyPending = true;
+		else if (spawnsDue[i] == SPAWN_PICKUP)
+			pickupPending = true;
+		else if (spawnsDue[i] == SPAWN_STRESS)
 		{
-			// position at right of the last image
-			if (i == 0)
-				platforms[i].SetX(platforms[17].GetX() + platforms[2].GetWidth());
-			else
-				platforms[i].SetX(platforms[i-1].GetX() + platforms[i-1].GetWidth());
+			// Spawns that find every entity of their kind in use are dropped
+			int spinnerCount, flyCount, pickupCount;
+			stress.TakeBatch(spinnerCount, flyCount, pickupCount);
+			while (spinnerCount-- > 0 && SpawnSpinner())
+				;
+			while (flyCount-- > 0 && SpawnFly())
+				;
+			while (pickupCount-- > 0 && SpawnPickup())
+				;
+			spawns.Schedule(SPAWN_STRESS, StressTestNS::SPAWN_INTERVAL);
 		}
+	}
 
-		// Move slowly left
-		platforms[i].SetX(platforms[i].GetX() - PickupNS::SPEED * frameTime * timeScale);
+	if (enemyPending && SpawnEnemy())
+	{
+		enemyPending = false;
+		spawns.Schedule(SPAWN_ENEMY, ENEMY_INTERVAL / timeScale);
+	}
+	if (pickupPending && SpawnPickup())
+	{
+		pickupPending = false;
+		spawns.Schedule(SPAWN_PICKUP, PICKUP_INTERVAL / timeScale);
 	}
 }
 
 //----------------------------------------------------------------------------------------------------
 
-void GameplayState::SpawnEnemies()
-{	
-	int rnd = rand() % 2;
-	for (int i = 0; i < 5; ++i)
+bool GameplayState::SpawnEnemy()
+{
+	if (rand() % 2 == 0)
+		return SpawnSpinner();
+	return SpawnFly();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool GameplayState::SpawnSpinner()
+{
+	for (int i = 0; i < (int)spinners.size(); ++i)
 	{
-		if (rnd == 0)
+		if (!spinners[i].GetActive())
 		{
-			if (!spinners[i].GetActive() && enemySpawnTimer > 3.0f / timeScale)
-			{
-				enemySpawnTimer = 0.0f;
-				spinners[i].Activate();
-				spinners[i].SetVisible(true);
-			}
+			float x = Place(LANE_GROUND, i, (float)spinners[i].GetWidth());
+			spinners[i].SetX(x);
+			spinners[i].SetY(heightfield.GetSurface(x, x + spinners[i].GetWidth()) - spinners[i].GetHeight() / 2);
+			spinners[i].Launch(SpinnerNS::DRIFT);
+			spinners[i].Activate();
+			spinners[i].SetVisible(true);
+			ScheduleDespawn(i);
+			return true;
 		}
-		else
+	}
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool GameplayState::SpawnFly()
+{
+	for (int i = 0; i < (int)flies.size(); ++i)
+	{
+		if (!flies[i].GetActive())
 		{
-			if (!flies[i].GetActive() && enemySpawnTimer > 3.0f / timeScale)
-			{
-				enemySpawnTimer = 0.0f;
-				flies[i].Activate();
-				flies[i].SetVisible(true);
-			}
+			float x = Place(LANE_JUMP, firstFly + i, (float)flies[i].GetWidth());
+			flies[i].SetX(x);
+			flies[i].SetY(heightfield.GetSurface(x, x + flies[i].GetWidth()) - flies[i].GetHeight() - player.GetWidth() - 16);
+			flies[i].Launch(FlyNS::DRIFT);
+			flies[i].Activate();
+			flies[i].SetVisible(true);
+			ScheduleDespawn(firstFly + i);
+			return true;
 		}
-		spinners[i].SetVelocity(VECTOR2(-1.0f * timeScale, 0.0f));
-		spinners[i].Update(frameTime);
-		flies[i].SetVelocity(VECTOR2(-1.0f * timeScale, 0.0f));
-		flies[i].Update(frameTime);
 	}
+	return false;
 }
 
 //----------------------------------------------------------------------------------------------------
 
-void GameplayState::SpawnPickups()
+bool GameplayState::SpawnPickup()
 {
 	int rnd = rand() % 2;
-	for(int i = 0; i < 10; ++i)
+	for(int i = 0; i < (int)pickups.size(); ++i)
 	{
 		// Initialize and activate 
-		if (!pickups[i].GetActive() && pickupSpawnTimer > 1.5f / timeScale)
+		if (!pickups[i].GetActive())
 		{
 			// Spawn gems with 1% chance
 			if (RandomFloat(0.0f, 1.0f) <= 0.05f)
 			{
-				if (!pickups[i].Initialize(this, 0, 0, 0, &pickupTextures[1]))
-					throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing pickup image"));
+				pickups[i].SetTexture(pickupTextures[1].Get());
 				pickups[i].SetGem(true);
 			}
 			else
 			{
-				if (!pickups[i].Initialize(this, 0, 0, 0, &pickupTextures[0]))
-					throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing pickup image"));
+				pickups[i].SetTexture(pickupTextures[0].Get());
 				pickups[i].SetGem(false);
 			}
 
-			// Set Y position
-			if (rnd == 0)
-				pickups[i].SetY(GAME_HEIGHT - platforms[0].GetHeight() - pickups[i].GetHeight() - 32);
+			// Set position, above the ground where it is placed
+			int lane = rnd == 0 ? LANE_GROUND : LANE_JUMP;
+			float x = Place(lane, firstPickup + i, (float)pickups[i].GetWidth());
+			float surface = heightfield.GetSurface(x, x + pickups[i].GetWidth());
+			if (lane == LANE_GROUND)
+				pickups[i].SetY(surface - pickups[i].GetHeight() - 32);
 			else
-				pickups[i].SetY(GAME_HEIGHT - platforms[0].GetHeight() - pickups[i].GetHeight() - player.GetWidth() - 48);
+				pickups[i].SetY(surface - pickups[i].GetHeight() - player.GetWidth() - 48);
 
-			pickupSpawnTimer = 0.0f;
+			pickups[i].SetX(x);
 			pickups[i].Activate();
 			pickups[i].SetVisible(true);
+			ScheduleDespawn(firstPickup + i);
+			return true;
+		}
+	}
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::Despawn()
+{
+	int id;
+	while ((id = despawns.PopDue(camera.GetDistance())) >= 0)
+	{
+		// A drifting enemy may have moved on since it was scheduled
+		Entity *mover = GetMover(id);
+		mover->Advance();
+		if (mover->GetX() + mover->GetWidth() >= camera.GetX())
+		{
+			ScheduleDespawn(id);
+			continue;
 		}
-		
-		pickups[i].SetVelocity(VECTOR2(-1.0f * timeScale, 0.0f));
-		pickups[i].Update(frameTime);
+
+		Vacate(id);
+		if (id >= firstPickup)
+		{
+			pickups[id - firstPickup].Reset();
+			continue;
+		}
+		mover->SetActive(false);
+		mover->SetVisible(false);
+		mover->SetX(camera.GetRight());	// position at right screen edge
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::ScheduleDespawn(int id)
+{
+	Entity *mover = GetMover(id);
+	despawns.Schedule(id, camera.ToDistance(mover->GetX() + mover->GetWidth()));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float GameplayState::Place(int lane, int id, float width)
+{
+	// A stress run spawns more than the lanes hold, anywhere within a screen past the right edge
+	if (stress.IsRunning())
+		return camera.GetRight() + RandomFloat(0.0f, GAME_WIDTH);
+
+	// In camera distance like the despawns, a rebase does not move it
+	double from = camera.ToDistance(camera.GetRight());
+	double x = lanes[lane].FindFree(from - SPAWN_GAP, width + 2.0f * SPAWN_GAP) + SPAWN_GAP;
+	lanes[lane].Insert(id, x - SPAWN_GAP, x + width + SPAWN_GAP);
+	return camera.GetRight() + (float)(x - from);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::Vacate(int id)
+{
+	if (!lanes[LANE_GROUND].Remove(id))
+		lanes[LANE_JUMP].Remove(id);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Entity* GameplayState::GetMover(int id)
+{
+	if (id >= firstPickup)
+		return &pickups[id - firstPickup];
+	if (id >= firstFly)
+		return &flies[id - firstFly];
+	return &spinners[id];
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::SetPools()
+{
+	size_t spinnerCount = stress.GetSpinnerPool() > SPINNER_COUNT ? stress.GetSpinnerPool() : SPINNER_COUNT;
+	size_t flyCount = stress.GetFlyPool() > FLY_COUNT ? stress.GetFlyPool() : FLY_COUNT;
+	size_t pickupCount = stress.GetPickupPool() > PICKUP_COUNT ? stress.GetPickupPool() : PICKUP_COUNT;
+
+	// Pools only grow, the new entities are initialized like the first ones
+	for (size_t i = spinners.size(); i < spinnerCount; ++i)
+	{
+		spinners.push_back(Spinner());
+		if (!spinners[i].Initialize(this, SpinnerNS::WIDTH, SpinnerNS::HEIGHT, SpinnerNS::TEXTURE_COLS, spinnerTexture.Get()))
+			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing spinner"));
+		spinners[i].Play(&spinnerClip);
+		spinners[i].SetX(camera.GetRight());
+		spinners[i].SetY(ground.GetTop() - spinners[i].GetHeight() / 2);
+	}
+
+	for (size_t i = flies.size(); i < flyCount; ++i)
+	{
+		flies.push_back(Fly());
+		if (!flies[i].Initialize(this, FlyNS::WIDTH, FlyNS::HEIGHT, FlyNS::TEXTURE_COLS, flyTexture.Get()))
+			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing fly"));
+		flies[i].Play(&flyClip);
+		flies[i].SetX(camera.GetRight());
+		flies[i].SetY(ground.GetTop() - flies[i].GetHeight() - player.GetWidth() - 16);
 	}
+
+	for (size_t i = pickups.size(); i < pickupCount; ++i)
+	{
+		pickups.push_back(Pickup());
+		if (!pickups[i].Initialize(this, 0, 0, 0, pickupTextures[0].Get()))
+			throw(GameError(GameErrorNS::FATAL_ERROR, "Error initializing pickup image"));
+		pickups[i].SetX(camera.GetRight());
+	}
+
+	firstFly = (int)spinners.size();
+	firstPickup = firstFly + (int)flies.size();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::ScheduleSpawns()
+{
+	spawns.Clear();
+	if (stress.IsRunning())
+		spawns.Schedule(SPAWN_STRESS, StressTestNS::SPAWN_INTERVAL);
+	else
+	{
+		spawns.Schedule(SPAWN_ENEMY, ENEMY_INTERVAL);
+		spawns.Schedule(SPAWN_PICKUP, PICKUP_INTERVAL);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int GameplayState::CountActive()
+{
+	int count = 0;
+	for (size_t i = 0; i < spinners.size(); ++i)
+		count += spinners[i].GetActive() ? 1 : 0;
+	for (size_t i = 0; i < flies.size(); ++i)
+		count += flies[i].GetActive() ? 1 : 0;
+	for (size_t i = 0; i < pickups.size(); ++i)
+		count += pickups[i].GetActive() ? 1 : 0;
+	return count;
 }
 
 
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::RebaseWorld(float shift)
+{
+	// Everything in world coordinates moves back with the origin
+	ground.Rebase(shift);
+	heightfield.Rebase(shift);
+	player.SetX(player.GetX() - shift);
+	for (size_t i = 0; i < spinners.size(); ++i)
+		spinners[i].SetX(spinners[i].GetX() - shift);
+	for (size_t i = 0; i < flies.size(); ++i)
+		flies[i].SetX(flies[i].GetX() - shift);
+	for (size_t i = 0; i < pickups.size(); ++i)
+		pickups[i].SetX(pickups[i].GetX() - shift);
+}
+
 //----------------------------------------------------------------------------------------------------
 
 void GameplayState::Restart()
 {
+	RestartLevel();
+
 	// Reset Entities
 	// Player
-	player.SetX(GAME_WIDTH / 3);
+	player.SetX(camera.GetX() + GAME_WIDTH / 3);
 	player.SetY(GAME_HEIGHT / 2);
 	player.SetGrounded(false);
 	player.Update(frameTime);
 
 	// Spinners
-	for (int i = 0; i < 5; ++i)
+	for (size_t i = 0; i < spinners.size(); ++i)
 	{
 		spinners[i].SetActive(false);
 		spinners[i].SetVisible(false);
-		spinners[i].SetX(GAME_WIDTH);
-		spinners[i].SetY(GAME_HEIGHT - platforms[0].GetHeight() - spinners[i].GetHeight() / 2);
+		spinners[i].SetX(camera.GetRight());
+		spinners[i].SetY(ground.GetTop() - spinners[i].GetHeight() / 2);
 	}
 	
 	// Flies
-	for (int i = 0; i < 5; ++i)
+	for (size_t i = 0; i < flies.size(); ++i)
 	{
 		flies[i].SetActive(false);
 		flies[i].SetVisible(false);
-		flies[i].SetX(GAME_WIDTH);
-		flies[i].SetY(GAME_HEIGHT - platforms[0].GetHeight() - flies[i].GetHeight() - player.GetWidth() - 16);
+		flies[i].SetX(camera.GetRight());
+		flies[i].SetY(ground.GetTop() - flies[i].GetHeight() - player.GetWidth() - 16);
 	}
 
 	// Coins
-	for (int i = 0; i < 10; ++i)
+	for (size_t i = 0; i < pickups.size(); ++i)
 	{
 		pickups[i].SetActive(false);
 		pickups[i].SetVisible(false);
-		pickups[i].SetX(GAME_WIDTH);
+		pickups[i].SetX(camera.GetRight());
 	}
 
 	// Initialize UI elements
 	// Hearts
 	for (int i = 0; i < 5; ++i)
 	{
-		hearts[i].SetCurrentFrame(13);
-	}
-
-	// coinText
-	for (int i = 0; i < 3; ++i)
-	{
-		coinText[i].SetCurrentFrame(0);
+		hearts[i].SetFrame(13);
 	}
+	coinCounter.SetValue(0);
+	gemCounter.SetValue(0);
 
-	// gemText
-	for (int i = 0; i < 2; ++i)
-	{
-		gemText[i].SetCurrentFrame(0);
-	}
-
-	enemySpawnTimer = 0.0f;
-	pickupSpawnTimer = 0.0f;
+	despawns.Clear();
+	lanes[LANE_GROUND].Clear();
+	lanes[LANE_JUMP].Clear();
+	ScheduleSpawns();
+	enemyPending = false;
+	pickupPending = false;
 	timeScale = 1.0f;
 	maxTimeScale = 3.3f;
 	life = 5;
@@ -591,22 +923,86 @@ void GameplayState::Restart()
 
 //----------------------------------------------------------------------------------------------------
 
-void GameplayState::ReleaseAll()
+void GameplayState::ConsoleCommand()
 {
-	for (int i = 0; i < 2; ++i)
+	Game::ConsoleCommand();
+
+	if (command == "/help")
 	{
-		backgroundTextures[i].OnLostDevice();
+		benchmarks.PrintHelp();
+		console->print("/stress N [enemies flies] - spawn N per second, shares of enemies and of flies among them, and time the frame");
+		console->print("/stress off - back to the normal spawns");
 	}
-	platformTexture.OnLostDevice();
-	playerTexture.OnLostDevice();
-	spinnerTexture.OnLostDevice();
-	flyTexture.OnLostDevice();
 
-	for (int i = 0; i < 2; ++i)
+	if (command.compare(0, 7, "/stress") == 0)
 	{
-		pickupTextures[i].OnLostDevice();
+		float rate;
+		float enemyShare = 0.5f;
+		float flyShare = 0.5f;
+		if (command == "/stress off")
+		{
+			stress.Stop();
+			Restart();
+			console->print("stress Off");
+		}
+		else if (sscanf(command.c_str() + 7, "%f %f %f", &rate, &enemyShare, &flyShare) >= 1 && rate > 0.0f)
+		{
+			StartStress(rate, enemyShare, flyShare);
+			console->print(stress.GetReport());
+		}
+		else
+			console->print("/stress N [enemies flies] | off");
 	}
-	uiTexture.OnLostDevice();
+
+	if (command.compare(0, 6, "/bench") == 0 && !benchmarks.Run(command))
+		console->print("/bench blit | load | bake | png");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::ParseCommandLine(const char *commandLine)
+{
+	if (commandLine == NULL)
+		return;
+
+	// -stress N [enemies flies] as the console command, -seconds S quits after S seconds of it,
+	// -log file appends its reports to file
+	const char *option = strstr(commandLine, "-stress");
+	float rate;
+	float enemyShare = 0.5f;
+	float flyShare = 0.5f;
+	if (option && sscanf(option + 7, "%f %f %f", &rate, &enemyShare, &flyShare) >= 1 && rate > 0.0f)
+		stress.Start(rate, enemyShare, flyShare);
+
+	float seconds;
+	option = strstr(commandLine, "-seconds");
+	if (option && sscanf(option + 8, "%f", &seconds) == 1)
+		stress.SetDuration(seconds);
+
+	char file[MAX_PATH];
+	option = strstr(commandLine, "-log");
+	if (option && sscanf(option + 4, "%259s", file) == 1)
+		stressLog = file;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::StartStress(float rate, float enemyShare, float flyShare)
+{
+	// Entity ids change with the pools, the run starts over with them
+	stress.Start(rate, enemyShare, flyShare);
+	SetPools();
+	Restart();
+	if (!stressLog.empty() && !stress.OpenLog(stressLog.c_str()))
+		console->print("Unable to create " + stressLog);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void GameplayState::ReleaseAll()
+{
+	// Textures are released by Game::ReleaseAll through the registry
+	hud.OnLostDevice();
 
 	SAFE_ON_LOST_DEVICE(gameOverFont);
 	SAFE_ON_LOST_DEVICE(replayFont);
@@ -618,20 +1014,7 @@ void GameplayState::ReleaseAll()
 
 void GameplayState::ResetAll()
 {
-	for (int i = 0; i < 2; ++i)
-	{
-		backgroundTextures[i].OnResetDevice();
-	}
-	platformTexture.OnResetDevice();
-	playerTexture.OnResetDevice();
-	spinnerTexture.OnResetDevice();
-	flyTexture.OnResetDevice();
-
-	for (int i = 0; i < 2; ++i)
-	{
-		pickupTextures[i].OnResetDevice();
-	}
-	uiTexture.OnResetDevice();
+	hud.OnResetDevice();
 
 	SAFE_ON_RESET_DEVICE(gameOverFont);
 	SAFE_ON_RESET_DEVICE(replayFont);
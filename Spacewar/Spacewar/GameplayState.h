@@ -4,15 +4,30 @@
 #define _GAMEPLAYSTATE_H_
 #define WIN32_LEAN_AND_MEAN
 
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "ChunkStreamer.h"
+#include "DespawnQueue.h"
 #include "Fly.h"
 #include "Game.h"
+#include "Heightfield.h"
+#include "HudLayer.h"
 #include "Image.h"
-#include "LevelPlatform.h"
+#include "IntervalTree.h"
+#include "LevelGenerator.h"
+#include "ParallaxLayer.h"
 #include "Pickup.h"
 #include "Player.h"
 #include "Spinner.h"
-#include "TextureManager.h"
-#include "UIElement.h"
+#include "StressTest.h"
+#include "TileMap.h"
+#include "TimingWheel.h"
+#include "TextureRegistry.h"
+#include "UICounter.h"
+#include "UIIcon.h"
 
 class GameplayState : public Game
 {
@@ -27,49 +42,107 @@ public:
 	void AI();
 	void Collisions();
 	void Render();
+	void RenderOverlay();
 	void ReleaseAll();
 	void ResetAll();
 	void Restart();
+	void ConsoleCommand();
 #pragma endregion
 
+	// Options given to the game, call before Initialize. See the -stress option.
+	void ParseCommandLine(const char *commandLine);
+
 private:
-	void SetBackgroundImage(int index);
 	void ScrollingBackground();
-	void SpawnEnemies();
-	void SpawnPickups();	
+	void StreamLevel();				// queue generated chunks into the ground, retire the ones passed
+	void RestartLevel();			// new seed, flat ground from the camera on
+	void FillGround(float x);		// flat ground from world x on
+	void ExtendGround(BYTE tile, BYTE height, BYTE flags);	// queue a column into the tiles and the heightfield
+	void Hurt();					// lose a life unless just hurt
+	void Fall();					// fell through a gap, back on the next ground
+	void Spawn();					// spawns that came due
+	bool SpawnEnemy();				// a spinner or a fly, false if every one of the kind is in use
+	bool SpawnSpinner();
+	bool SpawnFly();
+	bool SpawnPickup();				// false if every pickup is in use
+	void Despawn();					// entities the camera passed
+	void ScheduleDespawn(int id);	// leave when the camera passes the right edge of the entity
+	Entity* GetMover(int id);		// spinners, then flies, then pickups
+	void SetPools();				// enough entities for the stress run, call Restart after a change
+	void ScheduleSpawns();			// first spawns of a run
+	int CountActive();				// enemies and pickups in the world
+	void StartStress(float rate, float enemyShare, float flyShare);
+	// World x of the first free room in lane from the right screen edge on, taken by id from now on
+	float Place(int lane, int id, float width);
+	void Vacate(int id);			// give back the room of id
+	void RebaseWorld(float shift);	// move everything in world coordinates after Camera::Rebase
 
 private:
-	// Textures
-	TextureManager backgroundTextures[2];
-	TextureManager platformTexture;
-	TextureManager playerTexture;
-	TextureManager spinnerTexture;
-	TextureManager flyTexture;
-	TextureManager pickupTextures[2];
-	TextureManager uiTexture;
+	// Textures, held from the registry
+	TextureHandle platformTextures[5];	// ground, left and right end, under raised ground, hazard
+	TextureHandle playerTexture;
+	TextureHandle spinnerTexture;
+	TextureHandle flyTexture;
+	TextureHandle pickupTextures[2];
+	TextureHandle uiTexture;
 
 	// Text
 	TextDX* gameOverFont;
 	TextDX* replayFont;
 
-	// Background Images
-	Image backgroundImages[3];
+	// Background
+	ParallaxLayer background;
+	TileMap ground;
+	Heightfield heightfield;			// ground collisions, column for column with the ground tiles
+
+	// Level, generated ahead of the camera
+	LevelGenerator level;
+	ChunkStreamer chunkStreamer;		// after level, it is shut down first
+	std::deque<LevelChunk*> streamedChunks;	// queued into the ground or on screen, in order
+	UINT levelSeed;
+
+	// Animations, shared by every entity playing them
+	AnimationClip walkClip;
+	AnimationClip spinnerClip;
+	AnimationClip flyClip;
 
 	// Entities
-	LevelPlatform platforms[18];
 	Player player;
-	Spinner spinners[5];
-	Fly	flies [5];
-	Pickup pickups[10];
-	UIElement playerIcon;
-	UIElement coinIcon;
-	UIElement gemIcon;
-	UIElement hearts[5];
-	UIElement coinText[3];
-	UIElement gemText[2];
-
-	float enemySpawnTimer;
-	float pickupSpawnTimer;
+	std::vector<Spinner> spinners;
+	std::vector<Fly> flies;
+	std::vector<Pickup> pickups;
+	int firstFly;			// id of GetMover of the first fly
+	int firstPickup;
+	DespawnQueue despawns;	// ids of GetMover
+	IntervalTree lanes[2];	// room taken on the ground and at jump height, camera distance by id of GetMover
+
+	// Spawns waiting for their time
+	TimingWheel spawns;
+	std::vector<int> spawnsDue;
+	bool enemyPending;		// due while every enemy was in use, spawned once one is free
+	bool pickupPending;
+
+	// Asset pipeline benchmarks (/bench)
+	Benchmarks benchmarks;
+
+	// Stress runs (/stress)
+	StressTest stress;
+	std::string stressLog;	// file the reports go to, from the command line
+
+	// HUD, composed into one texture when score or life change
+	HudLayer hud;
+	UINode hudRoot;
+	UINode livesGroup;
+	UINode heartsRow;
+	UINode coinGroup;
+	UINode gemGroup;
+	UIIcon playerIcon;
+	UIIcon hearts[5];
+	UIIcon coinIcon;
+	UICounter coinCounter;
+	UIIcon gemIcon;
+	UICounter gemCounter;
+
 	float timeScale;
 	float maxTimeScale;
 	int life;
@@ -1,4 +1,18 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AssetPack.h"
+#include "BakedTexture.h"
+#include "CoverageGrid.h"
 #include "Graphics.h"
+#include "ImageScaler.h"
+#include "OpacityMap.h"
+#include "PngDecoder.h"
+#include "RenderRecorder.h"
+#include "ShadowCache.h"
+#include "SpriteCuller.h"
 
 Graphics::Graphics()
 	: direct3D (NULL)
@@ -7,8 +21,31 @@ Graphics::Graphics()
 	, fullscreen (false)
 	, width (GAME_WIDTH)
 	, height (GAME_HEIGHT)
+	, savedTarget (NULL)
+	, renderScale (1.0f)
+	, sceneTexture (NULL)
+	, sceneBackBuffer (NULL)
+	, sceneScaled (false)
+	, viewX (0.0f)
+	, viewY (0.0f)
+	, recorder (NULL)
+	, spriteBatchOpen (false)
+	, cullingOn (true)
+	, occlusionOn (true)
+	, diskLoads (0)
+	, bakedLoads (0)
+	, bakedWrites (0)
+	, baking (true)
+	, pack (NULL)
+	, pngDecoding (true)
 {
 	backColor = GraphicsNS::BACK_COLOR; // dark blue
+	culler = new SpriteCuller();
+	coverage = new CoverageGrid();
+	shadows = new ShadowCache();
+	spriteQueue.reserve(GraphicsNS::SPRITE_QUEUE_RESERVE);
+	ZeroMemory(&stats, sizeof(stats));
+	ZeroMemory(&lastStats, sizeof(lastStats));
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -16,6 +53,11 @@ Graphics::Graphics()
 Graphics::~Graphics()
 {
 	ReleaseAll();
+	SafeDelete(culler);
+	SafeDelete(coverage);
+	SafeDelete(shadows);
+	for (std::map<std::string, OpacityMap*>::iterator it = opacityMaps.begin(); it != opacityMaps.end(); ++it)
+		SafeDelete(it->second);
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -60,6 +102,8 @@ void Graphics::Initialize(HWND hw, int w, int h, bool full)
 	{
 		behavior = D3DCREATE_HARDWARE_VERTEXPROCESSING;
 	}
+	// The AssetLoader decodes textures into system memory on worker threads
+	behavior |= D3DCREATE_MULTITHREADED;
 
 	// Create Direct3D device
 	result = direct3D->CreateDevice(D3DADAPTER_DEFAULT,
@@ -93,9 +137,6 @@ HRESULT Graphics::LoadTexture(const char *filename, COLOR_ARGB transcolor, UINT
 	//		transcolor = transparent color
 	// Post: width and height = size of texture
 	//		 texture points to texture
-
-	// The struct for reading file info
-	D3DXIMAGE_INFO info;
 	result = E_FAIL;
 
 	try
@@ -106,28 +147,28 @@ HRESULT Graphics::LoadTexture(const char *filename, COLOR_ARGB transcolor, UINT
 			return D3DERR_INVALIDCALL;
 		}
 
-		// Get width and height from file
-		result = D3DXGetImageInfoFromFile(filename, &info);
-		if (result != D3D_OK)
-			return result;
-		width = info.Width;
-		height = info.Height;
-
-		// Create the new texture by loading from file
-		result = D3DXCreateTextureFromFileEx( device3D,				//3D device
-											  filename,				//image filename
-											  info.Width,			//texture width
-											  info.Height,			//texture height
-											  1,					//mip-map levels (1 for no chain)
-											  0,					//usage
-											  D3DFMT_UNKNOWN,		//surface format (default)
-											  D3DPOOL_DEFAULT,		//memory class for the texture
-											  D3DX_DEFAULT,			//image filter
-											  D3DX_DEFAULT,			//mip filter
-											  transcolor,			//color key for transparency
-											  &info,				//bitmap file info (from loaded file)
-											  NULL,					//color palette
-											  &texture );			//destination texture
+		// The file is decoded once, after that the texture is recreated from its system memory copy
+		std::string key = ShadowKey(filename, transcolor);
+		std::map<std::string, LP_TEXTURE>::iterator copy = decoded.find(key);
+		if (copy != decoded.end())
+		{
+			// Decoded ahead by the AssetLoader
+			LP_TEXTURE pixels = copy->second;
+			decoded.erase(copy);
+			result = LoadTextureFromCopy(filename, transcolor, pixels, width, height, texture);
+		}
+		else if (shadows->GetSize(key, width, height))
+			result = LoadTextureFromShadow(key, width, height, texture);
+		if (FAILED(result))
+		{
+			result = LoadTextureFromFile(filename, transcolor, width, height, texture);
+			if (FAILED(result))
+				return result;
+		}
+
+		textureFiles[texture] = filename;
+		std::map<std::string, OpacityMap*>::iterator found = opacityMaps.find(filename);
+		textureOpacity[texture] = found != opacityMaps.end() ? found->second : NULL;
 	}
 
 	catch(...)
@@ -139,11 +180,317 @@ HRESULT Graphics::LoadTexture(const char *filename, COLOR_ARGB transcolor, UINT
 
 //----------------------------------------------------------------------------------------------------
 
+HRESULT Graphics::LoadTextureFromFile(const char *filename, COLOR_ARGB transcolor, UINT &width, UINT &height, LP_TEXTURE &texture)
+{
+	// Decode into system memory where it can be locked, copied to the shadows and uploaded
+	LP_TEXTURE copy = NULL;
+	HRESULT loaded = DecodeTexture(filename, transcolor, copy);
+	if (FAILED(loaded))
+	{
+		SafeRelease(copy);
+		return loaded;
+	}
+	diskLoads++;
+	return LoadTextureFromCopy(filename, transcolor, copy, width, height, texture);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+HRESULT Graphics::LoadTextureFromCopy(const char *filename, COLOR_ARGB transcolor, LP_TEXTURE copy, UINT &width, UINT &height, LP_TEXTURE &texture)
+{
+	D3DSURFACE_DESC desc;
+	D3DLOCKED_RECT locked;
+	HRESULT loaded = copy->GetLevelDesc(0, &desc);
+	if (FAILED(loaded))
+	{
+		SafeRelease(copy);
+		return loaded;
+	}
+	width = desc.Width;
+	height = desc.Height;
+
+	if (desc.Format == D3DFMT_A8R8G8B8 && SUCCEEDED(copy->LockRect(0, &locked, NULL, D3DLOCK_READONLY)))
+	{
+		shadows->Store(ShadowKey(filename, transcolor), (const uint32_t*)locked.pBits, locked.Pitch / sizeof(DWORD), desc.Width, desc.Height);
+		copy->UnlockRect(0);
+	}
+	ClassifyOpacity(filename, copy);
+
+	loaded = UploadTexture(copy, texture);
+	SafeRelease(copy);
+	return loaded;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+HRESULT Graphics::DecodeTexture(const char *filename, COLOR_ARGB transcolor, LP_TEXTURE &copy)
+{
+	// Called from the loader threads, only locals and the interlocked counters are touched.
+	// The file is read once, packed files are used where they are mapped.
+	// A variant is decoded from the file it is a variant of.
+	std::string file;
+	float scale;
+	SplitVariant(filename, file, scale);
+	const BYTE *source = NULL;
+	UINT sourceSize = 0;
+	std::vector<BYTE> loose;
+	if (pack == NULL || !pack->Find(file.c_str(), source, sourceSize))
+	{
+		if (!ReadFileBytes(file.c_str(), loose))
+			return D3DXERR_INVALIDDATA;
+		source = &loose[0];
+		sourceSize = (UINT)loose.size();
+	}
+
+	UINT64 hash = 0;
+	std::string cacheFile;
+	if (baking)
+	{
+		// A bake of the same file content skips decoding and keying
+		hash = BakedTexture::HashSource(source, sourceSize, transcolor);
+		cacheFile = BakedTexture::GetCachePath(filename, transcolor);
+		BakedTexture baked;
+		if (baked.Open(cacheFile.c_str(), hash))
+		{
+			HRESULT created = device3D->CreateTexture(baked.GetWidth(), baked.GetHeight(), 1, 0, D3DFMT_A8R8G8B8,
+				D3DPOOL_SYSTEMMEM, &copy, NULL);
+			D3DLOCKED_RECT locked;
+			if (SUCCEEDED(created) && SUCCEEDED(copy->LockRect(0, &locked, NULL, 0)))
+			{
+				baked.CopyTo((DWORD*)locked.pBits, locked.Pitch / sizeof(DWORD));
+				copy->UnlockRect(0);
+				InterlockedIncrement(&bakedLoads);
+				return D3D_OK;
+			}
+			SafeRelease(copy);
+		}
+	}
+
+	// PNG files the decoder handles go straight into the texture, the rest to D3DX
+	HRESULT decoded = E_FAIL;
+	UINT width, height;
+	if (pngDecoding && PngDecoder::ReadHeader(source, sourceSize, width, height))
+	{
+		D3DLOCKED_RECT locked;
+		decoded = device3D->CreateTexture(width, height, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM, &copy, NULL);
+		if (SUCCEEDED(decoded))
+			decoded = copy->LockRect(0, &locked, NULL, 0);
+		if (SUCCEEDED(decoded))
+		{
+			PngDecoder png;
+			if (!png.Decode(source, sourceSize, transcolor, (uint32_t*)locked.pBits, locked.Pitch / sizeof(DWORD)))
+				decoded = E_FAIL;
+			copy->UnlockRect(0);
+		}
+		if (FAILED(decoded))
+			SafeRelease(copy);
+	}
+	if (FAILED(decoded))
+	{
+		D3DXIMAGE_INFO info;
+		decoded = D3DXGetImageInfoFromFileInMemory(source, sourceSize, &info);
+		if (FAILED(decoded))
+			return decoded;
+		// Variants are shrunk from 32 bit ARGB
+		decoded = D3DXCreateTextureFromFileInMemoryEx(device3D, source, sourceSize, info.Width, info.Height, 1, 0,
+			scale < 1.0f ? D3DFMT_A8R8G8B8 : D3DFMT_UNKNOWN, D3DPOOL_SYSTEMMEM, D3DX_DEFAULT, D3DX_DEFAULT, transcolor, &info, NULL, &copy);
+	}
+	if (SUCCEEDED(decoded) && scale < 1.0f)
+	{
+		decoded = ShrinkTexture(copy, scale);
+		if (FAILED(decoded))
+			SafeRelease(copy);
+	}
+
+	// Bake it for the next launch, only 32 bit ARGB is baked
+	D3DSURFACE_DESC desc;
+	D3DLOCKED_RECT locked;
+	if (SUCCEEDED(decoded) && baking && SUCCEEDED(copy->GetLevelDesc(0, &desc)) && desc.Format == D3DFMT_A8R8G8B8
+		&& SUCCEEDED(copy->LockRect(0, &locked, NULL, D3DLOCK_READONLY)))
+	{
+		if (BakedTexture::Write(cacheFile.c_str(), hash, transcolor, (const DWORD*)locked.pBits,
+			locked.Pitch / sizeof(DWORD), desc.Width, desc.Height))
+			InterlockedIncrement(&bakedWrites);
+		copy->UnlockRect(0);
+	}
+	return decoded;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+HRESULT Graphics::ShrinkTexture(LP_TEXTURE &copy, float scale)
+{
+	// Box filtered on the CPU, D3DX would need the device for a filtered copy
+	D3DSURFACE_DESC desc;
+	HRESULT shrunk = copy->GetLevelDesc(0, &desc);
+	if (FAILED(shrunk))
+		return shrunk;
+	if (desc.Format != D3DFMT_A8R8G8B8)
+		return D3DERR_INVALIDCALL;
+
+	UINT width = ImageScaler::ScaledSize(desc.Width, scale);
+	UINT height = ImageScaler::ScaledSize(desc.Height, scale);
+	LP_TEXTURE smaller = NULL;
+	shrunk = device3D->CreateTexture(width, height, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM, &smaller, NULL);
+	if (FAILED(shrunk))
+		return shrunk;
+
+	D3DLOCKED_RECT from, to;
+	shrunk = copy->LockRect(0, &from, NULL, D3DLOCK_READONLY);
+	if (SUCCEEDED(shrunk))
+	{
+		shrunk = smaller->LockRect(0, &to, NULL, 0);
+		if (SUCCEEDED(shrunk))
+		{
+			ImageScaler::Downscale((const DWORD*)from.pBits, from.Pitch / sizeof(DWORD), desc.Width, desc.Height,
+				(DWORD*)to.pBits, to.Pitch / sizeof(DWORD), width, height);
+			smaller->UnlockRect(0);
+		}
+		copy->UnlockRect(0);
+	}
+	if (FAILED(shrunk))
+	{
+		SafeRelease(smaller);
+		return shrunk;
+	}
+	SafeRelease(copy);
+	copy = smaller;
+	return D3D_OK;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+std::string Graphics::VariantName(const char *file, float scale)
+{
+	if (scale >= 1.0f)
+		return file;
+	char suffix[16];
+	_snprintf(suffix, sizeof(suffix), "%c%.2f", GraphicsNS::VARIANT_SEPARATOR, scale);
+	return std::string(file) + suffix;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::SplitVariant(const char *name, std::string &file, float &scale)
+{
+	const char *separator = strrchr(name, GraphicsNS::VARIANT_SEPARATOR);
+	scale = separator != NULL ? (float)atof(separator + 1) : 0.0f;
+	if (scale <= 0.0f || scale >= 1.0f)
+	{
+		file = name;
+		scale = 1.0f;
+		return;
+	}
+	file.assign(name, separator);
+	scale = Clamp(scale, GraphicsNS::MIN_VARIANT_SCALE, 1.0f);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Graphics::ReadFileBytes(const char *filename, std::vector<BYTE> &bytes)
+{
+	FILE *fp = fopen(filename, "rb");
+	if (fp == NULL)
+		return false;
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	bool read = size > 0;
+	if (read)
+	{
+		bytes.resize(size);
+		read = fread(&bytes[0], 1, size, fp) == (size_t)size;
+	}
+	fclose(fp);
+	return read;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void* Graphics::DecodeImage(const char *file, uint32_t transcolor)
+{
+	LP_TEXTURE copy = NULL;
+	if (FAILED(DecodeTexture(file, transcolor, copy)))
+		SafeRelease(copy);
+	return copy;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::ReleaseImage(void *image)
+{
+	LP_TEXTURE copy = (LP_TEXTURE)image;
+	SafeRelease(copy);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::AddDecodedTexture(const char *filename, COLOR_ARGB transcolor, LP_TEXTURE copy)
+{
+	// A copy decoded twice replaces the older one
+	std::string key = ShadowKey(filename, transcolor);
+	std::map<std::string, LP_TEXTURE>::iterator it = decoded.find(key);
+	if (it != decoded.end())
+		SafeRelease(it->second);
+	decoded[key] = copy;
+	diskLoads++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+HRESULT Graphics::LoadTextureFromShadow(const std::string &key, UINT width, UINT height, LP_TEXTURE &texture)
+{
+	LP_TEXTURE copy = NULL;
+	HRESULT loaded = device3D->CreateTexture(width, height, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM, &copy, NULL);
+	if (FAILED(loaded))
+		return loaded;
+
+	D3DLOCKED_RECT locked;
+	loaded = copy->LockRect(0, &locked, NULL, 0);
+	if (SUCCEEDED(loaded))
+	{
+		if (!shadows->Restore(key, (uint32_t*)locked.pBits, locked.Pitch / sizeof(DWORD)))
+			loaded = E_FAIL;
+		copy->UnlockRect(0);
+	}
+	if (SUCCEEDED(loaded))
+		loaded = UploadTexture(copy, texture);
+	SafeRelease(copy);
+	return loaded;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+std::string Graphics::ShadowKey(const char *filename, COLOR_ARGB transcolor)
+{
+	// The same file keyed with another color is another image
+	char color[16];
+	_snprintf(color, sizeof(color), "|%08X", (UINT)transcolor);
+	return std::string(filename) + color;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+HRESULT Graphics::UploadTexture(LP_TEXTURE copy, LP_TEXTURE &texture)
+{
+	D3DSURFACE_DESC desc;
+	HRESULT uploaded = copy->GetLevelDesc(0, &desc);
+	if (FAILED(uploaded))
+		return uploaded;
+	uploaded = device3D->CreateTexture(desc.Width, desc.Height, 1, 0, desc.Format, D3DPOOL_DEFAULT, &texture, NULL);
+	if (FAILED(uploaded))
+		return uploaded;
+	uploaded = device3D->UpdateTexture(copy, texture);
+	if (FAILED(uploaded))
+		SafeRelease(texture);
+	return uploaded;
+}
+
+//----------------------------------------------------------------------------------------------------
+
 HRESULT Graphics::LoadTextureSystemMem(const char *filename, COLOR_ARGB transcolor, 
                                     UINT &width, UINT &height, LP_TEXTURE &texture)
 {
-    // The struct for reading bitmap file info
-    D3DXIMAGE_INFO info;
     result = E_FAIL;        // Standard Windows return value
 
     try{
@@ -152,30 +499,17 @@ HRESULT Graphics::LoadTextureSystemMem(const char *filename, COLOR_ARGB transcol
             texture = NULL;
             return D3DERR_INVALIDCALL;
         }
- 
-        // Get width and height from bitmap file
-        result = D3DXGetImageInfoFromFile(filename, &info);
-        if (result != D3D_OK)
+
+        // From the asset pack or a bake when there is one, otherwise from the file
+        result = DecodeTexture(filename, transcolor, texture);
+        if (FAILED(result))
             return result;
-        width = info.Width;
-        height = info.Height;
-
-        // Create the new texture by loading a bitmap image file
-        result = D3DXCreateTextureFromFileEx( 
-            device3D,           //3D device
-            filename,           //bitmap filename
-            info.Width,         //bitmap image width
-            info.Height,        //bitmap image height
-            1,                  //mip-map levels (1 for no chain)
-            0,                  //usage
-            D3DFMT_UNKNOWN,     //surface format (default)
-            D3DPOOL_SYSTEMMEM,  //systemmem is lockable
-            D3DX_DEFAULT,       //image filter
-            D3DX_DEFAULT,       //mip filter
-            transcolor,         //color key for transparency
-            &info,              //bitmap file info (from loaded file)
-            NULL,               //color palette
-            &texture );         //destination texture
+
+        // Width and height of the image
+        D3DSURFACE_DESC desc;
+        result = texture->GetLevelDesc(0, &desc);
+        width = desc.Width;
+        height = desc.Height;
 
     } catch(...)
     {
@@ -186,6 +520,43 @@ HRESULT Graphics::LoadTextureSystemMem(const char *filename, COLOR_ARGB transcol
 
 //----------------------------------------------------------------------------------------------------
 
+const OpacityMap* Graphics::ClassifyOpacity(const char *filename, LP_TEXTURE copy)
+{
+	// Textures are reloaded after a device reset, the pixels do not change
+	std::map<std::string, OpacityMap*>::iterator found = opacityMaps.find(filename);
+	if (found != opacityMaps.end())
+		return found->second;
+
+	// Default pool textures cannot be locked, read the system memory copy they are uploaded from
+	OpacityMap *opacity = NULL;
+	D3DSURFACE_DESC desc;
+	D3DLOCKED_RECT locked;
+	if (SUCCEEDED(copy->GetLevelDesc(0, &desc))
+		&& (desc.Format == D3DFMT_A8R8G8B8 || desc.Format == D3DFMT_X8R8G8B8)
+		&& SUCCEEDED(copy->LockRect(0, &locked, NULL, D3DLOCK_READONLY)))
+	{
+		opacity = new OpacityMap();
+		opacity->Build((const BYTE*)locked.pBits, locked.Pitch, desc.Width, desc.Height, desc.Format == D3DFMT_A8R8G8B8);
+		copy->UnlockRect(0);
+	}
+
+	// Unknown formats are remembered too, as never opaque
+	opacityMaps[filename] = opacity;
+	return opacity;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+const OpacityMap* Graphics::GetOpacity(LP_TEXTURE texture)
+{
+	std::map<LP_TEXTURE, const OpacityMap*>::iterator found = textureOpacity.find(texture);
+	if (found == textureOpacity.end())
+		return NULL;
+	return found->second;
+}
+
+//----------------------------------------------------------------------------------------------------
+
 HRESULT Graphics::CreateVertexBuffer(VertexC verts[], UINT size, LP_VERTEXBUFFER &vertexBuffer)
 {
     // Standard Windows return value
@@ -233,11 +604,11 @@ bool Graphics::DrawQuad(LP_VERTEXBUFFER vertexBuffer)
 
 //----------------------------------------------------------------------------------------------------
 
-void Graphics::DrawSprite(const SpriteData &spriteData, COLOR_ARGB color)
+void Graphics::DrawSprite(const SpriteData &spriteData, COLOR_ARGB color, SpriteTransform *transform)
 {
 	// Draw the sprite described in SpriteData structure.
 	// Color is optional, it is applied as a filter, WHITE is default (no change).
-	// Creates a sprite Begin/End pair.
+	// Between SpriteBegin/SpriteEnd the sprite is queued and drawn when the queue is flushed.
 	// Pre: spriteData.rect defines the portion of spriteData.texture to draw
 	//		spriteData.rect.right must be right edge + 1
 	//		spriteData.rect.bottom must be bottom edge + 1
@@ -245,6 +616,197 @@ void Graphics::DrawSprite(const SpriteData &spriteData, COLOR_ARGB color)
 	if(spriteData.texture == NULL)
 		return;
 
+	// Everything after this is in screen coordinates
+	SpriteData screen = spriteData;
+	screen.x -= viewX;
+	screen.y -= viewY;
+
+	// Sprites drawn into a texture are not part of the frame
+	if (recorder && savedTarget == NULL)
+		recorder->RecordSprite(screen, color);
+
+	if (spriteBatchOpen)
+	{
+		QueuedSprite queued;
+		queued.spriteData = screen;
+		queued.color = color;
+		queued.transform = transform;
+		queued.worldX = spriteData.x;
+		queued.worldY = spriteData.y;
+		spriteQueue.push_back(queued);
+		return;
+	}
+
+	SubmitSprite(screen, color, transform, spriteData.x, spriteData.y);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::FlushSprites()
+{
+	UINT count = (UINT)spriteQueue.size();
+	if (count == 0)
+		return;
+
+	if (cullingOn)
+	{
+		// One SIMD pass over the whole batch
+		culler->SetViewport(0.0f, 0.0f, (float)width, (float)height);
+		culler->Clear();
+		for (UINT i = 0; i < count; ++i)
+			culler->Add(spriteQueue[i].spriteData);
+		stats.spritesCulled += count - culler->Cull(spriteVisible);
+	}
+	else
+		spriteVisible.assign(count, 1);
+
+	if (occlusionOn)
+		OccludeSprites();
+
+	// Submit the survivors in order
+	for (UINT i = 0; i < count; ++i)
+	{
+		if (spriteVisible[i])
+		{
+			const QueuedSprite &queued = spriteQueue[i];
+			SubmitSprite(queued.spriteData, queued.color, queued.transform, queued.worldX, queued.worldY);
+		}
+	}
+	spriteQueue.clear();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::OccludeSprites()
+{
+	// Walk front to back. A sprite is dropped when the opaque sprites in front of it cover it,
+	// otherwise its covered edges are trimmed and its own opaque part is added to the mask.
+	coverage->Reset(width, height);
+	for (int i = (int)spriteQueue.size() - 1; i >= 0; --i)
+	{
+		if (!spriteVisible[i])
+			continue;
+
+		QueuedSprite &queued = spriteQueue[i];
+		float left, top, right, bottom;
+		GetSpriteBounds(queued.spriteData, left, top, right, bottom);
+		if (coverage->IsCovered(left, top, right, bottom))
+		{
+			spriteVisible[i] = 0;
+			stats.spritesOccluded++;
+			continue;
+		}
+
+		float trimmed = coverage->Trim(queued.spriteData);
+		if (trimmed > 0.0f)
+		{
+			// Drawn from the trimmed rect this frame, the cached matrix is left for the whole sprite
+			stats.pixelsTrimmed += (UINT)trimmed;
+			queued.transform = NULL;
+		}
+		if (queued.spriteData.width <= 0 || queued.spriteData.height <= 0)
+		{
+			spriteVisible[i] = 0;
+			stats.spritesOccluded++;
+			continue;
+		}
+
+		const OpacityMap *opacity = GetOpacity(queued.spriteData.texture);
+		if (opacity)
+			coverage->CoverOpaque(queued.spriteData, queued.color, *opacity);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::GetSpriteBounds(const SpriteData &spriteData, float &left, float &top, float &right, float &bottom)
+{
+	// Same bounds as SpriteCuller, the scaled rect rotated around its center
+	float hw = spriteData.width * spriteData.scale * 0.5f;
+	float hh = spriteData.height * spriteData.scale * 0.5f;
+	float cx = spriteData.x + hw;
+	float cy = spriteData.y + hh;
+	hw = fabsf(hw);
+	hh = fabsf(hh);
+
+	float ex = hw;
+	float ey = hh;
+	if (spriteData.angle != 0.0f)
+	{
+		float c = fabsf(cosf(spriteData.angle));
+		float s = fabsf(sinf(spriteData.angle));
+		ex = c * hw + s * hh;
+		ey = s * hw + c * hh;
+	}
+	left = cx - ex;
+	top = cy - ey;
+	right = cx + ex;
+	bottom = cy + ey;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::SubmitSprite(const SpriteData &spriteData, COLOR_ARGB color, SpriteTransform *transform, float worldX, float worldY)
+{
+	stats.spritesSubmitted++;
+
+	// Overdraw, on screen area of the sprite bounds
+	float left, top, right, bottom;
+	GetSpriteBounds(spriteData, left, top, right, bottom);
+	left = left > 0.0f ? left : 0.0f;
+	top = top > 0.0f ? top : 0.0f;
+	right = right < (float)width ? right : (float)width;
+	bottom = bottom < (float)height ? bottom : (float)height;
+	if (right > left && bottom > top)
+		stats.pixelsDrawn += (UINT)((right - left) * (bottom - top));
+
+	D3DXMATRIX matrix;
+	bool viewed = false;
+	if (transform == NULL)
+	{
+		BuildSpriteMatrix(spriteData, matrix);
+		stats.transformsBuilt++;
+	}
+	else
+	{
+		// The cache holds the world position, it stays current while the view scrolls
+		SpriteData world = spriteData;
+		world.x = worldX;
+		world.y = worldY;
+		if (IsTransformCurrent(*transform, world))
+			stats.transformsReused++;
+		else
+		{
+			UpdateTransform(*transform, world);
+			stats.transformsBuilt++;
+		}
+		matrix = transform->matrix;
+		if (worldX != spriteData.x || worldY != spriteData.y)
+		{
+			// Moving an affine matrix only changes its translation row
+			matrix._41 += spriteData.x - worldX;
+			matrix._42 += spriteData.y - worldY;
+			viewed = true;
+		}
+	}
+
+	// Tell the sprite about the matrix, the cached one stays in game coordinates
+	if (sceneScaled)
+	{
+		matrix = matrix * sceneMatrix;
+		sprite->SetTransform(&matrix);
+	}
+	else
+		sprite->SetTransform(transform && !viewed ? &transform->matrix : &matrix);
+
+	// Draw the sprite
+	sprite->Draw(spriteData.texture, &spriteData.rect, NULL, NULL, color);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::BuildSpriteMatrix(const SpriteData &spriteData, D3DXMATRIX &matrix)
+{
 	// Find center of sprite
 	D3DXVECTOR2 spriteCenter = D3DXVECTOR2((float)(spriteData.width / 2 * spriteData.scale), 
 											(float)(spriteData.height / 2 * spriteData.scale));
@@ -279,7 +841,6 @@ void Graphics::DrawSprite(const SpriteData &spriteData, COLOR_ARGB color)
 	}
 
 	// Create a matrix to rotate, scale and position our sprite
-	D3DXMATRIX matrix;
 	D3DXMatrixTransformation2D( &matrix,
 								NULL,						// keep origin at top left when scaling
 								0.0f,						// no scaling rotation
@@ -287,12 +848,191 @@ void Graphics::DrawSprite(const SpriteData &spriteData, COLOR_ARGB color)
 								&spriteCenter,				// rotation center
 								(float)(spriteData.angle),	// rotation angle
 								&translate);				// X,Y location
+}
 
-	// Tell the sprite about the matrix
-	sprite->SetTransform(&matrix);
+//----------------------------------------------------------------------------------------------------
 
-	// Draw the sprite
-	sprite->Draw(spriteData.texture, &spriteData.rect, NULL, NULL, color);
+bool Graphics::IsTransformCurrent(const SpriteTransform &transform, const SpriteData &spriteData)
+{
+	// The source rect and texture do not affect the matrix, animation frames can change freely
+	return transform.valid
+		&& transform.x == spriteData.x
+		&& transform.y == spriteData.y
+		&& transform.scale == spriteData.scale
+		&& transform.angle == spriteData.angle
+		&& transform.width == spriteData.width
+		&& transform.height == spriteData.height
+		&& transform.flipHorizontal == spriteData.flipHorizontal
+		&& transform.flipVertical == spriteData.flipVertical;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::UpdateTransform(SpriteTransform &transform, const SpriteData &spriteData)
+{
+	BuildSpriteMatrix(spriteData, transform.matrix);
+	transform.x = spriteData.x;
+	transform.y = spriteData.y;
+	transform.scale = spriteData.scale;
+	transform.angle = spriteData.angle;
+	transform.width = spriteData.width;
+	transform.height = spriteData.height;
+	transform.flipHorizontal = spriteData.flipHorizontal;
+	transform.flipVertical = spriteData.flipVertical;
+	transform.valid = true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+HRESULT Graphics::CreateRenderTexture(UINT w, UINT h, LP_TEXTURE &texture)
+{
+	result = E_FAIL;
+	if (device3D == NULL)
+		return result;
+	result = device3D->CreateTexture(w, h, 1, D3DUSAGE_RENDERTARGET, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT, &texture, NULL);
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+HRESULT Graphics::BeginRenderToTexture(LP_TEXTURE texture)
+{
+	result = E_FAIL;
+	if (device3D == NULL || texture == NULL || savedTarget != NULL || spriteBatchOpen)
+		return result;
+
+	LP_SURFACE surface = NULL;
+	result = texture->GetSurfaceLevel(0, &surface);
+	if (FAILED(result))
+		return result;
+
+	device3D->GetRenderTarget(0, &savedTarget);
+	result = device3D->SetRenderTarget(0, surface);
+	SafeRelease(surface); // the device keeps its own reference
+	if (FAILED(result))
+	{
+		SafeRelease(savedTarget);
+		return result;
+	}
+
+	device3D->Clear(0, NULL, D3DCLEAR_TARGET, 0, 1.0F, 0);
+	sprite->Begin(0); // no alpha blending, texels are copied as they are
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::EndRenderToTexture()
+{
+	if (savedTarget == NULL)
+		return;
+
+	sprite->End();
+	device3D->SetRenderTarget(0, savedTarget);
+	SafeRelease(savedTarget);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+HRESULT Graphics::BeginScaledScene()
+{
+	result = S_OK;
+	if (renderScale >= 1.0f || device3D == NULL || sceneScaled || savedTarget != NULL || spriteBatchOpen)
+		return result;
+
+	if (sceneTexture == NULL)
+	{
+		result = CreateRenderTexture(width, height, sceneTexture);
+		if (FAILED(result))
+			return result;
+	}
+
+	LP_SURFACE surface = NULL;
+	result = sceneTexture->GetSurfaceLevel(0, &surface);
+	if (FAILED(result))
+		return result;
+
+	device3D->GetRenderTarget(0, &sceneBackBuffer);
+	result = device3D->SetRenderTarget(0, surface);
+	SafeRelease(surface);
+	if (FAILED(result))
+	{
+		SafeRelease(sceneBackBuffer);
+		return result;
+	}
+
+	// Width and height are rounded to whole pixels, scale each on its own so the upscale is exact
+	UINT w = GetScaledWidth();
+	UINT h = GetScaledHeight();
+	D3DXMatrixScaling(&sceneMatrix, (float)w / width, (float)h / height, 1.0f);
+	D3DRECT area = { 0, 0, (LONG)w, (LONG)h };
+	device3D->Clear(1, &area, D3DCLEAR_TARGET, backColor, 1.0F, 0);
+	sceneScaled = true;
+	return result;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::EndScaledScene()
+{
+	if (!sceneScaled)
+		return;
+	sceneScaled = false;
+
+	device3D->SetRenderTarget(0, sceneBackBuffer);
+
+	LP_SURFACE surface = NULL;
+	if (SUCCEEDED(sceneTexture->GetSurfaceLevel(0, &surface)))
+	{
+		RECT area = { 0, 0, (LONG)GetScaledWidth(), (LONG)GetScaledHeight() };
+		device3D->StretchRect(surface, &area, sceneBackBuffer, NULL, D3DTEXF_LINEAR);
+		SafeRelease(surface);
+	}
+	SafeRelease(sceneBackBuffer);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::SpriteBegin()
+{
+	if (recorder)
+		recorder->RecordSpriteBegin();
+	sprite->Begin(D3DXSPRITE_ALPHABLEND);
+	spriteBatchOpen = true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::SpriteEnd()
+{
+	if (recorder)
+		recorder->RecordSpriteEnd();
+	FlushSprites();
+	spriteBatchOpen = false;
+	sprite->End();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Graphics::ReleaseTexture(LP_TEXTURE &texture)
+{
+	if (texture == NULL)
+		return;
+	textureFiles.erase(texture);
+	textureOpacity.erase(texture);
+	if (recorder)
+		recorder->ForgetTexture(texture);
+	SafeRelease(texture);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+const char* Graphics::GetTextureFile(LP_TEXTURE texture)
+{
+	std::map<LP_TEXTURE, std::string>::iterator it = textureFiles.find(texture);
+	if (it == textureFiles.end())
+		return NULL;
+	return it->second.c_str();
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -404,6 +1144,9 @@ bool Graphics::IsAdapterCompatible()
 
 HRESULT Graphics::Reset()
 {
+	// Default pool, recreated by the next scaled scene
+	SafeRelease(sceneTexture);
+
 	InitD3DPP();
 	result = device3D->Reset(&d3DPP); // attempt to reset graphics device
 	return result;
@@ -413,6 +1156,12 @@ HRESULT Graphics::Reset()
 
 void Graphics::ReleaseAll()
 {
+	for (std::map<std::string, LP_TEXTURE>::iterator it = decoded.begin(); it != decoded.end(); ++it)
+		SafeRelease(it->second);
+	decoded.clear();
+	textureFiles.clear();
+	textureOpacity.clear();
+	SafeRelease(sceneTexture);
 	SafeRelease(device3D);
 	SafeRelease(direct3D);
 }
@@ -5,9 +5,13 @@
 
 #include <d3d9.h>
 #include <d3dx9.h>
+#include <map>
+#include <string>
+#include <vector>
 
 #include "Constants.h"
 #include "GameError.h"
+#include "TextureSink.h"
 
 // DirectX pointer types
 #define LP_3D		LPDIRECT3D9
@@ -15,6 +19,7 @@
 #define LP_DXFONT   LPD3DXFONT
 #define LP_SPRITE	LPD3DXSPRITE
 #define LP_TEXTURE	LPDIRECT3DTEXTURE9
+#define LP_SURFACE	LPDIRECT3DSURFACE9
 #define VECTOR2		D3DXVECTOR2
 #define LP_VERTEXBUFFER LPDIRECT3DVERTEXBUFFER9
 
@@ -55,8 +60,33 @@ namespace GraphicsNS
 	const COLOR_ARGB BACK_COLOR = BLACK;							// background color of game
 
 	enum DISPLAY_MODE{TOGGLE, FULLSCREEN, WINDOW};
+
+	const UINT SPRITE_QUEUE_RESERVE = 256;	// initial capacity of the sprite queue
+
+	// A texture file name ending in "@scale" loads the image shrunk by scale, such as "ship.png@0.50"
+	const char VARIANT_SEPARATOR = '@';
+	const float MIN_VARIANT_SCALE = 0.05f;
+
+	// Renderer counters for one frame, see Graphics::GetFrameStats
+	struct FrameStats
+	{
+		UINT spritesSubmitted;	// sprites sent to D3DXSprite
+		UINT spritesCulled;		// sprites outside the viewport, never sent
+		UINT transformsBuilt;	// sprite matrices computed
+		UINT transformsReused;	// sprite matrices taken from a SpriteTransform cache
+		UINT spritesOccluded;	// sprites hidden behind opaque sprites, never sent
+		UINT pixelsDrawn;		// screen pixels covered by the submitted sprites
+		UINT pixelsTrimmed;		// pixels cut from sprite edges hidden behind opaque sprites
+	};
 }
 
+class RenderRecorder;
+class SpriteCuller;
+class CoverageGrid;
+class OpacityMap;
+class ShadowCache;
+class AssetPack;
+
 struct VertexC              // Vertex with Color
 {
     float x, y, z;          // vertex location
@@ -84,7 +114,33 @@ struct SpriteData
 	bool flipVertical;		// true to flip sprite vertically
 };
 
-class Graphics
+// Sprite matrix cached by the object that draws the sprite, see Graphics::DrawSprite.
+// The SpriteData fields the matrix was built from are kept so it is only rebuilt when one changes.
+struct SpriteTransform
+{
+	D3DXMATRIX matrix;
+	float x;
+	float y;
+	float scale;
+	float angle;
+	int width;
+	int height;
+	bool flipHorizontal;
+	bool flipVertical;
+	bool valid;				// false until the first build
+};
+
+// A sprite waiting in the queue between SpriteBegin and SpriteEnd
+struct QueuedSprite
+{
+	SpriteData spriteData;		// in screen coordinates
+	COLOR_ARGB color;
+	SpriteTransform *transform;	// may be NULL, kept in world coordinates
+	float worldX;				// position as drawn, before the view was subtracted
+	float worldY;
+};
+
+class Graphics : public TextureSink
 {
 public:
 	Graphics();
@@ -102,6 +158,18 @@ public:
 
 	// Transform vector v with matrix m.
 	static VECTOR2* Vector2Transform(VECTOR2 *v, D3DXMATRIX *m) {return D3DXVec2TransformCoord(v,v,m);}
+
+	// Build the matrix that rotates, scales, flips and positions a sprite.
+	static void BuildSpriteMatrix(const SpriteData &spriteData, D3DXMATRIX &matrix);
+
+	// Return true if transform was built from the same position, scale, angle, size and flip as spriteData.
+	static bool IsTransformCurrent(const SpriteTransform &transform, const SpriteData &spriteData);
+
+	// Rebuild transform from spriteData and remember the fields it depends on.
+	static void UpdateTransform(SpriteTransform &transform, const SpriteData &spriteData);
+
+	// Screen space box around a sprite as DrawSprite places it: the scaled rect rotated around its center.
+	static void GetSpriteBounds(const SpriteData &spriteData, float &left, float &top, float &right, float &bottom);
 #pragma endregion
 
 #pragma region Member Functions
@@ -114,6 +182,10 @@ public:
 		if(device3D == NULL)
 			return result;
 
+		// Start counting a new frame
+		lastStats = stats;
+		ZeroMemory(&stats, sizeof(stats));
+
 		// Clear backbuffer to backColor
 		device3D->Clear(0, NULL, D3DCLEAR_TARGET, backColor, 1.0F, 0);
 		result = device3D->BeginScene(); // begin scene for drawing
@@ -128,17 +200,36 @@ public:
 	}
 
 	HRESULT LoadTexture(const char * filename, COLOR_ARGB transcolor, UINT &width, UINT &height, LP_TEXTURE &texture);
-	void DrawSprite(const SpriteData &spriteData, COLOR_ARGB color = GraphicsNS::WHITE); // default to white color filter (no change)
+	// Release a texture from LoadTexture. What is known about it is dropped, its address can be reused.
+	void ReleaseTexture(LP_TEXTURE &texture);
+	// transform is an optional cache owned by the caller, it must stay alive until the sprite is flushed.
+	void DrawSprite(const SpriteData &spriteData, COLOR_ARGB color = GraphicsNS::WHITE, SpriteTransform *transform = NULL); // default to white color filter (no change)
 	
-	void SpriteBegin()
-	{
-		sprite->Begin(D3DXSPRITE_ALPHABLEND);
-	}
+	// Sprites drawn between SpriteBegin and SpriteEnd are queued, culled against
+	// the viewport as one batch and submitted on SpriteEnd or FlushSprites.
+	void SpriteBegin();
+	void SpriteEnd();
+	void FlushSprites();	// submit queued sprites now, call before drawing anything that is not a sprite
 
-	void SpriteEnd() 
-	{
-		sprite->End();
-	}
+	// Sprites drawn after SetView are in world coordinates, x and y are subtracted to put them on screen.
+	// Culling and occlusion work on the screen position. Set it back to 0, 0 for the HUD.
+	void SetView(float x, float y)			{ viewX = x; viewY = y; }
+	float GetViewX()						{ return viewX; }
+	float GetViewY()						{ return viewY; }
+
+	// Textures that can be drawn into. They live in default pool and must be released before a device reset.
+	HRESULT CreateRenderTexture(UINT width, UINT height, LP_TEXTURE &texture);
+	// Redirect drawing into texture, cleared to transparent. Sprites are copied without blending so
+	// the texture holds the same alpha as the sources. Call outside SpriteBegin/SpriteEnd.
+	HRESULT BeginRenderToTexture(LP_TEXTURE texture);
+	void EndRenderToTexture();	// draw to the back buffer again
+
+	// Dynamic resolution. Between BeginScaledScene and EndScaledScene everything is drawn into an
+	// offscreen target at the render scale, sprites keep their game coordinates. EndScaledScene
+	// stretches it over the back buffer, what is drawn after that is at native resolution.
+	// Both do nothing at scale 1. Call outside SpriteBegin/SpriteEnd.
+	HRESULT BeginScaledScene();
+	void EndScaledScene();
 
 	void ChangeDisplayMode(GraphicsNS::DISPLAY_MODE mode = GraphicsNS::TOGGLE);
 	void SetBackColor(COLOR_ARGB c) { backColor = c; }	// set color used to clear screen
@@ -148,6 +239,20 @@ public:
     HRESULT CreateVertexBuffer(VertexC verts[], UINT size, LP_VERTEXBUFFER &vertexBuffer);
     bool DrawQuad(LP_VERTEXBUFFER vertexBuffer);
 	HRESULT LoadTextureSystemMem(const char *filename, COLOR_ARGB transcolor, UINT &width, UINT &height, LP_TEXTURE &texture);
+	// Decode a file into a new system memory texture. Safe to call from any thread.
+	// With baking on, a baked copy of the same file content is read instead and new decodes are baked.
+	// PNG files are decoded with PngDecoder unless it is turned off, other files and PNG formats it does not handle with D3DX.
+	// Variants are shrunk after decoding and baked at their own size.
+	HRESULT DecodeTexture(const char *filename, COLOR_ARGB transcolor, LP_TEXTURE &copy);
+	// Hand over a copy from DecodeTexture, the next LoadTexture of the file uploads it instead of reading the file
+	void AddDecodedTexture(const char *filename, COLOR_ARGB transcolor, LP_TEXTURE copy);
+	// TextureSink for the AssetLoader, DecodeTexture with the copy as the image
+	void* DecodeImage(const char *file, uint32_t transcolor);
+	void ReleaseImage(void *image);
+	// Name of file shrunk by scale, file itself at scale 1
+	static std::string VariantName(const char *file, float scale);
+	// Post: file = name without the variant, scale = 1 if name is not a variant
+	static void SplitVariant(const char *name, std::string &file, float &scale);
 	HRESULT Reset();			// reset the graphics device.
 	void ReleaseAll();			// releases direct3d and device3d
 #pragma endregion
@@ -158,6 +263,37 @@ public:
 	HDC GetDeviceContext()		{ return GetDC(hwnd); }
 	LP_SPRITE GetSprite()		{ return sprite; }
 	bool GetFullscreen()		{ return fullscreen; }
+	RenderRecorder* GetRecorder()			{ return recorder; }
+	void SetRecorder(RenderRecorder *r)	{ recorder = r; }	// capture draw submissions, NULL to stop
+	const char* GetTextureFile(LP_TEXTURE texture);		// file a texture was loaded from, NULL if unknown
+	bool GetCulling()						{ return cullingOn; }
+	void SetCulling(bool c)					{ cullingOn = c; }
+	bool GetOcclusion()						{ return occlusionOn; }
+	void SetOcclusion(bool o)				{ occlusionOn = o; }
+	float GetRenderScale()					{ return renderScale; }
+	void SetRenderScale(float s)			{ renderScale = Clamp(s, 0.1f, 1.0f); }	// used from the next BeginScaledScene
+	// Size of the scene as rendered before the upscale
+	UINT GetScaledWidth()					{ return (UINT)(width * renderScale + 0.5f); }
+	UINT GetScaledHeight()					{ return (UINT)(height * renderScale + 0.5f); }
+	// Back buffer pixels per game pixel
+	float GetOutputScale()					{ return (float)width / GAME_WIDTH; }
+	// Opaque regions of a texture loaded with LoadTexture, NULL if unknown
+	const OpacityMap* GetOpacity(LP_TEXTURE texture);
+	// Pixels of the textures loaded with LoadTexture, reloading them does not read the file again
+	ShadowCache* GetShadows()				{ return shadows; }
+	UINT GetDiskLoads()						{ return diskLoads; }	// files decoded for LoadTexture
+	UINT GetBakedLoads()					{ return (UINT)bakedLoads; }	// decodes served by a baked file
+	UINT GetBakedWrites()					{ return (UINT)bakedWrites; }	// files baked
+	bool GetBaking()						{ return baking; }
+	void SetBaking(bool b)					{ baking = b; }	// not while the loader is busy
+	bool GetPngDecoding()					{ return pngDecoding; }
+	void SetPngDecoding(bool d)				{ pngDecoding = d; }	// not while the loader is busy
+	// Files found in the pack are read from it instead of the disk, NULL to read loose files.
+	// The pack must stay open while it is set, change it only while the loader is idle.
+	AssetPack* GetPack()					{ return pack; }
+	void SetPack(AssetPack *p)				{ pack = p; }
+	// Counters of the last completed frame
+	const GraphicsNS::FrameStats& GetFrameStats() { return lastStats; }
 #pragma endregion
 
 private:
@@ -176,7 +312,62 @@ private:
 	int			height;
 	COLOR_ARGB	backColor; // background color
 
+	// Render target saved by BeginRenderToTexture, NULL when drawing to the back buffer
+	LP_SURFACE	savedTarget;
+
+	// Dynamic resolution
+	float		renderScale;
+	LP_TEXTURE	sceneTexture;	// native size, only the top left GetScaledWidth x GetScaledHeight is used
+	LP_SURFACE	sceneBackBuffer;	// back buffer while the scene is redirected
+	D3DXMATRIX	sceneMatrix;	// game coordinates to the scaled scene
+	bool		sceneScaled;
+
+	// World position at the top left of the screen
+	float		viewX;
+	float		viewY;
+
+	// Render capture
+	RenderRecorder* recorder;
+	std::map<LP_TEXTURE, std::string> textureFiles;			// until ReleaseTexture
+
+	// Opaque regions, classified once per file and kept across device resets
+	std::map<std::string, OpacityMap*> opacityMaps;
+	std::map<LP_TEXTURE, const OpacityMap*> textureOpacity;	// until ReleaseTexture
+
+	// System memory copies of loaded textures, kept across device resets
+	ShadowCache* shadows;
+	UINT diskLoads;
+	std::map<std::string, LP_TEXTURE> decoded;	// by shadow key, waiting for LoadTexture
+	volatile LONG bakedLoads;	// counted from the loader threads
+	volatile LONG bakedWrites;
+	bool baking;
+	AssetPack* pack;
+	bool pngDecoding;
+
+	// Sprite queue
+	std::vector<QueuedSprite> spriteQueue;
+	std::vector<BYTE> spriteVisible;
+	SpriteCuller* culler;
+	CoverageGrid* coverage;
+	bool spriteBatchOpen;
+	bool cullingOn;
+	bool occlusionOn;
+
+	GraphicsNS::FrameStats stats;		// frame being drawn
+	GraphicsNS::FrameStats lastStats;	// last completed frame
+
 	void InitD3DPP();	// intialize d3D Presentation Parameters
+	// Draw immediately. spriteData is on screen, drawn at worldX, worldY before the view was subtracted.
+	void SubmitSprite(const SpriteData &spriteData, COLOR_ARGB color, SpriteTransform *transform, float worldX, float worldY);
+	void OccludeSprites();	// front to back pass over the visible queued sprites
+	const OpacityMap* ClassifyOpacity(const char *filename, LP_TEXTURE copy);
+	HRESULT LoadTextureFromFile(const char *filename, COLOR_ARGB transcolor, UINT &width, UINT &height, LP_TEXTURE &texture);
+	HRESULT LoadTextureFromCopy(const char *filename, COLOR_ARGB transcolor, LP_TEXTURE copy, UINT &width, UINT &height, LP_TEXTURE &texture);	// releases copy
+	HRESULT LoadTextureFromShadow(const std::string &key, UINT width, UINT height, LP_TEXTURE &texture);
+	static bool ReadFileBytes(const char *filename, std::vector<BYTE> &bytes);
+	static std::string ShadowKey(const char *filename, COLOR_ARGB transcolor);
+	HRESULT ShrinkTexture(LP_TEXTURE &copy, float scale);	// replaces copy with a smaller one
+	HRESULT UploadTexture(LP_TEXTURE copy, LP_TEXTURE &texture);	// default pool texture holding the pixels of a system memory copy
 
 };
 #endif // _GRAPHICS_H_
\ No newline at end of file
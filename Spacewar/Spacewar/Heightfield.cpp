@@ -0,0 +1,127 @@
+#include "Heightfield.h"
+
+using namespace HeightfieldNS;
+
+Heightfield::Heightfield()
+	: end (0)
+	, originX (0.0)
+	, tileSize (1.0f)
+	, baseTop (0.0f)
+{
+	ZeroMemory(columns, sizeof(columns));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Heightfield::Initialize(float size, float top)
+{
+	tileSize = size;
+	baseTop = top;
+	Reset(0.0f);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Heightfield::Reset(float x)
+{
+	end = 0;
+	originX = x;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Heightfield::Append(BYTE height, BYTE flags)
+{
+	Column &column = columns[end % MAX_COLUMNS];
+	column.height = height;
+	column.flags = flags;
+	end++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+BYTE Heightfield::GetFlags(int column) const
+{
+	if (!IsKept(column))
+		return 0;
+	return At(column).flags;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float Heightfield::GetTop(int column) const
+{
+	if (!IsKept(column))
+		return baseTop;
+	return baseTop - At(column).height * tileSize;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int Heightfield::FindSolid(int column) const
+{
+	int first = end > MAX_COLUMNS ? end - MAX_COLUMNS : 0;
+	for (column = column > first ? column : first; column < end; ++column)
+	{
+		if (At(column).flags & SOLID)
+			return column;
+	}
+	return -1;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float Heightfield::GetSurface(float from, float to) const
+{
+	float surface = baseTop;
+	bool solid = false;
+	int last = GetColumnAt(to);
+	for (int column = GetColumnAt(from); column <= last; ++column)
+	{
+		if (!IsSolid(column))
+			continue;
+		float top = GetTop(column);
+		if (!solid || top < surface)
+			surface = top;
+		solid = true;
+	}
+	return surface;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Heightfield::Probe(float from, float to, float lastY, float y, GroundContact &contact) const
+{
+	contact.grounded = false;
+	contact.top = baseTop;
+	contact.hazard = false;
+	contact.wall = false;
+	contact.wallX = 0.0f;
+	contact.wallTop = baseTop;
+
+	// A span is a few columns wide, each one is a lookup
+	int last = GetColumnAt(to);
+	for (int column = GetColumnAt(from); column <= last; ++column)
+	{
+		BYTE flags = GetFlags(column);
+		if (!(flags & SOLID))
+			continue;
+
+		float top = GetTop(column);
+		if (lastY > top + SNAP_DISTANCE)
+		{
+			contact.wall = true;
+			contact.wallX = GetColumnX(column);
+			contact.wallTop = top;
+			return;
+		}
+		if (y < top - SNAP_DISTANCE)
+			continue;	// above it
+
+		if (!contact.grounded || top < contact.top)
+			contact.top = top;
+		contact.grounded = true;
+		if (flags & HAZARD)
+			contact.hazard = true;
+	}
+}
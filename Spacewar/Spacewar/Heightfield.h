@@ -0,0 +1,86 @@
+#ifndef _HEIGHTFIELD_H_
+#define _HEIGHTFIELD_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <math.h>
+
+#include "Constants.h"
+
+namespace HeightfieldNS
+{
+	const int MAX_COLUMNS = 128;		// columns kept, covers the screen and the ground queue
+	const float SNAP_DISTANCE = 8.0f;	// feet this close to a top stand on it
+
+	// Column attributes, a column without SOLID is a gap
+	const BYTE SOLID = 1;
+	const BYTE HAZARD = 2;				// hurts whoever stands on it
+}
+
+// Feet against the heightfield, see Heightfield::Probe
+struct GroundContact
+{
+	bool grounded;		// standing on or landed on top
+	float top;			// highest top stood on
+	bool hazard;		// one of the columns stood on is a hazard
+	bool wall;			// ran into the side of a higher column
+	float wallX;		// left edge of that column
+	float wallTop;
+};
+
+// Ground heights and attributes by world column, for collisions. Column n is n columns
+// right of the one the field was reset at, its world x follows with one multiply.
+// Columns are appended in order as the level streams in and kept in a ring, so any
+// lookup is a single index into it.
+class Heightfield
+{
+public:
+	Heightfield();
+
+	// Pre: tileSize = width of a column, baseTop = top of the columns 0 rows high
+	void Initialize(float tileSize, float baseTop);
+
+	// Forget every column, the next one appended starts at world x
+	void Reset(float x);
+	// Append the next column, height rows above the base. Columns MAX_COLUMNS behind are dropped
+	void Append(BYTE height, BYTE flags);
+	// The world origin moved right by shift, see Camera::Rebase
+	void Rebase(float shift)				{ originX -= shift; }
+
+	// World column at world x, may be one that is not kept
+	int GetColumnAt(float x) const			{ return (int)floor((x - originX) / tileSize); }
+	float GetColumnX(int column) const		{ return (float)(originX + column * (double)tileSize); }
+	BYTE GetFlags(int column) const;		// 0 if not kept
+	bool IsSolid(int column) const			{ return (GetFlags(column) & HeightfieldNS::SOLID) != 0; }
+	float GetTop(int column) const;
+	int FindSolid(int column) const;		// first solid column kept at or right of column, -1 if none
+
+	// Post: highest top of the solid columns between world x from and to, the base top if none is solid
+	float GetSurface(float from, float to) const;
+
+	// Feet spanning world x from..to moved down from lastY to y this tick. Columns are taken
+	// from left to right, the feet stand on a top they were above or within SNAP_DISTANCE of,
+	// a top they were already below is a wall and ends the span.
+	void Probe(float from, float to, float lastY, float y, GroundContact &contact) const;
+
+	float GetBaseTop() const				{ return baseTop; }
+	int GetEnd() const						{ return end; }		// column the next Append sets
+
+private:
+	struct Column
+	{
+		BYTE height;
+		BYTE flags;
+	};
+
+	bool IsKept(int column) const			{ return column >= 0 && column < end && column >= end - HeightfieldNS::MAX_COLUMNS; }
+	const Column& At(int column) const		{ return columns[column % HeightfieldNS::MAX_COLUMNS]; }
+
+private:
+	Column columns[HeightfieldNS::MAX_COLUMNS];	// ring by world column
+	int end;
+	double originX;								// world x of column 0, far left of the origin on long runs
+	float tileSize;
+	float baseTop;
+};
+
+#endif // _HEIGHTFIELD_H_
@@ -0,0 +1,130 @@
+#include "HudLayer.h"
+
+HudLayer::HudLayer()
+	: graphics (NULL)
+	, root (NULL)
+	, surface (NULL)
+	, surfaceWidth (0)
+	, surfaceHeight (0)
+	, composeCount (0)
+	, initialized (false)
+{
+	ZeroMemory(&spriteData, sizeof(spriteData));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+HudLayer::~HudLayer()
+{
+	SafeRelease(surface);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool HudLayer::Initialize(Graphics *g, UINode *r, float x, float y)
+{
+	if (g == NULL || r == NULL)
+		return false;
+
+	graphics = g;
+	root = r;
+	spriteData.x = x;
+	spriteData.y = y;
+	spriteData.scale = 1.0f;
+
+	root->Layout(0.0f, 0.0f);
+	if (!CreateSurface())
+		return false;
+
+	initialized = true;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void HudLayer::Compose()
+{
+	if (!initialized || !root->IsDirty())
+		return;
+
+	root->Layout(0.0f, 0.0f);
+
+	// Grow the surface if the tree no longer fits
+	if ((UINT)(root->GetWidth() + 0.5f) > surfaceWidth || (UINT)(root->GetHeight() + 0.5f) > surfaceHeight)
+	{
+		SafeRelease(surface);
+		CreateSurface();
+	}
+	if (surface == NULL)
+		return; // stays dirty, Draw falls back to drawing the tree
+
+	if (FAILED(graphics->BeginRenderToTexture(surface)))
+		return;
+	root->Draw(graphics, 0.0f, 0.0f);
+	graphics->EndRenderToTexture();
+
+	root->ClearDirty();
+	composeCount++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void HudLayer::Draw()
+{
+	if (!initialized)
+		return;
+
+	// Draw the tree itself when there is no up to date surface, or while capturing since
+	// a capture can only refer to textures loaded from files
+	if (surface == NULL || root->IsDirty() || graphics->GetRecorder())
+	{
+		root->Draw(graphics, spriteData.x, spriteData.y);
+		return;
+	}
+
+	spriteData.texture = surface;
+	graphics->DrawSprite(spriteData);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void HudLayer::OnLostDevice()
+{
+	SafeRelease(surface);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void HudLayer::OnResetDevice()
+{
+	if (!initialized)
+		return;
+
+	// Contents of the new surface are undefined until composed again
+	CreateSurface();
+	root->Invalidate();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool HudLayer::CreateSurface()
+{
+	surfaceWidth = (UINT)(root->GetWidth() + 0.5f);
+	surfaceHeight = (UINT)(root->GetHeight() + 0.5f);
+	if (surfaceWidth == 0 || surfaceHeight == 0)
+		return false;
+
+	if (FAILED(graphics->CreateRenderTexture(surfaceWidth, surfaceHeight, surface)))
+	{
+		surface = NULL;
+		return false;
+	}
+
+	spriteData.width = surfaceWidth;
+	spriteData.height = surfaceHeight;
+	spriteData.rect.left = 0;
+	spriteData.rect.top = 0;
+	spriteData.rect.right = surfaceWidth;
+	spriteData.rect.bottom = surfaceHeight;
+	return true;
+}
@@ -0,0 +1,48 @@
+#ifndef _HUD_LAYER_H_
+#define _HUD_LAYER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include "Constants.h"
+#include "Graphics.h"
+#include "UINode.h"
+
+// Retained UI layer.
+// The UI tree is composed into a render target texture only when something in it changed,
+// every frame the texture is drawn as one sprite.
+class HudLayer
+{
+public:
+	HudLayer();
+	virtual ~HudLayer();
+
+	// Pre: root is laid out relative to screen position x, y and outlives the layer
+	bool Initialize(Graphics *g, UINode *root, float x, float y);
+
+	// Compose the tree into the texture if it is dirty.
+	// Call before SpriteBegin, drawing is redirected to the texture.
+	void Compose();
+
+	// Draw the composed layer. Call between SpriteBegin/SpriteEnd
+	void Draw();
+
+	// The render target lives in default pool, release it before a device reset
+	void OnLostDevice();
+	void OnResetDevice();
+
+	UINT GetComposeCount() const	{ return composeCount; }
+
+private:
+	bool CreateSurface();
+
+private:
+	Graphics *graphics;
+	UINode *root;
+	LP_TEXTURE surface;
+	SpriteData spriteData;
+	UINT surfaceWidth;
+	UINT surfaceHeight;
+	UINT composeCount;		// how many times the tree was composed
+	bool initialized;
+};
+
+#endif // _HUD_LAYER_H_
@@ -18,16 +18,15 @@ Image::Image()
 	spriteData.flipVertical = false;
 	cols = 1;
 	textureManager = NULL;
-	startFrame = 0;
-	endFrame = 0;
 	currentFrame = 0;
-	frameDelay = 1.0; // default to 1 second per frame of animation
-	animTimer = 0.0;
+	clip = NULL;
+	clock = NULL;
+	clipStart = 0.0;
+	clipFrame = 0;
 	visible = true;
-	loop = true;
-	animComplete = false;
 	graphics = NULL;
 	colorFilter = GraphicsNS::WHITE;
+	transform.valid = false;
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -96,10 +95,11 @@ void Image::Draw(COLOR_ARGB color)
 		return;
 	// get fresh texture incase onReset() was called
 	spriteData.texture = textureManager->GetTexture();
+	ResolveFrame();
 	if(color == GraphicsNS::FILTER)                     // if draw with filter
-		graphics->DrawSprite(spriteData, colorFilter);  // use colorFilter
+		graphics->DrawSprite(spriteData, colorFilter, &transform);  // use colorFilter
 	else
-		graphics->DrawSprite(spriteData, color);        // use color as filter
+		graphics->DrawSprite(spriteData, color, &transform);        // use color as filter
 }
 
 //=============================================================================
@@ -112,13 +112,14 @@ void Image::Draw(SpriteData sd, COLOR_ARGB color)
 {
 	if (!visible || graphics == NULL)
 		return;
+	ResolveFrame();
 	sd.rect = spriteData.rect;                  // use this Images rect to select texture
 	sd.texture = textureManager->GetTexture();  // get fresh texture incase onReset() was called
 
 	if(color == GraphicsNS::FILTER)             // if draw with filter
-		graphics->DrawSprite(sd, colorFilter);  // use colorFilter
+		graphics->DrawSprite(sd, colorFilter, &transform);  // use colorFilter
 	else
-		graphics->DrawSprite(sd, color);        // use color as filter
+		graphics->DrawSprite(sd, color, &transform);        // use color as filter
 }
 
 //=============================================================================
@@ -128,26 +129,24 @@ void Image::Draw(SpriteData sd, COLOR_ARGB color)
 //=============================================================================
 void Image::Update(float frameTime)
 {
-	if (endFrame - startFrame > 0)          // if animated sprite
+	// Animation is resolved when the image is drawn, see Play
+}
+
+//=============================================================================
+// Play an animation clip from its first frame
+//=============================================================================
+void Image::Play(const AnimationClip *c)
+{
+	clip = c;
+	if (clip == NULL || clip->GetFrameCount() == 0)
 	{
-		animTimer += frameTime;             // total elapsed time
-		if (animTimer > frameDelay)
-		{
-			animTimer -= frameDelay;
-			currentFrame++;
-			if (currentFrame < startFrame || currentFrame > endFrame)
-			{
-				if(loop == true)            // if looping animation
-					currentFrame = startFrame;
-				else                        // not looping animation
-				{
-					currentFrame = endFrame;
-					animComplete = true;    // animation complete
-				}
-			}
-			SetRect();                      // set spriteData.rect
-		}
+		clip = NULL;
+		return;
 	}
+	clipStart = GetClockTime();
+	clipFrame = 0;
+	currentFrame = clip->GetFirstFrame();
+	spriteData.rect = clip->GetRect(0);
 }
 
 //=============================================================================
@@ -157,8 +156,8 @@ void Image::SetCurrentFrame(int c)
 {
 	if(c >= 0)
 	{
+		clip = NULL;
 		currentFrame = c;
-		animComplete = false;
 		SetRect();                          // set spriteData.rect
 	}
 }
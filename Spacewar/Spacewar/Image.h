@@ -2,6 +2,7 @@
 #define _IMAGE_H_
 #define WIN32_LEAN_AND_MEAN
 
+#include "AnimationClip.h"
 #include "Constants.h"
 #include "TextureManager.h"
 
@@ -24,12 +25,10 @@ public:
 	virtual float GetCenterY()					{ return spriteData.y + spriteData.height / 2 * spriteData.scale; }
 	virtual float GetDegrees()					{ return spriteData.angle * (180.0f / (float)PI); }
 	virtual float GetRadians()					{ return spriteData.angle; }
-	virtual float GetFrameDelay()				{ return frameDelay; }
-	virtual int GetStartFrame()					{ return startFrame; }
-	virtual int GetEndFrame()					{ return endFrame; }
-	virtual int GetCurrentFrame()				{ return currentFrame; }
-	virtual RECT GetSpriteDataRect()			{ return spriteData.rect; }
-	virtual bool GetAnimationComplete()			{ return animComplete; }
+	virtual int GetCurrentFrame()				{ ResolveFrame(); return currentFrame; }
+	virtual RECT GetSpriteDataRect()			{ ResolveFrame(); return spriteData.rect; }
+	virtual bool GetAnimationComplete()			{ return clip != NULL && clip->IsComplete(GetClipTime()); }
+	const AnimationClip* GetClip()				{ return clip; }
 	virtual COLOR_ARGB GetColorFilter()			{ return colorFilter; }
 
 	virtual void SetX(float newX)				{ spriteData.x = newX; }
@@ -38,16 +37,14 @@ public:
 	virtual void SetDegrees(float deg)			{ spriteData.angle = deg * ((float)PI/180.0f); }
 	virtual void SetRadians(float rad)			{ spriteData.angle = rad; }
 	virtual void SetVisible(bool v)				{ visible = v; }
-	virtual void SetFrameDelay(float d)			{ frameDelay = d; }
-	virtual void SetFrames(int s, int e)		{ startFrame = s; endFrame = e; }
 
+	// Show frame c and stop the clip playing, if any
 	virtual void SetCurrentFrame(int c);
 	virtual void SetRect();
 	virtual void SetSpriteDataRect(RECT r)						{ spriteData.rect = r; }
-	virtual void SetLoop(bool lp)								{ loop = lp; }
-	virtual void SetAnimationComplete(bool a)					{ animComplete = a; }
 	virtual void SetColorFilter(COLOR_ARGB color)				{ colorFilter = color; }
 	virtual void SetTextureManager(TextureManager *textureM)	{ textureManager = textureM; }
+	void SetClock(const AnimationClock *c)						{ clock = c; }
 
 #pragma endregion
 
@@ -55,26 +52,45 @@ public:
 	virtual void Draw(COLOR_ARGB color = GraphicsNS::WHITE);
 	virtual void Draw(SpriteData sd, COLOR_ARGB color = GraphicsNS::WHITE);
 	virtual void Update(float frameTime);
+	// Play clip from its first frame. The frame is worked out from the clock when the image is drawn,
+	// nothing is done per tick. The clip must outlive its use.
+	virtual void Play(const AnimationClip *c);
 	virtual void FlipHorizontal(bool flip)		{ spriteData.flipHorizontal = flip; }
 	virtual void FlipVertical(bool flip)		{ spriteData.flipVertical = flip; }
 
+protected:
+	// Bring spriteData.rect up to date with the clip playing
+	void ResolveFrame()
+	{
+		if (clip == NULL)
+			return;
+		int frame = clip->GetFrameAt(GetClipTime());
+		if (frame != clipFrame)
+		{
+			clipFrame = frame;
+			currentFrame = clip->GetFirstFrame() + frame;
+			spriteData.rect = clip->GetRect(frame);
+		}
+	}
+	float GetClipTime() const	{ return clock ? (float)(clock->GetTime() - clipStart) : 0.0f; }
+	double GetClockTime() const	{ return clock ? clock->GetTime() : 0.0; }
+
 protected:
 	Graphics *graphics;
 	TextureManager *textureManager;
 
 	SpriteData spriteData;	// SpriteData is defined in "graphics.h"
+	SpriteTransform transform;	// matrix of the last draw, rebuilt by Graphics when spriteData moves
 	COLOR_ARGB colorFilter;	// applied as a color filter (use WHITE for no change)
 	int cols;				// number of cols (1 to n) in multi-frame sprite
-	int startFrame;			// first frame of current animation
-	int endFrame;			// end frame of current animation
-	int currentFrame;		// current frame of animation
-	float frameDelay;		// how long between frames of animation
-	float animTimer;		// animation timer
+	int currentFrame;		// frame of the texture shown
+	const AnimationClip *clip;		// animation playing, NULL for a still frame
+	const AnimationClock *clock;	// time the clip is played on
+	double clipStart;		// clock time the clip started
+	int clipFrame;			// frame of the clip spriteData.rect was last set to
 	HRESULT hr;				// standard return type
-	bool loop;				// true to loop frames
 	bool visible;			// true when visible
 	bool initialized;		// true when successfully initialized
-	bool animComplete;		// true when loop is false and endFrame has finished displaying
 };
 
 #endif // _IMAGE_H_
\ No newline at end of file
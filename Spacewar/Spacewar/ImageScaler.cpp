@@ -0,0 +1,95 @@
+#include "ImageScaler.h"
+
+UINT ImageScaler::ScaledSize(UINT size, float scale)
+{
+	UINT scaled = (UINT)(size * scale + 0.5f);
+	return scaled > 0 ? scaled : 1;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ImageScaler::Downscale(const DWORD *source, UINT pitch, UINT width, UINT height,
+	DWORD *dest, UINT destPitch, UINT destWidth, UINT destHeight)
+{
+	std::vector<Tap> columnTaps, rowTaps;
+	std::vector<UINT> firstColumn, firstRow;
+	BuildTaps(width, destWidth, columnTaps, firstColumn);
+	BuildTaps(height, destHeight, rowTaps, firstRow);
+
+	// Rows are blended first into alpha weighted sums, then the columns of that row
+	std::vector<float> row(width * 4);
+	for (UINT dy = 0; dy < destHeight; ++dy)
+	{
+		for (size_t i = 0; i < row.size(); ++i)
+			row[i] = 0.0f;
+		for (UINT t = firstRow[dy]; t < firstRow[dy + 1]; ++t)
+		{
+			const DWORD *line = source + rowTaps[t].source * pitch;
+			float weight = rowTaps[t].weight;
+			for (UINT x = 0; x < width; ++x)
+			{
+				DWORD pixel = line[x];
+				float alpha = (pixel >> 24) * weight;
+				row[x * 4] += alpha;
+				row[x * 4 + 1] += ((pixel >> 16) & 0xff) * alpha;
+				row[x * 4 + 2] += ((pixel >> 8) & 0xff) * alpha;
+				row[x * 4 + 3] += (pixel & 0xff) * alpha;
+			}
+		}
+
+		DWORD *out = dest + dy * destPitch;
+		for (UINT dx = 0; dx < destWidth; ++dx)
+		{
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (UINT t = firstColumn[dx]; t < firstColumn[dx + 1]; ++t)
+			{
+				const float *p = &row[columnTaps[t].source * 4];
+				float weight = columnTaps[t].weight;
+				sum[0] += p[0] * weight;
+				sum[1] += p[1] * weight;
+				sum[2] += p[2] * weight;
+				sum[3] += p[3] * weight;
+			}
+
+			// Fully transparent stays transparent black, as the color key leaves it
+			if (sum[0] <= 0.0f)
+			{
+				out[dx] = 0;
+				continue;
+			}
+			DWORD a = (DWORD)(sum[0] + 0.5f);
+			DWORD r = (DWORD)(sum[1] / sum[0] + 0.5f);
+			DWORD g = (DWORD)(sum[2] / sum[0] + 0.5f);
+			DWORD b = (DWORD)(sum[3] / sum[0] + 0.5f);
+			out[dx] = (a > 255 ? 255 : a) << 24 | (r > 255 ? 255 : r) << 16 | (g > 255 ? 255 : g) << 8 | (b > 255 ? 255 : b);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ImageScaler::BuildTaps(UINT size, UINT destSize, std::vector<Tap> &taps, std::vector<UINT> &first)
+{
+	// Destination pixel d covers source [d * step, (d + 1) * step)
+	float step = (float)size / destSize;
+	taps.clear();
+	first.resize(destSize + 1);
+	for (UINT d = 0; d < destSize; ++d)
+	{
+		first[d] = (UINT)taps.size();
+		float start = d * step;
+		float end = (d + 1) * step;
+		for (UINT s = (UINT)start; s < size && (float)s < end; ++s)
+		{
+			float left = (float)s > start ? (float)s : start;
+			float right = (float)(s + 1) < end ? (float)(s + 1) : end;
+			if (right <= left)
+				continue;
+			Tap tap;
+			tap.source = s;
+			tap.weight = (right - left) / step;
+			taps.push_back(tap);
+		}
+	}
+	first[destSize] = (UINT)taps.size();
+}
@@ -0,0 +1,32 @@
+#ifndef _IMAGE_SCALER_H_
+#define _IMAGE_SCALER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+
+#include "Constants.h"
+
+// Shrinks 32 bit ARGB images for the smaller variants of a texture.
+// Every destination pixel is the average of the source area it covers. Colors are
+// weighted by alpha so transparent pixels (keyed to black) do not darken the edges.
+class ImageScaler
+{
+public:
+	// Size of an image scaled by scale, at least 1 x 1
+	static UINT ScaledSize(UINT size, float scale);
+
+	// Pre: destWidth <= width, destHeight <= height, pitches in pixels
+	static void Downscale(const DWORD *source, UINT pitch, UINT width, UINT height,
+		DWORD *dest, UINT destPitch, UINT destWidth, UINT destHeight);
+
+private:
+	struct Tap
+	{
+		UINT source;	// source column or row
+		float weight;	// share of the destination pixel it covers
+	};
+	// Source columns or rows under each destination one, first = index of the first tap of each
+	static void BuildTaps(UINT size, UINT destSize, std::vector<Tap> &taps, std::vector<UINT> &first);
+};
+
+#endif // _IMAGE_SCALER_H_
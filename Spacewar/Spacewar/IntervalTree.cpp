@@ -0,0 +1,174 @@
+#include "IntervalTree.h"
+
+IntervalTree::IntervalTree()
+	: root (NULL)
+	, seed (0x2545F491)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+IntervalTree::~IntervalTree()
+{
+	Clear();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void IntervalTree::Clear()
+{
+	Delete(root);
+	root = NULL;
+	lefts.clear();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void IntervalTree::Insert(int id, double left, double right)
+{
+	Remove(id);
+
+	Node *node = new Node();
+	node->left = left;
+	node->right = right;
+	node->maxRight = right;
+	node->id = id;
+	node->priority = NextPriority();
+	node->less = NULL;
+	node->more = NULL;
+
+	Node *before, *after;
+	Split(root, left, id, before, after);
+	root = Join(Join(before, node), after);
+	lefts[id] = left;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool IntervalTree::Remove(int id)
+{
+	std::map<int, double>::iterator it = lefts.find(id);
+	if (it == lefts.end())
+		return false;
+
+	// Cut out the one node keyed left, id
+	Node *before, *rest, *node, *after;
+	Split(root, it->second, id, before, rest);
+	Split(rest, it->second, id + 1, node, after);
+	Delete(node);
+	root = Join(before, after);
+	lefts.erase(it);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool IntervalTree::FindOverlap(double left, double right, double &end) const
+{
+	return Search(root, left, right, end);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+double IntervalTree::FindFree(double left, double width) const
+{
+	// Step past each range in the way
+	double end;
+	while (FindOverlap(left, left + width, end))
+		left = end;
+	return left;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool IntervalTree::Search(const Node *node, double left, double right, double &end)
+{
+	// Subtrees ending before left are skipped, nothing starting at or after right can overlap
+	if (node == NULL || node->maxRight <= left)
+		return false;
+	if (Search(node->less, left, right, end))
+		return true;
+	if (node->left >= right)
+		return false;
+	if (node->right > left)
+	{
+		end = node->right;
+		return true;
+	}
+	return Search(node->more, left, right, end);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void IntervalTree::Refresh(Node *node)
+{
+	node->maxRight = node->right;
+	if (node->less != NULL && node->less->maxRight > node->maxRight)
+		node->maxRight = node->less->maxRight;
+	if (node->more != NULL && node->more->maxRight > node->maxRight)
+		node->maxRight = node->more->maxRight;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+IntervalTree::Node* IntervalTree::Join(Node *a, Node *b)
+{
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+	if (a->priority > b->priority)
+	{
+		a->more = Join(a->more, b);
+		Refresh(a);
+		return a;
+	}
+	b->less = Join(a, b->less);
+	Refresh(b);
+	return b;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void IntervalTree::Split(Node *node, double left, int id, Node *&before, Node *&after)
+{
+	if (node == NULL)
+	{
+		before = NULL;
+		after = NULL;
+		return;
+	}
+	if (Before(node->left, node->id, left, id))
+	{
+		Split(node->more, left, id, node->more, after);
+		before = node;
+	}
+	else
+	{
+		Split(node->less, left, id, before, node->less);
+		after = node;
+	}
+	Refresh(node);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void IntervalTree::Delete(Node *node)
+{
+	if (node == NULL)
+		return;
+	Delete(node->less);
+	Delete(node->more);
+	delete node;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINT IntervalTree::NextPriority()
+{
+	// xorshift, the tree only needs the priorities to look random
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
@@ -0,0 +1,58 @@
+#ifndef _INTERVAL_TREE_H_
+#define _INTERVAL_TREE_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <map>
+
+#include "Constants.h"
+
+// Half open ranges [left, right) with an id each, for finding free room along a line.
+// A treap ordered by left, every node keeps the furthest right end below it so a
+// search skips the subtrees that end before the range asked about. O(log n) expected.
+class IntervalTree
+{
+public:
+	IntervalTree();
+	virtual ~IntervalTree();
+
+	void Clear();
+
+	// Pre: right > left. An id inserted again replaces its old range
+	void Insert(int id, double left, double right);
+	bool Remove(int id);	// false if id is not in the tree
+
+	// Post: returns true if a range overlaps [left, right), end = its right end
+	bool FindOverlap(double left, double right, double &end) const;
+	// Lowest x from left on where [x, x + width) overlaps nothing
+	double FindFree(double left, double width) const;
+
+	UINT GetCount() const		{ return (UINT)lefts.size(); }
+
+private:
+	struct Node
+	{
+		double left;
+		double right;
+		double maxRight;	// of the subtree
+		int id;
+		UINT priority;		// heap order, random
+		Node *less;
+		Node *more;
+	};
+
+	// Order of the keys, left then id
+	static bool Before(double leftA, int idA, double leftB, int idB)	{ return leftA < leftB || (leftA == leftB && idA < idB); }
+	static bool Search(const Node *node, double left, double right, double &end);
+	static void Refresh(Node *node);
+	static Node* Join(Node *a, Node *b);	// every key of a before every key of b
+	static void Split(Node *node, double left, int id, Node *&before, Node *&after);	// after starts at left, id
+	static void Delete(Node *node);
+	UINT NextPriority();
+
+private:
+	Node *root;
+	std::map<int, double> lefts;	// left of each id, to find its node
+	UINT seed;
+};
+
+#endif // _INTERVAL_TREE_H_
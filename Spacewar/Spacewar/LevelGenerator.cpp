@@ -0,0 +1,96 @@
+#include "LevelGenerator.h"
+#include "TileMap.h"
+
+using namespace LevelGeneratorNS;
+
+LevelGenerator::LevelGenerator()
+{
+	ZeroMemory(&tiles, sizeof(tiles));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void LevelGenerator::Generate(UINT seed, int index, LevelChunk &chunk) const
+{
+	chunk.index = index;
+	chunk.end = 0.0;
+	for (int i = 0; i < CHUNK_COLUMNS; ++i)
+	{
+		chunk.tiles[i] = tiles.ground;
+		chunk.heights[i] = 0;
+		chunk.flags[i] = HeightfieldNS::SOLID;
+	}
+	if (index < SAFE_CHUNKS)
+		return;
+
+	UINT state = Hash(seed, index);
+	int widest = index < RAMP_CHUNKS ? 1 : 2;
+
+	// Features go between two flat columns at each end. A feature always has flat ground
+	// left of it and leaves at least two columns of ground right of it.
+	const int last = CHUNK_COLUMNS - 2;
+	int column = 2;
+	while (column < last)
+	{
+		// Half of the rolls are ground runs, the rest gaps, pits and raised platforms
+		UINT roll = Next(state) % 6;
+		int width = roll == 5 ? 2 + (int)(Next(state) % 3) : 1 + (int)(Next(state) % widest);
+		if (roll < 3 || column + width >= last)
+		{
+			// Ground run
+			column += 1 + (int)(Next(state) % 2);
+			continue;
+		}
+
+		if (roll == 5)
+		{
+			// Raised platform
+			BYTE height = (BYTE)(1 + Next(state) % MAX_HEIGHT);
+			for (int i = column; i < column + width; ++i)
+			{
+				chunk.tiles[i] = tiles.ground;
+				chunk.heights[i] = height;
+			}
+			chunk.tiles[column] = tiles.left;
+			chunk.tiles[column + width - 1] = tiles.right;
+			column += width + 2;
+		}
+		else
+		{
+			// Gap or hazard pit between the ends of two runs
+			bool gap = roll == 3;
+			chunk.tiles[column - 1] = tiles.right;
+			for (int i = column; i < column + width; ++i)
+			{
+				chunk.tiles[i] = gap ? TileMapNS::EMPTY : tiles.hazard;
+				chunk.flags[i] = gap ? 0 : HeightfieldNS::SOLID | HeightfieldNS::HAZARD;
+			}
+			chunk.tiles[column + width] = tiles.left;
+			column += width + 2;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINT LevelGenerator::Hash(UINT seed, int index)
+{
+	// Mixes the index in so neighbouring chunks get unrelated sequences
+	UINT h = seed ^ ((UINT)index * 0x9E3779B9u);
+	h ^= h >> 16;
+	h *= 0x85EBCA6Bu;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35u;
+	h ^= h >> 16;
+	return h != 0 ? h : 1;	// xorshift never leaves 0
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINT LevelGenerator::Next(UINT &state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
@@ -0,0 +1,57 @@
+#ifndef _LEVEL_GENERATOR_H_
+#define _LEVEL_GENERATOR_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include "Constants.h"
+#include "Heightfield.h"
+
+namespace LevelGeneratorNS
+{
+	const int CHUNK_COLUMNS = 16;
+	const int MAX_HEIGHT = 2;		// rows a raised platform stands above the ground
+	const int SAFE_CHUNKS = 1;		// flat chunks at the start of a run
+	const int RAMP_CHUNKS = 8;		// gaps and hazards get wider from this chunk on
+}
+
+// Tile ids of the TileMap the chunks are made for, see TileMap::AddTileType
+struct LevelTiles
+{
+	BYTE ground;
+	BYTE left;		// left end of a run, right of a gap or at the left of a raised platform
+	BYTE right;
+	BYTE hazard;
+};
+
+// A run of ground columns, ready to be queued into a TileMap
+struct LevelChunk
+{
+	int index;										// chunks since the start of the run
+	BYTE tiles[LevelGeneratorNS::CHUNK_COLUMNS];	// TileMapNS::EMPTY for a gap
+	BYTE heights[LevelGeneratorNS::CHUNK_COLUMNS];	// rows above the ground row
+	BYTE flags[LevelGeneratorNS::CHUNK_COLUMNS];	// HeightfieldNS attributes
+	double end;										// camera distance of the right edge, set when streamed in
+};
+
+// Builds the level one chunk at a time. A chunk only depends on the seed and its index,
+// so chunks can be made on any thread and in any order and a seed always gives the same level.
+// Every chunk starts and ends on flat ground so neighbouring chunks always join.
+class LevelGenerator
+{
+public:
+	LevelGenerator();
+
+	void SetTiles(const LevelTiles &t)	{ tiles = t; }
+	const LevelTiles& GetTiles() const	{ return tiles; }
+
+	// Ground runs with gaps, hazard pits and raised platforms in between
+	void Generate(UINT seed, int index, LevelChunk &chunk) const;
+
+private:
+	static UINT Hash(UINT seed, int index);
+	static UINT Next(UINT &state);		// xorshift
+
+private:
+	LevelTiles tiles;
+};
+
+#endif // _LEVEL_GENERATOR_H_
@@ -0,0 +1,74 @@
+#include "OpacityMap.h"
+
+OpacityMap::OpacityMap()
+	: width (0)
+	, height (0)
+	, cols (0)
+	, rows (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void OpacityMap::Build(const BYTE *bits, UINT pitch, UINT w, UINT h, bool hasAlpha)
+{
+	const UINT block = OpacityMapNS::BLOCK_SIZE;
+
+	width = w;
+	height = h;
+	cols = (width + block - 1) / block;
+	rows = (height + block - 1) / block;
+	transparentSum.assign((cols + 1) * (rows + 1), 0);
+	if (bits == NULL || cols == 0 || rows == 0)
+		return;
+
+	// A block is transparent if any of its texels is not fully opaque
+	std::vector<BYTE> transparent(cols * rows, 0);
+	if (hasAlpha)
+	{
+		for (UINT y = 0; y < height; ++y)
+		{
+			const DWORD *row = (const DWORD*)(bits + y * pitch);
+			BYTE *blockRow = &transparent[(y / block) * cols];
+			for (UINT x = 0; x < width; ++x)
+			{
+				if ((row[x] >> 24) != 0xff)
+					blockRow[x / block] = 1;
+			}
+		}
+	}
+
+	for (UINT r = 0; r < rows; ++r)
+	{
+		UINT rowSum = 0;
+		for (UINT c = 0; c < cols; ++c)
+		{
+			rowSum += transparent[r * cols + c];
+			transparentSum[(r + 1) * (cols + 1) + c + 1] = SumAt(c + 1, r) + rowSum;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool OpacityMap::IsOpaque(LONG left, LONG top, LONG right, LONG bottom) const
+{
+	if (left < 0 || top < 0 || right > (LONG)width || bottom > (LONG)height || left >= right || top >= bottom)
+		return false;
+
+	const UINT block = OpacityMapNS::BLOCK_SIZE;
+	UINT c0 = left / block;
+	UINT r0 = top / block;
+	UINT c1 = (right - 1) / block + 1;
+	UINT r1 = (bottom - 1) / block + 1;
+	return SumAt(c1, r1) - SumAt(c0, r1) - SumAt(c1, r0) + SumAt(c0, r0) == 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float OpacityMap::GetOpaqueFraction() const
+{
+	if (cols == 0 || rows == 0)
+		return 0.0f;
+	return 1.0f - (float)SumAt(cols, rows) / (cols * rows);
+}
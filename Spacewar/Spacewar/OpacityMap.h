@@ -0,0 +1,45 @@
+#ifndef _OPACITY_MAP_H_
+#define _OPACITY_MAP_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <Windows.h>
+#include <vector>
+
+namespace OpacityMapNS
+{
+	const UINT BLOCK_SIZE = 8;		// texels per block side
+}
+
+// Which parts of a texture are fully opaque, in blocks of BLOCK_SIZE x BLOCK_SIZE texels.
+// Built once per texture file from its pixels. A summed area table of the non opaque
+// blocks answers "is this texel rectangle opaque" with four lookups.
+class OpacityMap
+{
+public:
+	OpacityMap();
+
+	// Pre: bits = rows of 32 bit ARGB texels, pitch = bytes per row
+	//		hasAlpha = false if the format has no alpha, every texel is opaque
+	void Build(const BYTE *bits, UINT pitch, UINT width, UINT height, bool hasAlpha);
+
+	// True if every texel in [left, right) x [top, bottom) has alpha 255.
+	// Blocks are tested whole so the answer is conservative.
+	bool IsOpaque(LONG left, LONG top, LONG right, LONG bottom) const;
+
+	UINT GetWidth() const			{ return width; }
+	UINT GetHeight() const			{ return height; }
+	// Share of the blocks that are opaque, 0 to 1
+	float GetOpaqueFraction() const;
+
+private:
+	UINT SumAt(UINT col, UINT row) const	{ return transparentSum[row * (cols + 1) + col]; }
+
+private:
+	UINT width;
+	UINT height;
+	UINT cols;
+	UINT rows;
+	std::vector<UINT> transparentSum;	// (cols + 1) x (rows + 1), count of non opaque blocks above and left
+};
+
+#endif // _OPACITY_MAP_H_
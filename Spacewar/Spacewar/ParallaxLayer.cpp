@@ -0,0 +1,160 @@
+#include "ParallaxLayer.h"
+
+ParallaxLayer::ParallaxLayer()
+	: graphics (NULL)
+	, registry (NULL)
+	, textureCount (0)
+	, upcomingHead (0)
+	, tileCount (0)
+	, head (0)
+	, offset (0.0f)
+	, tileScale (1.0f)
+	, speed (0.0f)
+	, initialized (false)
+{
+	ZeroMemory(&spriteData, sizeof(spriteData));
+	ZeroMemory(ids, sizeof(ids));
+	ZeroMemory(upcoming, sizeof(upcoming));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ParallaxLayer::~ParallaxLayer()
+{
+	UnpinUpcoming();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool ParallaxLayer::Initialize(Graphics *g, TextureRegistry *r, const AssetId *idArray, int count, float s, float spd, float y)
+{
+	if (g == NULL || r == NULL || idArray == NULL || count <= 0 || count > ParallaxLayerNS::MAX_TEXTURES || s <= 0.0f)
+		return false;
+
+	UnpinUpcoming();
+	graphics = g;
+	registry = r;
+	textureCount = count;
+	speed = spd;
+
+	// Textures drawn smaller than the back buffer needs them are loaded smaller
+	for (int i = 0; i < count; ++i)
+		ids[i] = registry->InternVariant(idArray[i], s * graphics->GetOutputScale());
+	tileScale = s / registry->GetVariantScale(ids[0]);
+
+	// The tile width decides how many are needed to always cover the screen
+	tiles[0] = registry->Acquire(PickTexture());
+	if (!tiles[0].IsValid() || tiles[0].Get()->GetWidth() == 0)
+		return false;
+	tileCount = (int)(GAME_WIDTH / (tiles[0].Get()->GetWidth() * tileScale)) + 2;
+	if (tileCount > ParallaxLayerNS::MAX_TILES)
+		return false;
+
+	// The other tiles and the lookahead are decoded together
+	AssetId picks[ParallaxLayerNS::MAX_TILES + ParallaxLayerNS::LOOKAHEAD];
+	int pickCount = 0;
+	for (int i = 1; i < tileCount; ++i)
+		picks[pickCount++] = PickTexture();
+	for (int i = 0; i < ParallaxLayerNS::LOOKAHEAD; ++i)
+	{
+		upcoming[i] = PickTexture();
+		registry->Pin(upcoming[i]);
+		picks[pickCount++] = upcoming[i];
+	}
+	registry->QueuePreloads(picks, pickCount);
+	registry->FinishPreloads();
+
+	for (int i = 1; i < tileCount; ++i)
+	{
+		tiles[i] = registry->Acquire(picks[i - 1]);
+		if (!tiles[i].IsValid())
+			return false;
+	}
+	upcomingHead = 0;
+	head = 0;
+	offset = 0.0f;
+
+	spriteData.y = y;
+	spriteData.scale = tileScale;
+	spriteData.angle = 0.0f;
+	spriteData.flipHorizontal = false;
+	spriteData.flipVertical = false;
+
+	initialized = true;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ParallaxLayer::Update(float frameTime, float timeScale)
+{
+	if (!initialized)
+		return;
+
+	offset += speed * frameTime * timeScale;
+
+	// Recycle tiles that scrolled out, the new texture was prefetched when it was picked
+	float width = GetTileWidth(head);
+	while (offset >= width)
+	{
+		offset -= width;
+		TextureHandle next = NextTexture();
+		if (next.IsValid())
+			tiles[head] = next;	// keeps the old texture if the file went missing
+		head = (head + 1) % tileCount;
+		width = GetTileWidth(head);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ParallaxLayer::Draw(COLOR_ARGB color)
+{
+	if (!initialized)
+		return;
+
+	float x = -offset;
+	for (int i = 0; i < tileCount && x < (float)GAME_WIDTH; ++i)
+	{
+		const TextureManager *texture = tiles[(head + i) % tileCount].Get();
+
+		spriteData.texture = texture->GetTexture();	// fresh texture in case of device reset
+		spriteData.width = texture->GetWidth();
+		spriteData.height = texture->GetHeight();
+		spriteData.rect.left = 0;
+		spriteData.rect.top = 0;
+		spriteData.rect.right = spriteData.width;
+		spriteData.rect.bottom = spriteData.height;
+		spriteData.x = x;
+		graphics->DrawSprite(spriteData, color);
+
+		x += spriteData.width * tileScale;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureHandle ParallaxLayer::NextTexture()
+{
+	AssetId next = upcoming[upcomingHead];
+	upcoming[upcomingHead] = PickTexture();
+	registry->Pin(upcoming[upcomingHead]);
+	registry->Prefetch(upcoming[upcomingHead]);
+	upcomingHead = (upcomingHead + 1) % ParallaxLayerNS::LOOKAHEAD;
+
+	// Loaded on the spot if the decode has not finished yet
+	TextureHandle handle = registry->Acquire(next);
+	registry->Unpin(next);
+	return handle;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ParallaxLayer::UnpinUpcoming()
+{
+	if (registry == NULL)
+		return;
+	for (int i = 0; i < ParallaxLayerNS::LOOKAHEAD; ++i)
+		registry->Unpin(upcoming[i]);
+	ZeroMemory(upcoming, sizeof(upcoming));
+}
@@ -0,0 +1,68 @@
+#ifndef _PARALLAX_LAYER_H_
+#define _PARALLAX_LAYER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include "Constants.h"
+#include "Graphics.h"
+#include "TextureRegistry.h"
+
+namespace ParallaxLayerNS
+{
+	const int MAX_TEXTURES = 16;	// textures a layer can pick its tiles from
+	const int MAX_TILES = 8;		// tiles in the ring
+	const int LOOKAHEAD = 2;		// tiles picked and prefetched before they enter the ring
+}
+
+// A horizontally scrolling layer made of a ring of full height tiles.
+// Scrolling only moves an offset; when the first tile leaves the screen it becomes the
+// last one and is given the next texture picked. Textures are picked LOOKAHEAD tiles early,
+// prefetched on the loader threads and pinned until their tile takes them, the ring only
+// holds the textures on screen.
+// Use several layers with different speeds for parallax.
+class ParallaxLayer
+{
+public:
+	ParallaxLayer();
+	~ParallaxLayer();
+
+	// Pre: ids = array of textureCount textures the tiles are picked from (random per tile),
+	//		all as wide as the first one picked
+	//		scale = tile scale, the tiles are loaded at the smallest variant that keeps them sharp
+	//		speed = scroll speed in pixels per second, y = top of the layer
+	// Post: returns false if the parameters are invalid or a texture cannot be loaded
+	bool Initialize(Graphics *g, TextureRegistry *registry, const AssetId *ids, int textureCount, float scale, float speed, float y);
+
+	// Scroll left by speed * frameTime * timeScale
+	void Update(float frameTime, float timeScale);
+
+	// Draw the visible tiles. Call between SpriteBegin/SpriteEnd
+	void Draw(COLOR_ARGB color = GraphicsNS::WHITE);
+
+	float GetSpeed() const		{ return speed; }
+	void SetSpeed(float s)		{ speed = s; }
+	float GetOffset() const		{ return offset; }
+
+private:
+	float GetTileWidth(int tile) const { return tiles[tile].Get()->GetWidth() * tileScale; }
+	AssetId PickTexture() const	{ return ids[textureCount > 1 ? rand() % textureCount : 0]; }
+	TextureHandle NextTexture();	// the oldest pick, replaced by a new one that is prefetched
+	void UnpinUpcoming();
+
+private:
+	Graphics *graphics;
+	TextureRegistry *registry;
+	AssetId ids[ParallaxLayerNS::MAX_TEXTURES];
+	int textureCount;
+	TextureHandle tiles[ParallaxLayerNS::MAX_TILES];	// texture of each tile in the ring
+	AssetId upcoming[ParallaxLayerNS::LOOKAHEAD];		// picked for the next tiles and pinned, oldest at upcomingHead
+	int upcomingHead;
+	int tileCount;
+	int head;								// ring index of the leftmost tile
+	float offset;							// how far the leftmost tile has scrolled past the left edge
+	float tileScale;						// scale of the variants loaded
+	float speed;
+	SpriteData spriteData;					// reused for every tile
+	bool initialized;
+};
+
+#endif // _PARALLAX_LAYER_H_
@@ -17,13 +17,9 @@ bool Pickup::Initialize(Game *gamePtr, int width, int height, int ncols,
 {
 	if (Entity::Initialize(gamePtr, width, height, ncols, textureM))
 	{
-		spriteData.width = textureM->GetWidth();
-		spriteData.height = textureM->GetHeight();
-		spriteData.rect.bottom = textureM->GetHeight(); // rectangle to select parts of an image
-		spriteData.rect.right = textureM->GetWidth();
+		SetTexture(textureM);
 		velocity.x = 0;
 		velocity.y = 0;
-		radius = textureM->GetWidth()/2.0f;
 		collisionType = EntityNS::CIRCLE;
 		active = false;
 		visible = false;
@@ -32,6 +28,22 @@ bool Pickup::Initialize(Game *gamePtr, int width, int height, int ncols,
 	return false;
 }
 
+//=============================================================================
+// Show another texture, the pickup takes its size
+//=============================================================================
+void Pickup::SetTexture(TextureManager *textureM)
+{
+	textureManager = textureM;
+	spriteData.texture = textureM->GetTexture();
+	spriteData.width = textureM->GetWidth();
+	spriteData.height = textureM->GetHeight();
+	spriteData.rect.left = 0;
+	spriteData.rect.top = 0;
+	spriteData.rect.bottom = textureM->GetHeight(); // rectangle to select parts of an image
+	spriteData.rect.right = textureM->GetWidth();
+	radius = textureM->GetWidth()/2.0f;
+}
+
 //=============================================================================
 // draw the Pickup
 //=============================================================================
@@ -50,18 +62,14 @@ void Pickup::Update(float frameTime)
 	if (!active)
 		return;
 
+	// Pickups stay where they were placed, the camera scrolls past them.
+	// Leaving the screen is scheduled by the game.
 	Entity::Update(frameTime);
-	spriteData.x += PickupNS::SPEED * frameTime * velocity.x; // move Pickup along X 
-
-	if (spriteData.x + spriteData.width < 0) // if hit left screen edge
-	{
-		Reset();
-	}
 }
 
 void Pickup::Reset()
 {
 	active = false;
 	visible = false;
-	spriteData.x = GAME_WIDTH; // position at right screen edge
+	spriteData.x = camera->GetRight(); // position at right screen edge
 }
\ No newline at end of file
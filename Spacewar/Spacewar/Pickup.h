@@ -19,6 +19,7 @@ public:
 	virtual bool Initialize(Game *gamePtr, int width, int height, int ncols, TextureManager *textureM);
 	void Update(float frameTime);
 	void Reset();
+	void SetTexture(TextureManager *textureM);	// coin or gem, no reload
 	void SetGem(bool b)		{ isGem = b; }
 	bool IsGem() const		{ return isGem; }
 
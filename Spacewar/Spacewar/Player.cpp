@@ -14,10 +14,8 @@ Player::Player() : Entity()
 	spriteData.rect.right = PlayerNS::WIDTH;
 	velocity.x = 0;
 	velocity.y = 0;
-	frameDelay = PlayerNS::WALK_ANIMATION_DELAY;
-	startFrame = PlayerNS::WALK_START_FRAME;
-	endFrame = PlayerNS::WALK_END_FRAME;
-	currentFrame = startFrame;
+	currentFrame = PlayerNS::WALK_START_FRAME;
+	walkClip = NULL;
 
 	// Collision
 	collisionType = EntityNS::ROTATED_BOX;
@@ -35,6 +33,7 @@ Player::Player() : Entity()
 	jumpTimer = 0.0f;
 	blinkTimer = 0.0f;
 	invulTimer = 0.0f;
+	lastFootY = 0.0f;
 }
 
 //=============================================================================
@@ -62,17 +61,17 @@ void Player::Draw()
 //=============================================================================
 void Player::Update(float frameTime)
 {
+	lastFootY = GetFootY();	// ground collisions tell landing on a top from running into its side
 	CollideWithWall();
-	spriteData.x += PlayerNS::WALK_SPEED * frameTime * velocity.x;
+	// Carried along with the camera, walking is relative to the screen
+	spriteData.x += camera->GetSpeed() * frameTime + PlayerNS::WALK_SPEED * frameTime * velocity.x;
 
 	if (!isGrounded)
 		spriteData.y += PlayerNS::GRAVITY * frameTime;
 	else if (!isWalking && !isDucking)
 	{
 		isWalking = true;
-		startFrame = PlayerNS::WALK_START_FRAME;
-		endFrame = PlayerNS::WALK_END_FRAME;
-		currentFrame = startFrame;
+		Play(walkClip);
 	}
 	if (isJumping)
 	{
@@ -101,9 +100,7 @@ void Player::Update(float frameTime)
 			SetVisible(true);
 			blinkTimer = 0.0f;
 			isBlinking = false;
-			startFrame = PlayerNS::WALK_START_FRAME;
-			endFrame = PlayerNS::WALK_END_FRAME;
-			currentFrame = startFrame;
+			Play(walkClip);
 		}
 		else if (isBlinking)
 		{
@@ -122,8 +119,6 @@ void Player::Jump()
 		isJumping = true;
 		isWalking = false;
 		SetCurrentFrame(PlayerNS::JUMP_FRAME);
-		startFrame = currentFrame;
-		endFrame = currentFrame;
 	}
 }
 
@@ -134,8 +129,6 @@ void Player::Duck(bool b)
 		isDucking = true;
 		edge.top = -PlayerNS::WIDTH/2 + 8;
 		SetCurrentFrame(PlayerNS::DUCK_FRAME);
-		startFrame = currentFrame;
-		endFrame = currentFrame;
 		isWalking = false;
 	}
 	else if (isGrounded && !b)
@@ -145,9 +138,7 @@ void Player::Duck(bool b)
 		{
 			isWalking = true;
 			edge.top = -PlayerNS::HEIGHT/2 + 8;
-			startFrame = PlayerNS::WALK_START_FRAME;
-			endFrame = PlayerNS::WALK_END_FRAME;
-			currentFrame = startFrame;
+			Play(walkClip);
 		}
 	}
 
@@ -158,27 +149,22 @@ void Player::TakeDamage()
 	tookDamage = true;
 	isBlinking = true;
 	SetCurrentFrame(PlayerNS::HIT_FRAME);
-	startFrame = currentFrame;
-	endFrame = currentFrame;
 }
 
 void Player::CollideWithWall()
 {
-	if (spriteData.x > GAME_WIDTH - PlayerNS::WIDTH)	// if hit right screen edge
+	if (spriteData.x > camera->GetRight() - PlayerNS::WIDTH)	// if hit right screen edge
 	{
-		spriteData.x = GAME_WIDTH - PlayerNS::WIDTH;	// position at right screen edge
+		spriteData.x = camera->GetRight() - PlayerNS::WIDTH;	// position at right screen edge
 	} 
-	else if (spriteData.x < 0)							// else if hit left screen edge
+	else if (spriteData.x < camera->GetX())						// else if hit left screen edge
 	{
-		spriteData.x = 0;								// position at left screen edge
+		spriteData.x = camera->GetX();							// position at left screen edge
 	}
 }
 
-void Player::ResolveCollision(Entity& ent)
+void Player::SnapToGround(float groundY)
 {
-	if (GetCenterY() + edge.bottom*GetScale() > ent.GetCenterY() + ent.GetEdge().top*ent.GetScale())
-	{
-		float diff = (GetCenterY() + edge.bottom*GetScale()) - (ent.GetCenterY() + ent.GetEdge().top * ent.GetScale());
-		spriteData.y -= diff;
-	}
+	// Move the player so the feet rest on the ground
+	spriteData.y -= GetFootY() - groundY;
 }
\ No newline at end of file
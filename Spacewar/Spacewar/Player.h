@@ -40,11 +40,20 @@ public:
 	void Jump();
 	void Duck(bool b);
 	void TakeDamage();
-	void ResolveCollision(Entity& ent);
+	void SnapToGround(float groundY);
+	// Clip played whenever the player walks, shared with the game
+	void SetWalkClip(const AnimationClip *clip)	{ walkClip = clip; }
+
+	// Feet position, used for ground queries
+	float GetFootY()				{ return GetCenterY() + edge.bottom*GetScale(); }
+	float GetLastFootY() const		{ return lastFootY; }	// at the start of the last Update
+	float GetFootLeft()				{ return GetCenterX() + edge.left*GetScale(); }
+	float GetFootRight()			{ return GetCenterX() + edge.right*GetScale(); }
 
 private:
 	void CollideWithWall();
 private:
+	const AnimationClip *walkClip;
 	bool isGrounded;
 	bool isWalking;
 	bool isJumping;
@@ -54,5 +63,6 @@ private:
 	float jumpTimer;
 	float blinkTimer;
 	float invulTimer;
+	float lastFootY;
 };
 #endif // _PLAYER_H_
\ No newline at end of file
@@ -0,0 +1,587 @@
+#include <emmintrin.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PngDecoder.h"
+
+namespace
+{
+	const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+	// PNG color types
+	const uint8_t GRAY = 0;
+	const uint8_t RGB = 2;
+	const uint8_t PALETTE = 3;
+	const uint8_t GRAY_ALPHA = 4;
+	const uint8_t RGBA = 6;
+
+	// Filter types, the first byte of each row
+	const uint8_t FILTER_NONE = 0;
+	const uint8_t FILTER_SUB = 1;
+	const uint8_t FILTER_UP = 2;
+	const uint8_t FILTER_AVERAGE = 3;
+	const uint8_t FILTER_PAETH = 4;
+
+	// Deflate length and distance codes
+	const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	const uint8_t CODE_LENGTH_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	uint32_t ReadBigEndian(const uint8_t *p)
+	{
+		return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+	}
+
+	// Pixels of 3 or 4 bytes in the low lanes of a register
+	__m128i LoadPixel(const uint8_t *p, uint32_t bpp)
+	{
+		uint32_t v = 0;
+		memcpy(&v, p, bpp);
+		return _mm_cvtsi32_si128((int)v);
+	}
+
+	void StorePixel(uint8_t *p, __m128i v, uint32_t bpp)
+	{
+		uint32_t u = (uint32_t)_mm_cvtsi128_si32(v);
+		memcpy(p, &u, bpp);
+	}
+}
+
+// Deflate streams are read from the lowest bit of each byte up
+struct PngDecoder::BitReader
+{
+	const uint8_t *next;
+	const uint8_t *end;
+	uint64_t bits;
+	uint32_t count;
+	uint32_t padding;	// zero bytes added past the end, reading into them means the stream is cut short
+
+	void Refill()
+	{
+		while (count <= 56)
+		{
+			if (next < end)
+				bits |= (uint64_t)*next++ << count;
+			else
+				padding++;
+			count += 8;
+		}
+	}
+	uint32_t Get(uint32_t n)
+	{
+		if (count < n)
+			Refill();
+		uint32_t v = (uint32_t)(bits & ((1ULL << n) - 1));
+		bits >>= n;
+		count -= n;
+		return v;
+	}
+	bool Overrun() const	{ return padding * 8 > count; }
+};
+
+//----------------------------------------------------------------------------------------------------
+
+PngDecoder::PngDecoder()
+	: colorType (0)
+	, channels (0)
+	, hasKey (false)
+{
+	memset(palette, 0, sizeof(palette));
+	memset(keyColor, 0, sizeof(keyColor));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool PngDecoder::ReadHeader(const uint8_t *data, uint32_t size, uint32_t &width, uint32_t &height)
+{
+	// Signature, then IHDR: length, type, width, height, depth, color type, compression, filter, interlace
+	if (data == NULL || size < 33 || memcmp(data, SIGNATURE, sizeof(SIGNATURE)) != 0
+		|| ReadBigEndian(data + 8) != 13 || memcmp(data + 12, "IHDR", 4) != 0)
+		return false;
+	width = ReadBigEndian(data + 16);
+	height = ReadBigEndian(data + 20);
+	uint8_t depth = data[24];
+	uint8_t type = data[25];
+	bool handled = type == GRAY || type == RGB || type == PALETTE || type == GRAY_ALPHA || type == RGBA;
+	return handled && depth == 8 && data[26] == 0 && data[27] == 0 && data[28] == 0
+		&& width > 0 && height > 0 && width <= PngDecoderNS::MAX_SIZE && height <= PngDecoderNS::MAX_SIZE;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool PngDecoder::Decode(const uint8_t *data, uint32_t size, uint32_t transcolor, uint32_t *dest, uint32_t pitch)
+{
+	uint32_t width, height;
+	if (dest == NULL || !ReadHeader(data, size, width, height))
+		return false;
+	colorType = data[25];
+	channels = colorType == RGBA ? 4 : colorType == RGB ? 3 : colorType == GRAY_ALPHA ? 2 : 1;
+	hasKey = false;
+	for (int i = 0; i < 256; ++i)
+		palette[i] = 0xff000000;
+
+	// Walk the chunks, a single IDAT is inflated where it lies
+	const uint8_t *idat = NULL;
+	uint32_t idatSize = 0;
+	uint32_t idatCount = 0;
+	compressed.clear();
+	uint32_t offset = 8;
+	bool ended = false;
+	while (!ended && offset + 12 <= size)
+	{
+		uint32_t length = ReadBigEndian(data + offset);
+		const uint8_t *type = data + offset + 4;
+		const uint8_t *body = data + offset + 8;
+		if (length > size - offset - 12)
+			return false;
+
+		if (memcmp(type, "IDAT", 4) == 0)
+		{
+			if (idatCount == 1)
+				compressed.assign(idat, idat + idatSize);
+			if (idatCount >= 1)
+				compressed.insert(compressed.end(), body, body + length);
+			idat = body;
+			idatSize = length;
+			idatCount++;
+		}
+		else if (memcmp(type, "PLTE", 4) == 0)
+		{
+			for (uint32_t i = 0; i < length / 3 && i < 256; ++i)
+				palette[i] = 0xff000000 | (uint32_t)body[i * 3] << 16 | (uint32_t)body[i * 3 + 1] << 8 | body[i * 3 + 2];
+		}
+		else if (memcmp(type, "tRNS", 4) == 0)
+		{
+			if (colorType == PALETTE)
+			{
+				for (uint32_t i = 0; i < length && i < 256; ++i)
+					palette[i] = (palette[i] & 0x00ffffff) | (uint32_t)body[i] << 24;
+			}
+			else if ((colorType == GRAY && length >= 2) || (colorType == RGB && length >= 6))
+			{
+				// 16 bit samples, an 8 bit image only uses the low byte
+				hasKey = true;
+				for (uint32_t i = 0; i < length / 2 && i < 3; ++i)
+					keyColor[i] = (uint16_t)(body[i * 2] << 8 | body[i * 2 + 1]);
+			}
+		}
+		else if (memcmp(type, "IEND", 4) == 0)
+			ended = true;
+		offset += length + 12;	// and the CRC, which is not checked
+	}
+	if (idatCount == 0)
+		return false;
+	if (idatCount > 1)
+	{
+		idat = &compressed[0];
+		idatSize = (uint32_t)compressed.size();
+	}
+
+	uint32_t rowBytes = width * channels;
+	scanlines.resize((size_t)(rowBytes + 1) * height);
+	if (!Inflate(idat, idatSize, &scanlines[0], (uint32_t)scanlines.size()))
+		return false;
+
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		if (scanlines[(size_t)y * (rowBytes + 1)] > FILTER_PAETH)
+			return false;
+	}
+	Unfilter(width, height);
+	Convert(width, height, transcolor, dest, pitch);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool PngDecoder::Huffman::Build(const uint8_t *lengths, uint32_t count)
+{
+	memset(counts, 0, sizeof(counts));
+	memset(fast, 0, sizeof(fast));
+	for (uint32_t i = 0; i < count; ++i)
+		counts[lengths[i]]++;
+	counts[0] = 0;
+
+	// Too many codes of some length cannot be decoded, too few is allowed (a single distance code)
+	int left = 1;
+	for (int len = 1; len < 16; ++len)
+	{
+		left = left * 2 - counts[len];
+		if (left < 0)
+			return false;
+	}
+
+	// Symbols ordered by length then value, the canonical code order
+	uint16_t offsets[16];
+	uint16_t next[16];
+	offsets[1] = 0;
+	for (int len = 1; len < 15; ++len)
+		offsets[len + 1] = offsets[len] + counts[len];
+	uint32_t code = 0;
+	for (int len = 1; len < 16; ++len)
+	{
+		next[len] = (uint16_t)code;
+		code = (code + counts[len]) << 1;
+	}
+
+	for (uint32_t symbol = 0; symbol < count; ++symbol)
+	{
+		uint32_t len = lengths[symbol];
+		if (len == 0)
+			continue;
+		symbols[offsets[len]++] = (uint16_t)symbol;
+
+		// Short codes fill every table slot that starts with their bits, read low bit first
+		uint32_t c = next[len]++;
+		if (len <= PngDecoderNS::FAST_BITS)
+		{
+			uint32_t reversed = 0;
+			for (uint32_t i = 0; i < len; ++i)
+				reversed |= ((c >> i) & 1) << (len - 1 - i);
+			for (uint32_t i = reversed; i < (1u << PngDecoderNS::FAST_BITS); i += 1u << len)
+				fast[i] = (uint16_t)(symbol << 4 | len);
+		}
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int PngDecoder::DecodeSymbol(BitReader &reader, const Huffman &huffman)
+{
+	if (reader.count < 16)
+		reader.Refill();
+	uint16_t entry = huffman.fast[reader.bits & ((1 << PngDecoderNS::FAST_BITS) - 1)];
+	if (entry)
+	{
+		reader.bits >>= entry & 15;
+		reader.count -= entry & 15;
+		return entry >> 4;
+	}
+
+	// Longer codes one bit at a time
+	int code = 0;
+	int first = 0;
+	int index = 0;
+	for (int len = 1; len < 16; ++len)
+	{
+		code |= (int)reader.Get(1);
+		int count = huffman.counts[len];
+		if (code - count < first)
+			return huffman.symbols[index + (code - first)];
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	return -1;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool PngDecoder::Inflate(const uint8_t *source, uint32_t size, uint8_t *out, uint32_t outSize)
+{
+	// zlib header: deflate, no preset dictionary. The Adler-32 at the end is not checked.
+	if (size < 2 || (source[0] & 0x0f) != 8 || (source[0] * 256 + source[1]) % 31 != 0 || (source[1] & 0x20))
+		return false;
+
+	BitReader reader;
+	reader.next = source + 2;
+	reader.end = source + size;
+	reader.bits = 0;
+	reader.count = 0;
+	reader.padding = 0;
+
+	uint32_t written = 0;
+	uint32_t last = 0;
+	while (!last)
+	{
+		last = reader.Get(1);
+		uint32_t type = reader.Get(2);
+		if (type == 0)
+		{
+			// Stored, from the next byte boundary
+			reader.Get(reader.count % 8);
+			uint32_t length = reader.Get(16);
+			uint32_t inverse = reader.Get(16);
+			if ((length ^ 0xffff) != inverse || length > outSize - written)
+				return false;
+			for (uint32_t i = 0; i < length; ++i)
+				out[written++] = (uint8_t)reader.Get(8);
+		}
+		else if (type == 1)
+		{
+			uint8_t lengths[288 + 30];
+			memset(lengths, 8, 144);
+			memset(lengths + 144, 9, 112);
+			memset(lengths + 256, 7, 24);
+			memset(lengths + 280, 8, 8);
+			memset(lengths + 288, 5, 30);
+			literals.Build(lengths, 288);
+			distances.Build(lengths + 288, 30);
+			if (!InflateBlock(reader, literals, distances, out, outSize, written))
+				return false;
+		}
+		else if (type == 2)
+		{
+			uint32_t literalCount = reader.Get(5) + 257;
+			uint32_t distanceCount = reader.Get(5) + 1;
+			uint32_t codeCount = reader.Get(4) + 4;
+			if (literalCount > 286 || distanceCount > 30)
+				return false;
+
+			// Code lengths are themselves Huffman coded
+			uint8_t lengths[288 + 30];
+			memset(lengths, 0, 19);
+			for (uint32_t i = 0; i < codeCount; ++i)
+				lengths[CODE_LENGTH_ORDER[i]] = (uint8_t)reader.Get(3);
+			if (!literals.Build(lengths, 19))
+				return false;
+
+			uint32_t total = literalCount + distanceCount;
+			uint32_t n = 0;
+			while (n < total)
+			{
+				int symbol = DecodeSymbol(reader, literals);
+				if (symbol < 0)
+					return false;
+				if (symbol < 16)
+				{
+					lengths[n++] = (uint8_t)symbol;
+					continue;
+				}
+				uint8_t value = 0;
+				uint32_t repeat;
+				if (symbol == 16)
+				{
+					if (n == 0)
+						return false;
+					value = lengths[n - 1];
+					repeat = 3 + reader.Get(2);
+				}
+				else if (symbol == 17)
+					repeat = 3 + reader.Get(3);
+				else
+					repeat = 11 + reader.Get(7);
+				if (n + repeat > total)
+					return false;
+				memset(lengths + n, value, repeat);
+				n += repeat;
+			}
+			if (lengths[256] == 0 || !literals.Build(lengths, literalCount) || !distances.Build(lengths + literalCount, distanceCount))
+				return false;
+			if (!InflateBlock(reader, literals, distances, out, outSize, written))
+				return false;
+		}
+		else
+			return false;
+
+		if (reader.Overrun())
+			return false;
+	}
+	return written == outSize;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool PngDecoder::InflateBlock(BitReader &reader, const Huffman &lengths, const Huffman &distanceCodes, uint8_t *out, uint32_t outSize, uint32_t &written)
+{
+	for (;;)
+	{
+		int symbol = DecodeSymbol(reader, lengths);
+		if (symbol < 256)
+		{
+			if (symbol < 0 || written == outSize)
+				return false;
+			out[written++] = (uint8_t)symbol;
+			continue;
+		}
+		if (symbol == 256)
+			return true;
+
+		symbol -= 257;
+		if (symbol >= 29)
+			return false;
+		uint32_t length = LENGTH_BASE[symbol] + reader.Get(LENGTH_EXTRA[symbol]);
+		int code = DecodeSymbol(reader, distanceCodes);
+		if (code < 0 || code >= 30)
+			return false;
+		uint32_t distance = DISTANCE_BASE[code] + reader.Get(DISTANCE_EXTRA[code]);
+		if (distance > written || length > outSize - written || reader.Overrun())
+			return false;
+
+		// Copies may overlap what they write, one byte at a time then
+		uint8_t *to = out + written;
+		const uint8_t *from = to - distance;
+		if (distance >= length)
+			memcpy(to, from, length);
+		else
+		{
+			for (uint32_t i = 0; i < length; ++i)
+				to[i] = from[i];
+		}
+		written += length;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void PngDecoder::Unfilter(uint32_t width, uint32_t height)
+{
+	const uint32_t bpp = channels;
+	const uint32_t rowBytes = width * bpp;
+	const __m128i zero = _mm_setzero_si128();
+	zeros.assign(rowBytes, 0);
+
+	const uint8_t *prior = &zeros[0];
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		uint8_t *row = &scanlines[(size_t)y * (rowBytes + 1)];
+		uint8_t filter = row[0];
+		row++;
+
+		if (filter == FILTER_UP)
+		{
+			// No dependency along the row, 16 bytes at a time
+			uint32_t x = 0;
+			for (; x + 16 <= rowBytes; x += 16)
+			{
+				__m128i v = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(row + x)), _mm_loadu_si128((const __m128i*)(prior + x)));
+				_mm_storeu_si128((__m128i*)(row + x), v);
+			}
+			for (; x < rowBytes; ++x)
+				row[x] = (uint8_t)(row[x] + prior[x]);
+		}
+		else if (filter != FILTER_NONE && bpp >= 3)
+		{
+			// Each pixel depends on the one before, the channels of a pixel are done together
+			__m128i a = zero;		// left
+			__m128i c = zero;		// above left
+			for (uint32_t x = 0; x < rowBytes; x += bpp)
+			{
+				__m128i v = LoadPixel(row + x, bpp);
+				if (filter == FILTER_SUB)
+					v = _mm_add_epi8(v, a);
+				else if (filter == FILTER_AVERAGE)
+				{
+					// avg_epu8 rounds up, the filter rounds down
+					__m128i b = LoadPixel(prior + x, bpp);
+					__m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+					v = _mm_add_epi8(v, average);
+				}
+				else
+				{
+					// Paeth in 16 bit lanes: pa = |b - c|, pb = |a - c|, pc = |a + b - 2c|
+					__m128i b = LoadPixel(prior + x, bpp);
+					__m128i a16 = _mm_unpacklo_epi8(a, zero);
+					__m128i b16 = _mm_unpacklo_epi8(b, zero);
+					__m128i c16 = _mm_unpacklo_epi8(c, zero);
+					__m128i pa = _mm_sub_epi16(b16, c16);
+					__m128i pb = _mm_sub_epi16(a16, c16);
+					__m128i pc = _mm_add_epi16(pa, pb);
+					pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+					pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+					pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+					__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+					// a if pa is smallest, else b if pb is, else c
+					__m128i useA = _mm_cmpeq_epi16(smallest, pa);
+					__m128i useB = _mm_andnot_si128(useA, _mm_cmpeq_epi16(smallest, pb));
+					__m128i useC = _mm_andnot_si128(_mm_or_si128(useA, useB), _mm_set1_epi16(-1));
+					__m128i predictor = _mm_or_si128(_mm_or_si128(_mm_and_si128(useA, a16), _mm_and_si128(useB, b16)), _mm_and_si128(useC, c16));
+					v = _mm_add_epi8(v, _mm_packus_epi16(predictor, predictor));
+					c = b;
+				}
+				a = v;
+				StorePixel(row + x, v, bpp);
+			}
+		}
+		else if (filter != FILTER_NONE)
+		{
+			// Gray and palette rows, one or two bytes per pixel
+			for (uint32_t x = 0; x < rowBytes; ++x)
+			{
+				int left = x >= bpp ? row[x - bpp] : 0;
+				int above = prior[x];
+				int aboveLeft = x >= bpp ? prior[x - bpp] : 0;
+				int predictor = left;
+				if (filter == FILTER_UP)
+					predictor = above;
+				else if (filter == FILTER_AVERAGE)
+					predictor = (left + above) >> 1;
+				else if (filter == FILTER_PAETH)
+				{
+					int pa = abs(above - aboveLeft);
+					int pb = abs(left - aboveLeft);
+					int pc = abs(left + above - 2 * aboveLeft);
+					predictor = (pa <= pb && pa <= pc) ? left : (pb <= pc ? above : aboveLeft);
+				}
+				row[x] = (uint8_t)(row[x] + predictor);
+			}
+		}
+		prior = row;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void PngDecoder::Convert(uint32_t width, uint32_t height, uint32_t transcolor, uint32_t *dest, uint32_t pitch)
+{
+	const uint32_t rowBytes = width * channels;
+	const __m128i key = _mm_set1_epi32((int)transcolor);
+	const __m128i redBlue = _mm_set1_epi32(0x00ff00ff);
+	const __m128i keyed = _mm_set1_epi32(transcolor ? -1 : 0);
+
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		const uint8_t *row = &scanlines[(size_t)y * (rowBytes + 1) + 1];
+		uint32_t *out = dest + (size_t)y * pitch;
+		uint32_t x = 0;
+
+		if (colorType == RGBA)
+		{
+			// Bytes R G B A to B G R A, four pixels at a time
+			for (; x + 4 <= width; x += 4)
+			{
+				__m128i v = _mm_loadu_si128((const __m128i*)(row + x * 4));
+				__m128i rb = _mm_and_si128(v, redBlue);
+				rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+				v = _mm_or_si128(_mm_andnot_si128(redBlue, v), rb);
+				__m128i match = _mm_and_si128(_mm_cmpeq_epi32(v, key), keyed);
+				_mm_storeu_si128((__m128i*)(out + x), _mm_andnot_si128(match, v));
+			}
+		}
+
+		for (; x < width; ++x)
+		{
+			const uint8_t *p = row + x * channels;
+			uint32_t pixel;
+			switch (colorType)
+			{
+			case RGBA:
+				pixel = (uint32_t)p[3] << 24 | (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+				break;
+			case RGB:
+				pixel = 0xff000000 | (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+				if (hasKey && p[0] == keyColor[0] && p[1] == keyColor[1] && p[2] == keyColor[2])
+					pixel &= 0x00ffffff;
+				break;
+			case GRAY_ALPHA:
+				pixel = (uint32_t)p[1] << 24 | (uint32_t)p[0] << 16 | (uint32_t)p[0] << 8 | p[0];
+				break;
+			case PALETTE:
+				pixel = palette[p[0]];
+				break;
+			default:
+				pixel = 0xff000000 | (uint32_t)p[0] << 16 | (uint32_t)p[0] << 8 | p[0];
+				if (hasKey && p[0] == keyColor[0])
+					pixel &= 0x00ffffff;
+				break;
+			}
+			out[x] = (transcolor && pixel == transcolor) ? 0 : pixel;
+		}
+	}
+}
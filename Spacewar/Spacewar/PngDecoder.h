@@ -0,0 +1,61 @@
+#ifndef _PNG_DECODER_H_
+#define _PNG_DECODER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdint.h>
+#include <vector>
+
+namespace PngDecoderNS
+{
+	const uint32_t MAX_SIZE = 16384;	// widest or tallest image accepted
+	const uint32_t FAST_BITS = 10;		// Huffman codes up to this length are decoded with one lookup
+}
+
+// Decoder for the PNG files the game ships: 8 bit gray, gray and alpha, RGB, RGBA or palette, not interlaced.
+// Writes 32 bit ARGB pixels straight into the destination, such as a locked texture.
+// The unfilters and the RGBA conversion use SSE2. One decoder per thread, the buffers are reused.
+// Other PNG files are left to D3DX.
+class PngDecoder
+{
+public:
+	PngDecoder();
+
+	// Size of the image in data.
+	// Post: returns false if data is not a PNG this decoder handles
+	static bool ReadHeader(const uint8_t *data, uint32_t size, uint32_t &width, uint32_t &height);
+
+	// Decode into rows of pixels pitch pixels apart. Like D3DX, pixels equal to transcolor
+	// become transparent black, 0 = no color key.
+	// Post: returns false if data is damaged or not handled, dest may be partly written
+	bool Decode(const uint8_t *data, uint32_t size, uint32_t transcolor, uint32_t *dest, uint32_t pitch);
+
+private:
+	struct Huffman
+	{
+		uint16_t fast[1 << PngDecoderNS::FAST_BITS];	// symbol << 4 | length, 0 if the code is longer
+		uint16_t counts[16];							// codes of each length
+		uint16_t symbols[288];							// ordered by code
+		bool Build(const uint8_t *lengths, uint32_t count);
+	};
+	struct BitReader;
+
+	bool Inflate(const uint8_t *source, uint32_t size, uint8_t *out, uint32_t outSize);
+	bool InflateBlock(BitReader &reader, const Huffman &lengths, const Huffman &distances, uint8_t *out, uint32_t outSize, uint32_t &written);
+	static int DecodeSymbol(BitReader &reader, const Huffman &huffman);
+	void Unfilter(uint32_t width, uint32_t height);
+	void Convert(uint32_t width, uint32_t height, uint32_t transcolor, uint32_t *dest, uint32_t pitch);
+
+private:
+	std::vector<uint8_t> compressed;	// IDAT chunks joined, only when there is more than one
+	std::vector<uint8_t> scanlines;	// inflated rows, each behind its filter byte
+	std::vector<uint8_t> zeros;		// row above the first one
+	uint32_t palette[256];
+	uint8_t colorType;
+	uint32_t channels;
+	bool hasKey;					// tRNS color of gray or RGB images
+	uint16_t keyColor[3];
+	Huffman literals;
+	Huffman distances;
+};
+
+#endif // _PNG_DECODER_H_
@@ -0,0 +1,237 @@
+#include "RenderRecorder.h"
+#include "TextDX.h"
+
+RenderRecorder::RenderRecorder()
+	: graphics (NULL)
+	, file (NULL)
+	, nextTextureId (0)
+	, nextFontId (0)
+	, commandCount (0)
+	, frameCount (0)
+	, bytesWritten (0)
+	, inFrame (false)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+RenderRecorder::~RenderRecorder()
+{
+	Stop();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool RenderRecorder::Start(Graphics *g, const char *filename)
+{
+	Stop();
+
+	file = fopen(filename, "wb");
+	if (file == NULL)
+		return false;
+
+	graphics = g;
+	textureIds.clear();
+	fontIds.clear();
+	nextTextureId = 0;
+	nextFontId = 0;
+	frameCount = 0;
+	bytesWritten = 0;
+	buffer.clear();
+	buffer.reserve(16 * 1024);
+
+	RenderRecorderNS::Header header;
+	memcpy(header.magic, RenderRecorderNS::MAGIC, sizeof(header.magic));
+	header.version = RenderRecorderNS::VERSION;
+	header.reserved = 0;
+	header.width = GAME_WIDTH;
+	header.height = GAME_HEIGHT;
+	bytesWritten += fwrite(&header, 1, sizeof(header), file);
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderRecorder::Stop()
+{
+	if (file == NULL)
+		return;
+
+	// Close an unfinished frame so the stream stays well formed
+	if (inFrame)
+		EndFrame();
+
+	fclose(file);
+	file = NULL;
+	graphics = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderRecorder::BeginFrame()
+{
+	if (file == NULL)
+		return;
+
+	buffer.clear();
+	commandCount = 0;
+	inFrame = true;
+	Write((BYTE)RenderRecorderNS::FRAME_BEGIN);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderRecorder::EndFrame()
+{
+	if (file == NULL || !inFrame)
+		return;
+
+	Write((BYTE)RenderRecorderNS::FRAME_END);
+	Write((UINT32)commandCount);
+
+	// One write per frame keeps the capture overhead out of the draw calls
+	bytesWritten += fwrite(&buffer[0], 1, buffer.size(), file);
+	buffer.clear();
+	inFrame = false;
+	frameCount++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderRecorder::RecordSpriteBegin()
+{
+	if (!inFrame)
+		return;
+	Write((BYTE)RenderRecorderNS::SPRITE_BEGIN);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderRecorder::RecordSpriteEnd()
+{
+	if (!inFrame)
+		return;
+	Write((BYTE)RenderRecorderNS::SPRITE_END);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderRecorder::RecordSprite(const SpriteData &spriteData, COLOR_ARGB color)
+{
+	if (!inFrame)
+		return;
+
+	WORD id = GetTextureId(spriteData.texture);
+	if (id == RenderRecorderNS::INVALID_ID)
+		return;
+
+	BYTE flags = 0;
+	if (spriteData.flipHorizontal)
+		flags |= RenderRecorderNS::FLIP_HORIZONTAL;
+	if (spriteData.flipVertical)
+		flags |= RenderRecorderNS::FLIP_VERTICAL;
+
+	Write((BYTE)RenderRecorderNS::SPRITE);
+	Write(id);
+	Write((SHORT)spriteData.width);
+	Write((SHORT)spriteData.height);
+	Write((SHORT)spriteData.rect.left);
+	Write((SHORT)spriteData.rect.top);
+	Write((SHORT)spriteData.rect.right);
+	Write((SHORT)spriteData.rect.bottom);
+	Write(spriteData.x);
+	Write(spriteData.y);
+	Write(spriteData.scale);
+	Write(spriteData.angle);
+	Write(flags);
+	Write(color);
+	commandCount++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderRecorder::RecordText(TextDX *font, const std::string &str, int x, int y, float angle, COLOR_ARGB color)
+{
+	if (!inFrame)
+		return;
+
+	WORD id = GetFontId(font);
+	Write((BYTE)RenderRecorderNS::TEXT_AT);
+	Write(id);
+	Write((SHORT)x);
+	Write((SHORT)y);
+	Write(angle);
+	Write(color);
+	WriteString(str);
+	commandCount++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderRecorder::RecordText(TextDX *font, const std::string &str, const RECT &rect, UINT format, COLOR_ARGB color)
+{
+	if (!inFrame)
+		return;
+
+	WORD id = GetFontId(font);
+	Write((BYTE)RenderRecorderNS::TEXT_RECT);
+	Write(id);
+	Write((SHORT)rect.left);
+	Write((SHORT)rect.top);
+	Write((SHORT)rect.right);
+	Write((SHORT)rect.bottom);
+	Write((UINT32)format);
+	Write(color);
+	WriteString(str);
+	commandCount++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+WORD RenderRecorder::GetTextureId(LP_TEXTURE texture)
+{
+	std::map<LP_TEXTURE, WORD>::iterator it = textureIds.find(texture);
+	if (it != textureIds.end())
+		return it->second;
+
+	// Textures are replayed by reloading their file, so a texture we can't name can't be captured
+	const char *textureFile = graphics->GetTextureFile(texture);
+	if (textureFile == NULL)
+		return RenderRecorderNS::INVALID_ID;
+
+	WORD id = nextTextureId++;
+	textureIds[texture] = id;
+	Write((BYTE)RenderRecorderNS::DEFINE_TEXTURE);
+	Write(id);
+	WriteString(textureFile);
+	return id;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+WORD RenderRecorder::GetFontId(TextDX *font)
+{
+	std::map<TextDX*, WORD>::iterator it = fontIds.find(font);
+	if (it != fontIds.end())
+		return it->second;
+
+	WORD id = nextFontId++;
+	fontIds[font] = id;
+	Write((BYTE)RenderRecorderNS::DEFINE_FONT);
+	Write(id);
+	Write((INT32)font->getFontHeight());
+	Write((BYTE)font->getBold());
+	Write((BYTE)font->getItalic());
+	WriteString(font->getFontName());
+	return id;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderRecorder::WriteString(const std::string &str)
+{
+	WORD length = str.length() > 0xFFFF ? 0xFFFF : (WORD)str.length();
+	Write(length);
+	buffer.insert(buffer.end(), str.begin(), str.begin() + length);
+}
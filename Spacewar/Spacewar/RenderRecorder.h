@@ -0,0 +1,111 @@
+#ifndef _RENDER_RECORDER_H_
+#define _RENDER_RECORDER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+#include "Constants.h"
+#include "Graphics.h"
+
+class TextDX;
+
+// Binary render command stream
+// The stream starts with a Header followed by records. Every record begins with a one byte
+// opcode. Textures and fonts are defined once (first use) and referenced by id afterwards.
+namespace RenderRecorderNS
+{
+	const char MAGIC[4] = { 'M', 'R', 'R', 'C' };
+	const WORD VERSION = 1;
+	const char DEFAULT_FILE[] = "capture.mrc";
+
+	enum OPCODE
+	{
+		FRAME_BEGIN		= 0x01,		// no payload
+		FRAME_END		= 0x02,		// UINT32 number of draw commands in the frame
+		SPRITE_BEGIN	= 0x03,		// no payload
+		SPRITE_END		= 0x04,		// no payload
+		DEFINE_TEXTURE	= 0x10,		// WORD id, string file
+		DEFINE_FONT		= 0x11,		// WORD id, INT32 height, BYTE bold, BYTE italic, string name
+		SPRITE			= 0x20,		// SpriteRecord
+		TEXT_AT			= 0x21,		// WORD font, SHORT x, SHORT y, float angle, COLOR_ARGB color, string text
+		TEXT_RECT		= 0x22		// WORD font, SHORT left, top, right, bottom, UINT32 format, COLOR_ARGB color, string text
+	};
+
+	// Strings are stored as a WORD length followed by the characters (no terminator)
+
+	struct Header
+	{
+		char magic[4];
+		WORD version;
+		WORD reserved;
+		UINT32 width;			// GAME_WIDTH at capture time
+		UINT32 height;			// GAME_HEIGHT at capture time
+	};
+
+	// Sprite flags
+	const BYTE FLIP_HORIZONTAL = 0x01;
+	const BYTE FLIP_VERTICAL = 0x02;
+
+	const WORD INVALID_ID = 0xFFFF;
+}
+
+class RenderRecorder
+{
+public:
+	RenderRecorder();
+	virtual ~RenderRecorder();
+
+	// Open file and write the stream header. Returns false if the file could not be created.
+	bool Start(Graphics *g, const char *file);
+	// Flush and close the stream
+	void Stop();
+
+	// Commands are only captured between BeginFrame and EndFrame
+	void BeginFrame();
+	void EndFrame();
+
+	void RecordSpriteBegin();
+	void RecordSpriteEnd();
+	void RecordSprite(const SpriteData &spriteData, COLOR_ARGB color);
+	void RecordText(TextDX *font, const std::string &str, int x, int y, float angle, COLOR_ARGB color);
+	void RecordText(TextDX *font, const std::string &str, const RECT &rect, UINT format, COLOR_ARGB color);
+
+	// Texture pointers are recreated on device reset, forget them so they are defined again
+	void OnLostDevice()				{ textureIds.clear(); }
+	// texture was released, a new texture at the same address is defined again
+	void ForgetTexture(LP_TEXTURE texture)	{ textureIds.erase(texture); }
+
+	bool IsRecording() const		{ return file != NULL; }
+	UINT GetFrameCount() const		{ return frameCount; }
+	UINT GetBytesWritten() const	{ return bytesWritten; }
+
+private:
+	WORD GetTextureId(LP_TEXTURE texture);
+	WORD GetFontId(TextDX *font);
+
+	template <typename T>
+	void Write(const T &value)
+	{
+		const BYTE *p = reinterpret_cast<const BYTE*>(&value);
+		buffer.insert(buffer.end(), p, p + sizeof(T));
+	}
+	void WriteString(const std::string &str);
+
+private:
+	Graphics *graphics;
+	FILE *file;
+	std::vector<BYTE> buffer;				// commands of the current frame
+	std::map<LP_TEXTURE, WORD> textureIds;
+	std::map<TextDX*, WORD> fontIds;
+	WORD nextTextureId;
+	WORD nextFontId;
+	UINT commandCount;						// draw commands in the current frame
+	UINT frameCount;
+	UINT bytesWritten;
+	bool inFrame;
+};
+
+#endif // _RENDER_RECORDER_H_
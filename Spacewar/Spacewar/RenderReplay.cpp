@@ -0,0 +1,327 @@
+#include "RenderReplay.h"
+
+namespace
+{
+	// Size of the fixed part of each draw record (after the opcode)
+	const size_t SPRITE_SIZE = sizeof(WORD) + 6 * sizeof(SHORT) + 4 * sizeof(float) + sizeof(BYTE) + sizeof(COLOR_ARGB);
+	const size_t TEXT_AT_SIZE = sizeof(WORD) + 2 * sizeof(SHORT) + sizeof(float) + sizeof(COLOR_ARGB);
+	const size_t TEXT_RECT_SIZE = sizeof(WORD) + 4 * sizeof(SHORT) + sizeof(UINT32) + sizeof(COLOR_ARGB);
+}
+
+RenderReplay::RenderReplay()
+	: graphics (NULL)
+	, registry (NULL)
+	, cursor (0)
+	, firstFrame (0)
+	, frameCount (0)
+	, commandCount (0)
+	, playing (false)
+{
+	ZeroMemory(&spriteData, sizeof(spriteData));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+RenderReplay::~RenderReplay()
+{
+	Close();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool RenderReplay::Open(Graphics *g, TextureRegistry *r, const char *file)
+{
+	Close();
+	graphics = g;
+	registry = r;
+
+	FILE *fp = fopen(file, "rb");
+	if (fp == NULL)
+		return false;
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if (size > 0)
+	{
+		stream.resize(size);
+		if (fread(&stream[0], 1, size, fp) != (size_t)size)
+			stream.clear();
+	}
+	fclose(fp);
+
+	RenderRecorderNS::Header header;
+	cursor = 0;
+	if (!Read(header) || memcmp(header.magic, RenderRecorderNS::MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != RenderRecorderNS::VERSION)
+	{
+		Close();
+		return false;
+	}
+	firstFrame = cursor;
+
+	// Load everything up front so playback measures drawing only
+	if (!LoadResources())
+	{
+		Close();
+		return false;
+	}
+
+	cursor = firstFrame;
+	frameCount = 0;
+	commandCount = 0;
+	playing = true;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderReplay::Close()
+{
+	textures.clear();	// the registry releases the textures nothing else holds
+	for (size_t i = 0; i < fonts.size(); ++i)
+		SAFE_DELETE(fonts[i]);
+	fonts.clear();
+	stream.clear();
+	cursor = 0;
+	playing = false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool RenderReplay::PlayFrame()
+{
+	if (!playing)
+		return false;
+
+	BYTE opcode;
+	if (!Read(opcode) || opcode != RenderRecorderNS::FRAME_BEGIN)
+	{
+		playing = false;
+		return false;
+	}
+
+	while (Read(opcode))
+	{
+		switch (opcode)
+		{
+		case RenderRecorderNS::FRAME_END:
+			{
+				UINT32 count;
+				Read(count);
+				frameCount++;
+				return true;
+			}
+		case RenderRecorderNS::SPRITE_BEGIN:
+			graphics->SpriteBegin();
+			break;
+		case RenderRecorderNS::SPRITE_END:
+			graphics->SpriteEnd();
+			break;
+		case RenderRecorderNS::DEFINE_TEXTURE:
+		case RenderRecorderNS::DEFINE_FONT:
+			{
+				// Already loaded by LoadResources
+				WORD id;
+				Read(id);
+				if (opcode == RenderRecorderNS::DEFINE_FONT)
+					cursor += sizeof(INT32) + 2 * sizeof(BYTE);
+				SkipString();
+				break;
+			}
+		case RenderRecorderNS::SPRITE:
+			{
+				WORD id;
+				SHORT w, h, left, top, right, bottom;
+				BYTE flags;
+				COLOR_ARGB color;
+				Read(id);
+				Read(w); Read(h);
+				Read(left); Read(top); Read(right); Read(bottom);
+				Read(spriteData.x);
+				Read(spriteData.y);
+				Read(spriteData.scale);
+				Read(spriteData.angle);
+				Read(flags);
+				Read(color);
+				if (id >= textures.size() || !textures[id].IsValid())
+					break;
+				spriteData.width = w;
+				spriteData.height = h;
+				spriteData.rect.left = left;
+				spriteData.rect.top = top;
+				spriteData.rect.right = right;
+				spriteData.rect.bottom = bottom;
+				spriteData.flipHorizontal = (flags & RenderRecorderNS::FLIP_HORIZONTAL) != 0;
+				spriteData.flipVertical = (flags & RenderRecorderNS::FLIP_VERTICAL) != 0;
+				spriteData.texture = textures[id].Get()->GetTexture();
+				graphics->DrawSprite(spriteData, color);
+				commandCount++;
+				break;
+			}
+		case RenderRecorderNS::TEXT_AT:
+			{
+				WORD id;
+				SHORT x, y;
+				float angle;
+				COLOR_ARGB color;
+				std::string str;
+				Read(id); Read(x); Read(y); Read(angle); Read(color);
+				ReadString(str);
+				if (id >= fonts.size())
+					break;
+				fonts[id]->setRadians(angle);
+				fonts[id]->setFontColor(color);
+				fonts[id]->print(str, x, y);
+				commandCount++;
+				break;
+			}
+		case RenderRecorderNS::TEXT_RECT:
+			{
+				WORD id;
+				SHORT left, top, right, bottom;
+				UINT32 format;
+				COLOR_ARGB color;
+				std::string str;
+				Read(id); Read(left); Read(top); Read(right); Read(bottom); Read(format); Read(color);
+				ReadString(str);
+				if (id >= fonts.size())
+					break;
+				RECT rect = { left, top, right, bottom };
+				fonts[id]->setFontColor(color);
+				fonts[id]->print(str, rect, format);
+				commandCount++;
+				break;
+			}
+		default:
+			// Unknown record, the rest of the stream can't be trusted
+			playing = false;
+			return false;
+		}
+	}
+
+	playing = false;
+	return false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderReplay::OnLostDevice()
+{
+	// Textures are handled by the registry
+	for (size_t i = 0; i < fonts.size(); ++i)
+		fonts[i]->onLostDevice();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RenderReplay::OnResetDevice()
+{
+	for (size_t i = 0; i < fonts.size(); ++i)
+		fonts[i]->onResetDevice();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool RenderReplay::LoadResources()
+{
+	// Walk every record once, loading definitions and skipping draw commands
+	BYTE opcode;
+	while (Read(opcode))
+	{
+		switch (opcode)
+		{
+		case RenderRecorderNS::FRAME_BEGIN:
+		case RenderRecorderNS::SPRITE_BEGIN:
+		case RenderRecorderNS::SPRITE_END:
+			break;
+		case RenderRecorderNS::FRAME_END:
+			cursor += sizeof(UINT32);
+			break;
+		case RenderRecorderNS::DEFINE_TEXTURE:
+			if (!DefineTexture())
+				return false;
+			break;
+		case RenderRecorderNS::DEFINE_FONT:
+			if (!DefineFont())
+				return false;
+			break;
+		case RenderRecorderNS::SPRITE:
+			cursor += SPRITE_SIZE;
+			break;
+		case RenderRecorderNS::TEXT_AT:
+			cursor += TEXT_AT_SIZE;
+			if (!SkipString())
+				return false;
+			break;
+		case RenderRecorderNS::TEXT_RECT:
+			cursor += TEXT_RECT_SIZE;
+			if (!SkipString())
+				return false;
+			break;
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool RenderReplay::DefineTexture()
+{
+	WORD id;
+	std::string file;
+	if (!Read(id) || !ReadString(file))
+		return false;
+
+	if (id >= textures.size())
+		textures.resize(id + 1);
+
+	// A texture recreated after a device reset is defined again with the same file, the registry
+	// hands out the texture already loaded
+	textures[id] = registry->Acquire(file.c_str());
+	return textures[id].IsValid();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool RenderReplay::DefineFont()
+{
+	WORD id;
+	INT32 height;
+	BYTE bold, italic;
+	std::string name;
+	if (!Read(id) || !Read(height) || !Read(bold) || !Read(italic) || !ReadString(name))
+		return false;
+
+	if (id >= fonts.size())
+		fonts.resize(id + 1, NULL);
+	if (fonts[id] != NULL)
+		return true;
+
+	fonts[id] = new TextDX();
+	return fonts[id]->initialize(graphics, height, bold != 0, italic != 0, name);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool RenderReplay::SkipString()
+{
+	WORD length;
+	if (!Read(length) || cursor + length > stream.size())
+		return false;
+	cursor += length;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool RenderReplay::ReadString(std::string &str)
+{
+	WORD length;
+	if (!Read(length) || cursor + length > stream.size())
+		return false;
+	str.assign((const char*)&stream[cursor], length);
+	cursor += length;
+	return true;
+}
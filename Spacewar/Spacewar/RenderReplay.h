@@ -0,0 +1,70 @@
+#ifndef _RENDER_REPLAY_H_
+#define _RENDER_REPLAY_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <string>
+#include <vector>
+
+#include "Constants.h"
+#include "Graphics.h"
+#include "RenderRecorder.h"
+#include "TextDX.h"
+#include "TextureRegistry.h"
+
+// Plays back a stream written by RenderRecorder.
+// The whole stream is read into memory on Open so playback is not bound by file IO,
+// and every textures/font it references is loaded before the first frame.
+class RenderReplay
+{
+public:
+	RenderReplay();
+	virtual ~RenderReplay();
+
+	// Read the stream and load its resources. Textures come from registry, files the game
+	// already holds are not loaded again. Returns false if the file is missing or invalid.
+	bool Open(Graphics *g, TextureRegistry *registry, const char *file);
+	void Close();
+
+	// Submit the draw commands of the next frame to graphics.
+	// Call between BeginScene/EndScene. Returns false when the stream has ended.
+	bool PlayFrame();
+
+	void OnLostDevice();
+	void OnResetDevice();
+
+	bool IsPlaying() const			{ return playing; }
+	UINT GetFrameCount() const		{ return frameCount; }
+	UINT GetCommandCount() const	{ return commandCount; }
+
+private:
+	bool LoadResources();
+	bool DefineTexture();
+	bool DefineFont();
+	bool SkipString();
+	bool ReadString(std::string &str);
+
+	template <typename T>
+	bool Read(T &value)
+	{
+		if (cursor + sizeof(T) > stream.size())
+			return false;
+		memcpy(&value, &stream[cursor], sizeof(T));
+		cursor += sizeof(T);
+		return true;
+	}
+
+private:
+	Graphics *graphics;
+	TextureRegistry *registry;
+	std::vector<BYTE> stream;
+	size_t cursor;
+	size_t firstFrame;								// offset of the first record after the header
+	std::vector<TextureHandle> textures;			// indexed by recorded texture id
+	std::vector<TextDX*> fonts;						// indexed by recorded font id
+	SpriteData spriteData;
+	UINT frameCount;
+	UINT commandCount;
+	bool playing;
+};
+
+#endif // _RENDER_REPLAY_H_
@@ -0,0 +1,93 @@
+#include "ResidencyManager.h"
+
+ResidencyManager::ResidencyManager()
+	: budget (ResidencyManagerNS::DEFAULT_BUDGET)
+	, bytesResident (0)
+	, residentCount (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ResidencyManager::Add(unsigned int id, unsigned int bytes)
+{
+	Slot &slot = GetSlot(id);
+	if (slot.resident)
+		Remove(id);
+
+	slot.position = order.insert(order.end(), id);
+	slot.bytes = bytes;
+	slot.resident = true;
+	bytesResident += bytes;
+	residentCount++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ResidencyManager::Remove(unsigned int id)
+{
+	if (!IsResident(id))
+		return;
+
+	Slot &slot = slots[id];
+	if (!slot.inUse)
+		order.erase(slot.position);
+	bytesResident -= slot.bytes;
+	residentCount--;
+	slot.bytes = 0;
+	slot.resident = false;
+	slot.inUse = false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ResidencyManager::Touch(unsigned int id)
+{
+	if (!IsResident(id) || slots[id].inUse)
+		return;
+
+	// Move to the most recent end, the iterator stays valid
+	order.splice(order.end(), order, slots[id].position);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ResidencyManager::SetInUse(unsigned int id, bool inUse)
+{
+	if (!IsResident(id) || slots[id].inUse == inUse)
+		return;
+
+	// Only textures that may be evicted are kept in order
+	Slot &slot = slots[id];
+	slot.inUse = inUse;
+	if (inUse)
+		order.erase(slot.position);
+	else
+		slot.position = order.insert(order.end(), id);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool ResidencyManager::NextEviction(unsigned int &id) const
+{
+	if (bytesResident <= budget || order.empty())
+		return false;
+	id = order.front();
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+ResidencyManager::Slot& ResidencyManager::GetSlot(unsigned int id)
+{
+	if (id >= slots.size())
+	{
+		Slot empty;
+		empty.position = order.end();
+		empty.bytes = 0;
+		empty.resident = false;
+		empty.inUse = false;
+		slots.resize(id + 1, empty);
+	}
+	return slots[id];
+}
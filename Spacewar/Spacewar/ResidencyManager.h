@@ -0,0 +1,62 @@
+#ifndef _RESIDENCY_MANAGER_H_
+#define _RESIDENCY_MANAGER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <list>
+#include <vector>
+
+namespace ResidencyManagerNS
+{
+	const unsigned int DEFAULT_BUDGET = 48 * 1024 * 1024;	// bytes of texture memory
+}
+
+// Bookkeeping of the textures held in memory and the order they were last used in.
+// Textures in use cannot be evicted; the others are evicted least recently used first
+// while the resident bytes are over budget. Only ids and sizes are tracked, the owner
+// loads and frees the textures, so the policy works without a device. Kept free of
+// Windows headers so it builds and is tested anywhere, see Tests/ResidencyManagerTest.cpp.
+class ResidencyManager
+{
+public:
+	ResidencyManager();
+
+	void SetBudget(unsigned int bytes)		{ budget = bytes; }
+	unsigned int GetBudget() const			{ return budget; }
+	unsigned int GetBytesResident() const	{ return bytesResident; }
+	unsigned int GetResidentCount() const	{ return residentCount; }
+
+	// id was loaded and takes bytes, it counts as just used and not in use
+	void Add(unsigned int id, unsigned int bytes);
+	// id was freed
+	void Remove(unsigned int id);
+	// id is used now, it becomes the last to be evicted
+	void Touch(unsigned int id);
+	// A texture in use is never evicted, once no longer in use it counts as just used
+	void SetInUse(unsigned int id, bool inUse);
+
+	bool IsResident(unsigned int id) const		{ return id < slots.size() && slots[id].resident; }
+	bool IsInUse(unsigned int id) const			{ return id < slots.size() && slots[id].inUse; }
+
+	// Least recently used texture not in use, while over budget.
+	// Post: returns false when within budget or when every resident texture is in use
+	bool NextEviction(unsigned int &id) const;
+
+private:
+	struct Slot
+	{
+		std::list<unsigned int>::iterator position;	// in order, valid while resident and not in use
+		unsigned int bytes;
+		bool resident;
+		bool inUse;
+	};
+	Slot& GetSlot(unsigned int id);
+
+private:
+	std::list<unsigned int> order;	// ids that may be evicted, least recently used first
+	std::vector<Slot> slots;		// indexed by id
+	unsigned int budget;
+	unsigned int bytesResident;
+	unsigned int residentCount;
+};
+
+#endif // _RESIDENCY_MANAGER_H_
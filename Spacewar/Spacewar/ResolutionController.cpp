@@ -0,0 +1,103 @@
+#include <math.h>
+
+#include "ResolutionController.h"
+
+ResolutionController::ResolutionController()
+	: enabled (true)
+	, scale (ResolutionControllerNS::MAX_SCALE)
+	, minScale (ResolutionControllerNS::MIN_SCALE)
+	, maxScale (ResolutionControllerNS::MAX_SCALE)
+	, target (ResolutionControllerNS::TARGET_FRAME_TIME)
+	, average (0.0f)
+	, sampleSum (0.0f)
+	, sampleCount (0)
+	, cooldown (0)
+	, scaleDowns (0)
+	, scaleUps (0)
+	, framesAtScale (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ResolutionController::SetBounds(float minS, float maxS)
+{
+	maxScale = maxS > 0.0f && maxS < 1.0f ? maxS : 1.0f;
+	minScale = minS > 0.0f && minS < maxScale ? minS : maxScale;
+	SetScale(scale);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ResolutionController::SetEnabled(bool e)
+{
+	enabled = e;
+	if (!enabled)
+		SetScale(maxScale);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float ResolutionController::Update(float frameTime)
+{
+	framesAtScale++;
+	if (!enabled)
+		return scale;
+
+	// The frames right after a change still show the cost of the old scale
+	if (cooldown > 0)
+	{
+		cooldown--;
+		return scale;
+	}
+
+	sampleSum += frameTime;
+	if (++sampleCount < ResolutionControllerNS::SAMPLE_FRAMES)
+		return scale;
+
+	average = sampleSum / sampleCount;
+	sampleSum = 0.0f;
+	sampleCount = 0;
+
+	if (average > target * ResolutionControllerNS::TOLERANCE && scale > minScale)
+	{
+		// Cost follows the pixel count, the scale that fits the target is sqrt(target / average) of this one.
+		// Aim a little under the target so the next window does not land just over it again.
+		float fit = scale * sqrtf(target * ResolutionControllerNS::HEADROOM / average);
+		if (fit < scale - ResolutionControllerNS::MAX_STEP_DOWN)
+			fit = scale - ResolutionControllerNS::MAX_STEP_DOWN;
+		SetScale(fit);
+		scaleDowns++;
+	}
+	else if (average < target * ResolutionControllerNS::HEADROOM && scale < maxScale)
+	{
+		SetScale(scale + ResolutionControllerNS::STEP_UP);
+		scaleUps++;
+	}
+	return scale;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ResolutionController::Reset()
+{
+	SetScale(maxScale);
+	average = 0.0f;
+	scaleDowns = 0;
+	scaleUps = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ResolutionController::SetScale(float s)
+{
+	s = Clamp(s, minScale, maxScale);
+	if (s != scale)
+	{
+		scale = s;
+		framesAtScale = 0;
+		cooldown = ResolutionControllerNS::COOLDOWN_FRAMES;
+	}
+	sampleSum = 0.0f;
+	sampleCount = 0;
+}
@@ -0,0 +1,71 @@
+#ifndef _RESOLUTION_CONTROLLER_H_
+#define _RESOLUTION_CONTROLLER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include "Constants.h"
+
+namespace ResolutionControllerNS
+{
+	const float MIN_SCALE = 0.5f;					// smallest share of the output width and height rendered
+	const float MAX_SCALE = 1.0f;
+	const float TARGET_FRAME_TIME = 1.0f / 60.0f;	// seconds of work allowed per frame
+	const float TOLERANCE = 1.05f;					// scale down only when frames take more than this share of the target
+	const float HEADROOM = 0.75f;					// scale up only when frames take less than this share of the target
+	const float STEP_UP = 0.05f;					// scaling up is gradual, scaling down jumps to the estimated scale
+	const float MAX_STEP_DOWN = 0.25f;
+	const int SAMPLE_FRAMES = 15;					// frames averaged before a decision
+	const int COOLDOWN_FRAMES = 30;					// frames ignored after a change while the new scale settles
+}
+
+// Picks the internal render resolution from recent frame times.
+// Frames are averaged over SAMPLE_FRAMES; when the average is over the target the scale drops to
+// where the pixel count should fit the budget, when it is well under the target the scale creeps back up.
+// The scale applies to width and height, the pixels drawn go with its square.
+class ResolutionController
+{
+public:
+	ResolutionController();
+
+	// Scale is kept between minScale and maxScale, both in (0, 1]
+	void SetBounds(float minScale, float maxScale);
+	void SetTarget(float frameTime)		{ target = frameTime; }
+	// Disabled, the scale stays at the maximum
+	void SetEnabled(bool e);
+
+	// Feed the work time of the last frame in seconds. Returns the scale to render the next frame at.
+	float Update(float frameTime);
+
+	// Back to the maximum scale, counters cleared
+	void Reset();
+
+	bool GetEnabled() const			{ return enabled; }
+	float GetScale() const			{ return scale; }
+	float GetMinScale() const		{ return minScale; }
+	float GetMaxScale() const		{ return maxScale; }
+	float GetTarget() const			{ return target; }
+	// Average work time of the last completed sample window
+	float GetAverage() const		{ return average; }
+	UINT GetScaleDowns() const		{ return scaleDowns; }
+	UINT GetScaleUps() const		{ return scaleUps; }
+	// Frames rendered since the scale last changed
+	UINT GetFramesAtScale() const	{ return framesAtScale; }
+
+private:
+	void SetScale(float s);
+
+private:
+	bool enabled;
+	float scale;
+	float minScale;
+	float maxScale;
+	float target;
+	float average;
+	float sampleSum;
+	int sampleCount;
+	int cooldown;
+	UINT scaleDowns;
+	UINT scaleUps;
+	UINT framesAtScale;
+};
+
+#endif // _RESOLUTION_CONTROLLER_H_
@@ -0,0 +1,246 @@
+#include <math.h>
+#include <string.h>
+
+#include "RleSprite.h"
+
+RleSprite::RleSprite()
+	: width (0)
+	, height (0)
+	, skipped (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool RleSprite::Initialize(Graphics *g, const char *file, COLOR_ARGB transcolor)
+{
+	if (g == NULL || file == NULL)
+		return false;
+
+	// Load into system memory so it may be locked
+	UINT w, h;
+	LP_TEXTURE textureData = NULL;
+	if (FAILED(g->LoadTextureSystemMem(file, transcolor, w, h, textureData)))
+	{
+		SAFE_RELEASE(textureData);
+		return false;
+	}
+
+	D3DSURFACE_DESC desc;
+	D3DLOCKED_RECT rect;
+	bool built = false;
+	if (SUCCEEDED(textureData->GetLevelDesc(0, &desc)) && desc.Format == D3DFMT_A8R8G8B8
+		&& SUCCEEDED(textureData->LockRect(0, &rect, NULL, D3DLOCK_READONLY)))
+	{
+		Build((const DWORD*)rect.pBits, rect.Pitch / sizeof(DWORD), desc.Width, desc.Height);
+		textureData->UnlockRect(0);
+		built = true;
+	}
+	SAFE_RELEASE(textureData);
+	return built;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RleSprite::Build(const DWORD *source, UINT pitch, UINT w, UINT h)
+{
+	width = w;
+	height = h;
+	skipped = 0;
+	runs.clear();
+	pixels.clear();
+	rowRuns.assign(height + 1, 0);
+	rowPixels.assign(height + 1, 0);
+	texels.resize(width * height);
+
+	for (UINT y = 0; y < height; ++y)
+	{
+		const DWORD *row = source + y * pitch;
+		rowRuns[y] = (UINT)runs.size();
+		rowPixels[y] = (UINT)pixels.size();
+		memcpy(&texels[y * width], row, width * sizeof(DWORD));
+
+		UINT x = 0;
+		while (x < width)
+		{
+			DWORD alpha = row[x] >> 24;
+			BYTE type = (BYTE)(alpha == 0 ? RleSpriteNS::SKIP : (alpha == 0xff ? RleSpriteNS::COPY : RleSpriteNS::BLEND));
+
+			// Extend while the texels are of the same kind
+			UINT end = x + 1;
+			while (end < width && end - x < RleSpriteNS::MAX_RUN)
+			{
+				DWORD a = row[end] >> 24;
+				BYTE t = (BYTE)(a == 0 ? RleSpriteNS::SKIP : (a == 0xff ? RleSpriteNS::COPY : RleSpriteNS::BLEND));
+				if (t != type)
+					break;
+				end++;
+			}
+
+			Run run;
+			run.length = (WORD)(end - x);
+			run.type = type;
+			runs.push_back(run);
+			if (type == RleSpriteNS::SKIP)
+				skipped += end - x;
+			else
+				pixels.insert(pixels.end(), row + x, row + end);
+			x = end;
+		}
+	}
+	rowRuns[height] = (UINT)runs.size();
+	rowPixels[height] = (UINT)pixels.size();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RleSprite::Draw(PixelBuffer &dest, const SpriteData &spriteData) const
+{
+	if (spriteData.scale == 1.0f && spriteData.angle == 0.0f && !spriteData.flipHorizontal && !spriteData.flipVertical)
+		Blit(dest, (int)floorf(spriteData.x + 0.5f), (int)floorf(spriteData.y + 0.5f), spriteData.rect);
+	else
+		BlitTransformed(dest, spriteData);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RleSprite::Blit(PixelBuffer &dest, int x, int y, const RECT &src) const
+{
+	// Source columns that land inside dest
+	LONG left = src.left > 0 ? src.left : 0;
+	LONG right = src.right < (LONG)width ? src.right : (LONG)width;
+	if (src.left - x > left)
+		left = src.left - x;
+	if (src.left - x + (LONG)dest.width < right)
+		right = src.left - x + (LONG)dest.width;
+	if (left >= right)
+		return;
+
+	LONG top = src.top > 0 ? src.top : 0;
+	LONG bottom = src.bottom < (LONG)height ? src.bottom : (LONG)height;
+	for (LONG sy = top; sy < bottom; ++sy)
+	{
+		LONG dy = y + sy - src.top;
+		if (dy < 0)
+			continue;
+		if (dy >= (LONG)dest.height)
+			break;
+
+		DWORD *destRow = dest.pixels + dy * dest.pitch + x - src.left;
+		const DWORD *rowPixel = pixels.empty() ? NULL : &pixels[rowPixels[sy]];
+		LONG runStart = 0;
+		for (UINT r = rowRuns[sy]; r < rowRuns[sy + 1] && runStart < right; ++r)
+		{
+			const Run &run = runs[r];
+			LONG runEnd = runStart + run.length;
+			LONG lo = runStart > left ? runStart : left;
+			LONG hi = runEnd < right ? runEnd : right;
+
+			if (run.type == RleSpriteNS::COPY)
+			{
+				if (lo < hi)
+					memcpy(destRow + lo, rowPixel + (lo - runStart), (hi - lo) * sizeof(DWORD));
+				rowPixel += run.length;
+			}
+			else if (run.type == RleSpriteNS::BLEND)
+			{
+				for (LONG sx = lo; sx < hi; ++sx)
+					destRow[sx] = BlendPixel(rowPixel[sx - runStart], destRow[sx]);
+				rowPixel += run.length;
+			}
+			runStart = runEnd;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RleSprite::BlitTransformed(PixelBuffer &dest, const SpriteData &spriteData) const
+{
+	const RECT &src = spriteData.rect;
+	float scale = spriteData.scale;
+	if (scale == 0.0f || texels.empty())
+		return;
+
+	// Same placement as Graphics::DrawSprite, the scaled rect rotated around its center
+	float halfWidth = spriteData.width * scale * 0.5f;
+	float halfHeight = spriteData.height * scale * 0.5f;
+	float centerX = spriteData.x + halfWidth;
+	float centerY = spriteData.y + halfHeight;
+	float c = cosf(spriteData.angle);
+	float s = sinf(spriteData.angle);
+
+	float left, top, right, bottom;
+	Graphics::GetSpriteBounds(spriteData, left, top, right, bottom);
+	int x0 = left > 0.0f ? (int)left : 0;
+	int y0 = top > 0.0f ? (int)top : 0;
+	int x1 = right < (float)dest.width ? (int)ceilf(right) : (int)dest.width;
+	int y1 = bottom < (float)dest.height ? (int)ceilf(bottom) : (int)dest.height;
+
+	LONG srcWidth = src.right - src.left;
+	LONG srcHeight = src.bottom - src.top;
+	for (int py = y0; py < y1; ++py)
+	{
+		DWORD *destRow = dest.pixels + py * dest.pitch;
+		float dy = py + 0.5f - centerY;
+		for (int px = x0; px < x1; ++px)
+		{
+			// Undo the rotation, then the scale
+			float dx = px + 0.5f - centerX;
+			float u = (dx * c + dy * s) / scale + spriteData.width * 0.5f;
+			float v = (-dx * s + dy * c) / scale + spriteData.height * 0.5f;
+			if (u < 0.0f || v < 0.0f)
+				continue;
+			LONG tx = (LONG)u;
+			LONG ty = (LONG)v;
+			if (tx >= srcWidth || ty >= srcHeight)
+				continue;
+			if (spriteData.flipHorizontal)
+				tx = srcWidth - 1 - tx;
+			if (spriteData.flipVertical)
+				ty = srcHeight - 1 - ty;
+
+			DWORD texel = texels[(src.top + ty) * width + src.left + tx];
+			if (texel >> 24)
+				destRow[px] = BlendPixel(texel, destRow[px]);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void RleSprite::BlitTexels(PixelBuffer &dest, const DWORD *source, UINT pitch, int x, int y, const RECT &src)
+{
+	for (LONG sy = src.top; sy < src.bottom; ++sy)
+	{
+		LONG dy = y + sy - src.top;
+		if (dy < 0 || dy >= (LONG)dest.height)
+			continue;
+		DWORD *destRow = dest.pixels + dy * dest.pitch;
+		const DWORD *row = source + sy * pitch;
+		for (LONG sx = src.left; sx < src.right; ++sx)
+		{
+			LONG dx = x + sx - src.left;
+			if (dx < 0 || dx >= (LONG)dest.width)
+				continue;
+			destRow[dx] = BlendPixel(row[sx], destRow[dx]);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+DWORD RleSprite::BlendPixel(DWORD src, DWORD dst)
+{
+	DWORD a = src >> 24;
+	DWORD ia = 255 - a;
+
+	// x / 255 is close to (x + 128 + (x >> 8)) >> 8, red and blue are done together
+	DWORD rb = (src & 0x00ff00ff) * a + (dst & 0x00ff00ff) * ia;
+	rb = ((rb + 0x00800080 + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+	DWORD g = ((src >> 8) & 0xff) * a + ((dst >> 8) & 0xff) * ia;
+	g = (g + 128 + (g >> 8)) >> 8;
+	DWORD outA = (dst >> 24) * ia;
+	outA = a + ((outA + 128 + (outA >> 8)) >> 8);
+	return (outA << 24) | (g << 8) | rb;
+}
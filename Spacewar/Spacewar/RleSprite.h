@@ -0,0 +1,85 @@
+#ifndef _RLE_SPRITE_H_
+#define _RLE_SPRITE_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+
+#include "Constants.h"
+#include "Graphics.h"
+
+namespace RleSpriteNS
+{
+	enum RUN_TYPE
+	{
+		SKIP,		// alpha 0, nothing to draw
+		COPY,		// alpha 255, copied as is
+		BLEND		// partly translucent, blended with the destination
+	};
+	const UINT MAX_RUN = 0xffff;	// longer runs are split
+}
+
+// Destination of the CPU blitter, rows of 32 bit ARGB pixels
+struct PixelBuffer
+{
+	DWORD *pixels;
+	UINT pitch;			// pixels per row
+	UINT width;
+	UINT height;
+};
+
+// Sprite image baked into per row runs of transparent, opaque and translucent texels.
+// Unscaled, unrotated draws walk the runs: transparent runs are skipped and opaque runs
+// are copied with memcpy, only the translucent texels are blended.
+// Scaled, rotated or flipped draws use the general path that samples every destination pixel.
+class RleSprite
+{
+public:
+	RleSprite();
+
+	// Load file into system memory with transcolor as transparent and bake it.
+	// Post: returns false if the file cannot be loaded or is not 32 bit ARGB
+	bool Initialize(Graphics *g, const char *file, COLOR_ARGB transcolor = TRANSCOLOR);
+
+	// Bake texels, pitch = texels per row
+	void Build(const DWORD *texels, UINT pitch, UINT width, UINT height);
+
+	// Draw spriteData.rect of the image the way Graphics::DrawSprite would, picks the fast path when possible
+	void Draw(PixelBuffer &dest, const SpriteData &spriteData) const;
+
+	// Fast path, src = part of the image to draw at x, y. Clipped to dest
+	void Blit(PixelBuffer &dest, int x, int y, const RECT &src) const;
+
+	// General path, every destination pixel under the sprite samples its source texel (nearest)
+	void BlitTransformed(PixelBuffer &dest, const SpriteData &spriteData) const;
+
+	// Reference blitter that blends every texel of src, used to measure the runs
+	static void BlitTexels(PixelBuffer &dest, const DWORD *texels, UINT pitch, int x, int y, const RECT &src);
+
+	// src over dst, both ARGB
+	static DWORD BlendPixel(DWORD src, DWORD dst);
+
+	UINT GetWidth() const				{ return width; }
+	UINT GetHeight() const				{ return height; }
+	UINT GetRunCount() const			{ return (UINT)runs.size(); }
+	const DWORD* GetTexels() const		{ return texels.empty() ? NULL : &texels[0]; }
+	// Share of the texels in transparent runs, 0 to 1
+	float GetSkipFraction() const		{ return width * height ? (float)skipped / (width * height) : 0.0f; }
+
+private:
+	struct Run
+	{
+		WORD length;
+		BYTE type;		// RleSpriteNS::RUN_TYPE
+	};
+
+	std::vector<Run> runs;
+	std::vector<UINT> rowRuns;		// first run of each row, height + 1 entries
+	std::vector<UINT> rowPixels;	// first stored pixel of each row
+	std::vector<DWORD> pixels;		// texels of the COPY and BLEND runs, in run order
+	std::vector<DWORD> texels;		// whole image for the general path
+	UINT width;
+	UINT height;
+	UINT skipped;
+};
+
+#endif // _RLE_SPRITE_H_
@@ -0,0 +1,175 @@
+#include <string.h>
+
+#include "ShadowCache.h"
+
+ShadowCache::ShadowCache()
+	: capacity (ShadowCacheNS::DEFAULT_CAPACITY)
+	, bytesHeld (0)
+	, bytesUnpacked (0)
+	, restores (0)
+	, rejected (0)
+	, packing (true)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool ShadowCache::Store(const std::string &key, const uint32_t *pixels, uint32_t pitch, uint32_t width, uint32_t height)
+{
+	if (pixels == NULL || width == 0 || height == 0)
+		return false;
+
+	Image image;
+	image.width = width;
+	image.height = height;
+	image.packed = false;
+
+	// Packed only when it saves at least a quarter, unpacking costs more than a plain copy
+	uint32_t plain = width * height;
+	if (packing && Pack(pixels, pitch, width, height, image.data, plain * 3 / 4) > 0)
+		image.packed = true;
+	else
+	{
+		image.data.resize(plain);
+		for (uint32_t y = 0; y < height; ++y)
+			memcpy(&image.data[y * width], pixels + y * pitch, width * sizeof(uint32_t));
+	}
+
+	// A copy kept of key is replaced, but only once the new one fits
+	uint32_t bytes = (uint32_t)image.data.size() * sizeof(uint32_t);
+	std::map<std::string, Image>::iterator old = images.find(key);
+	uint32_t oldBytes = old != images.end() ? (uint32_t)old->second.data.size() * sizeof(uint32_t) : 0;
+	if (bytesHeld - oldBytes + bytes > capacity)
+	{
+		rejected++;
+		return false;
+	}
+	Remove(key);
+
+	Image &kept = images[key];
+	kept.width = width;
+	kept.height = height;
+	kept.packed = image.packed;
+	kept.data.swap(image.data);		// no second copy of the pixels
+	bytesHeld += bytes;
+	bytesUnpacked += plain * sizeof(uint32_t);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool ShadowCache::Restore(const std::string &key, uint32_t *dest, uint32_t pitch)
+{
+	std::map<std::string, Image>::const_iterator it = images.find(key);
+	if (it == images.end() || dest == NULL)
+		return false;
+
+	const Image &image = it->second;
+	if (!image.packed)
+	{
+		for (uint32_t y = 0; y < image.height; ++y)
+			memcpy(dest + y * pitch, &image.data[y * image.width], image.width * sizeof(uint32_t));
+	}
+	else
+		Unpack(&image.data[0], image.data.size(), dest, pitch, image.width);
+	restores++;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool ShadowCache::GetSize(const std::string &key, uint32_t &width, uint32_t &height) const
+{
+	std::map<std::string, Image>::const_iterator it = images.find(key);
+	if (it == images.end())
+		return false;
+	width = it->second.width;
+	height = it->second.height;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ShadowCache::Remove(const std::string &key)
+{
+	std::map<std::string, Image>::iterator it = images.find(key);
+	if (it == images.end())
+		return;
+	bytesHeld -= (uint32_t)it->second.data.size() * sizeof(uint32_t);
+	bytesUnpacked -= it->second.width * it->second.height * sizeof(uint32_t);
+	images.erase(it);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ShadowCache::Clear()
+{
+	images.clear();
+	bytesHeld = 0;
+	bytesUnpacked = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t ShadowCache::Pack(const uint32_t *pixels, uint32_t pitch, uint32_t width, uint32_t height, std::vector<uint32_t> &runs, uint32_t limit)
+{
+	// Gives up as soon as the runs take more than limit
+	runs.clear();
+	uint32_t current = pixels[0];
+	uint32_t count = 0;
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		const uint32_t *row = pixels + y * pitch;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			if (row[x] == current && count < ShadowCacheNS::MAX_RUN)
+			{
+				count++;
+				continue;
+			}
+			runs.push_back(count);
+			runs.push_back(current);
+			if (runs.size() > limit)
+			{
+				runs.clear();
+				return 0;
+			}
+			current = row[x];
+			count = 1;
+		}
+	}
+	runs.push_back(count);
+	runs.push_back(current);
+	if (runs.size() > limit)
+	{
+		runs.clear();
+		return 0;
+	}
+	return (uint32_t)runs.size();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void ShadowCache::Unpack(const uint32_t *runs, size_t count, uint32_t *dest, uint32_t pitch, uint32_t width)
+{
+	uint32_t x = 0;
+	uint32_t *row = dest;
+	for (size_t i = 0; i + 1 < count; i += 2)
+	{
+		uint32_t length = runs[i];
+		uint32_t pixel = runs[i + 1];
+		while (length > 0)
+		{
+			uint32_t n = width - x < length ? width - x : length;
+			for (uint32_t j = 0; j < n; ++j)
+				row[x + j] = pixel;
+			x += n;
+			length -= n;
+			if (x == width)
+			{
+				x = 0;
+				row += pitch;
+			}
+		}
+	}
+}
@@ -0,0 +1,75 @@
+#ifndef _SHADOW_CACHE_H_
+#define _SHADOW_CACHE_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ShadowCacheNS
+{
+	const uint32_t DEFAULT_CAPACITY = 128 * 1024 * 1024;	// bytes of system memory for all copies
+	const uint32_t MAX_RUN = 0xffff;						// longest run of one pixel value in a packed copy
+}
+
+// System memory copies of decoded 32 bit images, so textures lost with the device (or evicted)
+// are recreated by copying pixels instead of reading and decoding their file again.
+// A copy is packed as runs of equal pixels when that makes it smaller, flat art and
+// transparent borders pack well. Copies that do not fit the capacity are not kept.
+// Only pixels are handled, the cache works without a device or Windows headers,
+// see Tests/ShadowCacheTest.cpp.
+class ShadowCache
+{
+public:
+	ShadowCache();
+
+	void SetCapacity(uint32_t bytes)	{ capacity = bytes; }
+	void SetPacking(bool p)				{ packing = p; }	// applies to copies stored afterwards
+
+	// Keep a copy of width x height pixels, rows pitch pixels apart.
+	// Post: returns false if it does not fit the capacity
+	bool Store(const std::string &key, const uint32_t *pixels, uint32_t pitch, uint32_t width, uint32_t height);
+
+	// Copy the pixels of key into dest, rows pitch pixels apart.
+	// Post: returns false if no copy of key is kept
+	bool Restore(const std::string &key, uint32_t *dest, uint32_t pitch);
+
+	bool Contains(const std::string &key) const		{ return images.find(key) != images.end(); }
+	bool GetSize(const std::string &key, uint32_t &width, uint32_t &height) const;
+	void Remove(const std::string &key);
+	void Clear();
+
+	uint32_t GetCapacity() const		{ return capacity; }
+	uint32_t GetCount() const			{ return (uint32_t)images.size(); }
+	uint32_t GetBytesHeld() const		{ return bytesHeld; }	// memory used by the copies
+	uint32_t GetBytesUnpacked() const	{ return bytesUnpacked; }	// size of the same images as plain pixels
+	uint32_t GetRestores() const		{ return restores; }
+	uint32_t GetRejected() const		{ return rejected; }	// copies that did not fit
+
+	// Pairs of run length and pixel, rows may share a run.
+	// Post: returns the values used, 0 and runs empty if it would take more than limit
+	static uint32_t Pack(const uint32_t *pixels, uint32_t pitch, uint32_t width, uint32_t height, std::vector<uint32_t> &runs, uint32_t limit);
+	// Expand count values of runs into rows of width pixels, pitch pixels apart
+	static void Unpack(const uint32_t *runs, size_t count, uint32_t *dest, uint32_t pitch, uint32_t width);
+
+private:
+	struct Image
+	{
+		uint32_t width;
+		uint32_t height;
+		bool packed;
+		std::vector<uint32_t> data;	// pixels row after row, or pairs of run length and pixel
+	};
+
+private:
+	std::map<std::string, Image> images;
+	uint32_t capacity;
+	uint32_t bytesHeld;
+	uint32_t bytesUnpacked;
+	uint32_t restores;
+	uint32_t rejected;
+	bool packing;
+};
+
+#endif // _SHADOW_CACHE_H_
@@ -13,10 +13,7 @@ Spinner::Spinner() : Entity()
 	spriteData.rect.right = SpinnerNS::WIDTH;
 	velocity.x = 0;
 	velocity.y = 0;
-	frameDelay = SpinnerNS::ANIMATION_DELAY;
-	startFrame = SpinnerNS::START_FRAME;
-	endFrame = SpinnerNS::END_FRAME;
-	currentFrame = startFrame;
+	currentFrame = SpinnerNS::START_FRAME;
 	radius = SpinnerNS::WIDTH/2.0f;
 	collisionType = EntityNS::CIRCLE;
 	active = false;
@@ -52,12 +49,5 @@ void Spinner::Update(float frameTime)
 		return;
 
 	Entity::Update(frameTime);
-	spriteData.x += SpinnerNS::SPEED * frameTime * velocity.x; // move Spinner along X 
-
-	if (spriteData.x + spriteData.width < 0) // if hit left screen edge
-	{
-		active = false;
-		visible = false;
-		spriteData.x = GAME_WIDTH; // position at right screen edge
-	}
+	Advance(); // x from its launch, leaving the screen is scheduled by the game
 }
\ No newline at end of file
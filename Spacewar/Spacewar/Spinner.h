@@ -15,7 +15,7 @@ namespace SpinnerNS
 	const int START_FRAME = 0;
 	const int END_FRAME = 1;
 	const float ANIMATION_DELAY = 0.5f;	// time between frames
-	const float SPEED = 400.0f;					// 100 pixels per second
+	const float DRIFT = 0.0f;					// pixels per second relative to the ground, 0 = waits for the player
 }
 
 class Spinner : public Entity
@@ -0,0 +1,115 @@
+#include <math.h>
+#include <xmmintrin.h>
+
+#include "SpriteCuller.h"
+
+SpriteCuller::SpriteCuller()
+	: count (0)
+	, viewLeft (0.0f)
+	, viewTop (0.0f)
+	, viewRight ((float)GAME_WIDTH)
+	, viewBottom ((float)GAME_HEIGHT)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SpriteCuller::SetViewport(float left, float top, float right, float bottom)
+{
+	viewLeft = left - SpriteCullerNS::MARGIN;
+	viewTop = top - SpriteCullerNS::MARGIN;
+	viewRight = right + SpriteCullerNS::MARGIN;
+	viewBottom = bottom + SpriteCullerNS::MARGIN;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SpriteCuller::Clear()
+{
+	// Keep the capacity, the batch is refilled every flush
+	centerX.clear();
+	centerY.clear();
+	halfWidth.clear();
+	halfHeight.clear();
+	absCos.clear();
+	absSin.clear();
+	count = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void SpriteCuller::Add(const SpriteData &spriteData)
+{
+	float hw = spriteData.width * spriteData.scale * 0.5f;
+	float hh = spriteData.height * spriteData.scale * 0.5f;
+
+	centerX.push_back(spriteData.x + hw);
+	centerY.push_back(spriteData.y + hh);
+	// Negative scale flips the sprite, the extent is the same
+	halfWidth.push_back(fabsf(hw));
+	halfHeight.push_back(fabsf(hh));
+
+	// Most sprites are not rotated, skip the trig for them
+	if (spriteData.angle == 0.0f)
+	{
+		absCos.push_back(1.0f);
+		absSin.push_back(0.0f);
+	}
+	else
+	{
+		absCos.push_back(fabsf(cosf(spriteData.angle)));
+		absSin.push_back(fabsf(sinf(spriteData.angle)));
+	}
+	count++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINT SpriteCuller::Cull(std::vector<BYTE> &visible)
+{
+	visible.resize(count);
+	if (count == 0)
+		return 0;
+
+	// Pad to a multiple of 4 with empty sprites far outside the view
+	UINT padded = (count + 3) & ~3u;
+	centerX.resize(padded, -1.0e30f);
+	centerY.resize(padded, -1.0e30f);
+	halfWidth.resize(padded, 0.0f);
+	halfHeight.resize(padded, 0.0f);
+	absCos.resize(padded, 1.0f);
+	absSin.resize(padded, 0.0f);
+
+	const __m128 left = _mm_set1_ps(viewLeft);
+	const __m128 top = _mm_set1_ps(viewTop);
+	const __m128 right = _mm_set1_ps(viewRight);
+	const __m128 bottom = _mm_set1_ps(viewBottom);
+
+	UINT visibleCount = 0;
+	for (UINT i = 0; i < padded; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(&centerX[i]);
+		__m128 cy = _mm_loadu_ps(&centerY[i]);
+		__m128 hw = _mm_loadu_ps(&halfWidth[i]);
+		__m128 hh = _mm_loadu_ps(&halfHeight[i]);
+		__m128 c = _mm_loadu_ps(&absCos[i]);
+		__m128 s = _mm_loadu_ps(&absSin[i]);
+
+		// Half extents of the axis aligned box around the rotated rect
+		__m128 ex = _mm_add_ps(_mm_mul_ps(c, hw), _mm_mul_ps(s, hh));
+		__m128 ey = _mm_add_ps(_mm_mul_ps(s, hw), _mm_mul_ps(c, hh));
+
+		// Overlap on both axes
+		__m128 inside = _mm_and_ps(_mm_cmpgt_ps(_mm_add_ps(cx, ex), left), _mm_cmplt_ps(_mm_sub_ps(cx, ex), right));
+		inside = _mm_and_ps(inside, _mm_cmpgt_ps(_mm_add_ps(cy, ey), top));
+		inside = _mm_and_ps(inside, _mm_cmplt_ps(_mm_sub_ps(cy, ey), bottom));
+
+		int mask = _mm_movemask_ps(inside);
+		for (UINT j = 0; j < 4 && i + j < count; ++j)
+		{
+			visible[i + j] = (BYTE)((mask >> j) & 1);
+			visibleCount += visible[i + j];
+		}
+	}
+	return visibleCount;
+}
@@ -0,0 +1,53 @@
+#ifndef _SPRITE_CULLER_H_
+#define _SPRITE_CULLER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+
+#include "Constants.h"
+#include "Graphics.h"
+
+namespace SpriteCullerNS
+{
+	const float MARGIN = 1.0f;		// pixels added around the viewport to absorb rounding of the sprite center
+}
+
+// Tests a batch of sprites against the viewport.
+// Bounds are kept as structure of arrays (center, half size, |cos|, |sin|) so the
+// rotated AABB and the overlap test run four sprites at a time with SSE.
+class SpriteCuller
+{
+public:
+	SpriteCuller();
+
+	void SetViewport(float left, float top, float right, float bottom);
+
+	// Remove all sprites from the batch
+	void Clear();
+
+	// Add the bounds of a sprite to the batch. Bounds match Graphics::DrawSprite:
+	// the scaled rect rotated around its center (flips do not change the bounds).
+	void Add(const SpriteData &spriteData);
+
+	// Test the whole batch. visible[i] is set to 1 if sprite i overlaps the viewport, 0 if it can be skipped.
+	// Returns the number of visible sprites.
+	UINT Cull(std::vector<BYTE> &visible);
+
+	UINT GetCount() const { return count; }
+
+private:
+	// Structure of arrays, padded to a multiple of 4
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> halfWidth;
+	std::vector<float> halfHeight;
+	std::vector<float> absCos;
+	std::vector<float> absSin;
+	UINT count;
+	float viewLeft;
+	float viewTop;
+	float viewRight;
+	float viewBottom;
+};
+
+#endif // _SPRITE_CULLER_H_
@@ -0,0 +1,147 @@
+#include <math.h>
+#include <string.h>
+
+#include "StressTest.h"
+
+// Visual C++ before 2015 only has _snprintf, it returns -1 instead of the length needed when truncated
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define snprintf _snprintf
+#endif
+
+using namespace StressTestNS;
+
+namespace
+{
+	float Clamp01(float value)
+	{
+		return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	}
+}
+
+StressTest::StressTest()
+	: rate (0.0f)
+	, enemyShare (0.5f)
+	, flyShare (0.5f)
+	, frames (0)
+	, reportTime (0.0f)
+	, elapsed (0.0f)
+	, duration (0.0f)
+	, log (NULL)
+{
+	memset(carry, 0, sizeof(carry));
+	memset(times, 0, sizeof(times));
+	memset(averages, 0, sizeof(averages));
+	report[0] = '\0';
+}
+
+//----------------------------------------------------------------------------------------------------
+
+StressTest::~StressTest()
+{
+	Stop();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void StressTest::Start(float r, float enemies, float flying)
+{
+	rate = r > 0.0f ? r : 0.0f;
+	enemyShare = Clamp01(enemies);
+	flyShare = Clamp01(flying);
+	memset(carry, 0, sizeof(carry));
+	memset(times, 0, sizeof(times));
+	memset(averages, 0, sizeof(averages));
+	frames = 0;
+	reportTime = 0.0f;
+	elapsed = 0.0f;
+	snprintf(report, BUFFER_SIZE, "Stress %.0f/s, measuring", rate);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void StressTest::Stop()
+{
+	rate = 0.0f;
+	if (log)
+		fclose(log);
+	log = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool StressTest::OpenLog(const char *file)
+{
+	if (log)
+		fclose(log);
+	log = fopen(file, "w");
+	if (log == NULL)
+		return false;
+	fprintf(log, "seconds,rate,entities,tick_ms,collisions_ms,render_ms,fps\n");
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void StressTest::TakeBatch(int &spinners, int &flies, int &pickups)
+{
+	float batch = rate * SPAWN_INTERVAL;
+	float shares[3] = { enemyShare * (1.0f - flyShare), enemyShare * flyShare, 1.0f - enemyShare };
+	int counts[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		carry[i] += batch * shares[i];
+		counts[i] = (int)carry[i];
+		carry[i] -= counts[i];
+	}
+	spinners = counts[0];
+	flies = counts[1];
+	pickups = counts[2];
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void StressTest::EndFrame(float frameTime, int entities, long long frequency)
+{
+	if (!IsRunning())
+		return;
+
+	frames++;
+	reportTime += frameTime;
+	elapsed += frameTime;
+	if (reportTime < REPORT_INTERVAL || frequency <= 0)
+		return;
+
+	static const char *names[SECTION_COUNT] = { "tick", "collisions", "render" };
+	for (int i = 0; i < SECTION_COUNT; ++i)
+		averages[i] = (float)(times[i] * 1000.0 / frequency / frames);
+
+	// Appending stops once the buffer is full, either way snprintf says so
+	int length = snprintf(report, BUFFER_SIZE, "Stress %.0f/s, %d entities:", rate, entities);
+	for (int i = 0; i < SECTION_COUNT && length >= 0 && length < BUFFER_SIZE; ++i)
+	{
+		int written = snprintf(report + length, BUFFER_SIZE - length, " %s %.2f ms,", names[i], averages[i]);
+		length = written >= 0 ? length + written : -1;
+	}
+	if (length >= 0 && length < BUFFER_SIZE)
+		snprintf(report + length, BUFFER_SIZE - length, " %.0f fps", frames / reportTime);
+	report[BUFFER_SIZE - 1] = '\0';
+
+	if (log)
+	{
+		fprintf(log, "%.1f,%.0f,%d,%.3f,%.3f,%.3f,%.1f\n", elapsed, rate, entities,
+			averages[TICK], averages[COLLISIONS], averages[RENDER], frames / reportTime);
+		fflush(log);	// a run ended by closing the window keeps its lines
+	}
+
+	memset(times, 0, sizeof(times));
+	frames = 0;
+	reportTime = 0.0f;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int StressTest::GetPool(float share) const
+{
+	int pool = (int)ceilf(rate * share * LIFETIME) + 1;
+	return pool < MAX_POOL ? pool : MAX_POOL;
+}
@@ -0,0 +1,74 @@
+#ifndef _STRESS_TEST_H_
+#define _STRESS_TEST_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdio.h>
+
+namespace StressTestNS
+{
+	const float SPAWN_INTERVAL = 0.05f;	// seconds between spawn batches
+	const float LIFETIME = 5.0f;		// seconds an entity stays in the world at the slowest scroll, sizes the pools
+	const float REPORT_INTERVAL = 1.0f;	// seconds the timings are averaged over
+	const int MAX_POOL = 4096;			// entities of each kind
+	const int BUFFER_SIZE = 160;
+
+	// Parts of a frame that are timed
+	enum Section { TICK, COLLISIONS, RENDER, SECTION_COUNT };
+}
+
+// Spawns enemies and pickups at a fixed rate to see how the game scales with their number,
+// and times the tick, the collisions and the render of each frame. Timings are averaged over
+// REPORT_INTERVAL and can be appended to a comma separated log, one line per report.
+// Kept free of Windows headers so it also runs without the game, see Tests/StressDriver.cpp.
+class StressTest
+{
+public:
+	StressTest();
+	~StressTest();
+
+	// rate spawns per second, enemyShare of them enemies and flyShare of the enemies flies
+	void Start(float rate, float enemyShare = 0.5f, float flyShare = 0.5f);
+	void Stop();							// closes the log
+	bool IsRunning() const					{ return rate > 0.0f; }
+
+	// Post: returns false if file can not be created
+	bool OpenLog(const char *file);
+	void SetDuration(float seconds)			{ duration = seconds; }	// 0 = until stopped
+	bool IsFinished() const					{ return duration > 0.0f && elapsed >= duration; }
+
+	// Spawns of each kind in one batch, fractions carry over to the next
+	void TakeBatch(int &spinners, int &flies, int &pickups);
+
+	// Entities of each kind alive at once at the rate
+	int GetSpinnerPool() const				{ return GetPool(enemyShare * (1.0f - flyShare)); }
+	int GetFlyPool() const					{ return GetPool(enemyShare * flyShare); }
+	int GetPickupPool() const				{ return GetPool(1.0f - enemyShare); }
+
+	// Performance counter ticks spent in section this frame
+	void AddTime(StressTestNS::Section section, long long ticks)	{ times[section] += ticks; }
+	// Pre: called once a tick. entities = active ones
+	void EndFrame(float frameTime, int entities, long long frequency);
+
+	// Milliseconds per frame in section, averaged over the last report
+	float GetAverage(StressTestNS::Section section) const		{ return averages[section]; }
+	const char* GetReport() const			{ return report; }
+
+private:
+	int GetPool(float share) const;
+
+private:
+	float rate;
+	float enemyShare;
+	float flyShare;
+	float carry[3];									// spinners, flies and pickups owed from earlier batches
+	long long times[StressTestNS::SECTION_COUNT];	// since the last report
+	float averages[StressTestNS::SECTION_COUNT];
+	int frames;										// since the last report
+	float reportTime;
+	float elapsed;									// since Start
+	float duration;
+	FILE *log;
+	char report[StressTestNS::BUFFER_SIZE];
+};
+
+#endif // _STRESS_TEST_H_
@@ -1,4 +1,5 @@
 #include "TextDX.h"
+#include "RenderRecorder.h"
 
 //=============================================================================
 // default constructor
@@ -14,6 +15,9 @@ TextDX::TextDX()
 	fontRect.bottom = GAME_HEIGHT;
 	dxFont = NULL;
 	angle  = 0;
+	fontHeight = 0;
+	fontBold = false;
+	fontItalic = false;
 }
 
 //=============================================================================
@@ -31,6 +35,10 @@ bool TextDX::initialize(Graphics *g, int height, bool bold, bool italic,
 	const std::string &fontName)
 {
 	graphics = g;                   // the graphics system
+	fontHeight = height;
+	fontBold = bold;
+	fontItalic = italic;
+	this->fontName = fontName;
 
 	UINT weight = FW_NORMAL;
 	if(bold)
@@ -62,6 +70,10 @@ int TextDX::print(const std::string &str, int x, int y)
 	fontRect.top = y;
 	fontRect.left = x;
 
+	if (graphics->GetRecorder())
+		graphics->GetRecorder()->RecordText(this, str, x, y, angle, color);
+	graphics->FlushSprites();   // keep text in order with queued sprites
+
 	// Rotation center
 	D3DXVECTOR2 rCenter=D3DXVECTOR2((float)x,(float)y);
 	// Setup matrix to rotate text by angle
@@ -82,6 +94,10 @@ int TextDX::print(const std::string &str, RECT &rect, UINT format)
 	if(dxFont == NULL)
 		return 0;
 
+	if (graphics->GetRecorder())
+		graphics->GetRecorder()->RecordText(this, str, rect, format, color);
+	graphics->FlushSprites();   // keep text in order with queued sprites
+
 	// Setup matrix to not rotate text
 	D3DXMatrixTransformation2D(&matrix, NULL, 0.0f, NULL, NULL, NULL, NULL);
 	// Tell the sprite about the matrix "Hello Neo"
@@ -16,6 +16,10 @@ private:
     // matrix to rotate the text
     D3DXMATRIX  matrix;
     float       angle;          // rotation angle of text in radians
+    int         fontHeight;     // creation parameters, kept so the font can be recreated (render replay)
+    bool        fontBold;
+    bool        fontItalic;
+    std::string fontName;
 
 public:
     // Constructor (sprite text)
@@ -54,6 +58,12 @@ public:
     // Returns font color
     virtual COLOR_ARGB getFontColor() {return color;}
 
+    // Return the parameters the font was created with.
+    int getFontHeight() const               {return fontHeight;}
+    bool getBold() const                    {return fontBold;}
+    bool getItalic() const                  {return fontItalic;}
+    const std::string& getFontName() const  {return fontName;}
+
     // Set rotation angle in degrees.
     // 0 degrees is up. Angles progress clockwise.
     virtual void setDegrees(float deg)  {angle = deg*((float)PI/180.0f);}
@@ -44,7 +44,7 @@ void TextureManager::OnLostDevice()
 {
 	if (!initialized)
 		return;
-	SAFE_RELEASE(texture);
+	graphics->ReleaseTexture(texture);
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -0,0 +1,425 @@
+#include <ctype.h>
+#include <math.h>
+
+#include "TextureRegistry.h"
+
+TextureHandle::TextureHandle()
+	: registry (NULL)
+	, id (TextureRegistryNS::NO_ASSET)
+	, texture (NULL)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureHandle::TextureHandle(TextureRegistry *r, AssetId i, TextureManager *t)
+	: registry (r)
+	, id (i)
+	, texture (t)
+{
+	if (texture)
+		registry->AddRef(id);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureHandle::TextureHandle(const TextureHandle &other)
+	: registry (other.registry)
+	, id (other.id)
+	, texture (other.texture)
+{
+	if (texture)
+		registry->AddRef(id);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureHandle::~TextureHandle()
+{
+	Reset();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureHandle& TextureHandle::operator=(const TextureHandle &other)
+{
+	// Take the new reference first, other may hold the only one to the same texture
+	if (other.texture)
+		other.registry->AddRef(other.id);
+	Reset();
+	registry = other.registry;
+	id = other.id;
+	texture = other.texture;
+	return *this;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureHandle::Reset()
+{
+	if (texture)
+		registry->Release(id);
+	registry = NULL;
+	id = TextureRegistryNS::NO_ASSET;
+	texture = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureRegistry::TextureRegistry()
+	: graphics (NULL)
+	, loader (NULL)
+	, loads (0)
+	, hits (0)
+	, misses (0)
+	, prefetches (0)
+	, evictions (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureRegistry::~TextureRegistry()
+{
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		SafeDelete(entries[i]->texture);
+		SafeDelete(entries[i]);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureRegistry::Initialize(Graphics *g, AssetLoader *l)
+{
+	graphics = g;
+	loader = l;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+AssetId TextureRegistry::Intern(const char *file)
+{
+	if (file == NULL)
+		return TextureRegistryNS::NO_ASSET;
+
+	// File names on Windows ignore case and accept both slashes
+	std::string key;
+	if (file[0] == '.' && (file[1] == '/' || file[1] == '\\'))
+		file += 2;
+	for (const char *c = file; *c; ++c)
+		key += *c == '\\' ? '/' : (char)tolower((unsigned char)*c);
+
+	std::map<std::string, AssetId>::iterator it = ids.find(key);
+	if (it != ids.end())
+		return it->second;
+
+	Entry *entry = new Entry();
+	entry->file = file;
+	std::string source;
+	Graphics::SplitVariant(file, source, entry->scale);
+	entry->texture = NULL;
+	entry->refs = 0;
+	entry->queued = false;
+	entries.push_back(entry);
+	AssetId id = (AssetId)entries.size();
+	ids[key] = id;
+	return id;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+const char* TextureRegistry::GetFile(AssetId id) const
+{
+	if (id == TextureRegistryNS::NO_ASSET || id > entries.size())
+		return NULL;
+	return entries[id - 1]->file.c_str();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+AssetId TextureRegistry::InternVariant(AssetId id, float screenScale)
+{
+	const char *name = GetFile(id);
+	if (name == NULL)
+		return TextureRegistryNS::NO_ASSET;
+
+	// Relative to the full size file
+	std::string file;
+	float current;
+	Graphics::SplitVariant(name, file, current);
+	float needed = screenScale * current;
+	if (needed * TextureRegistryNS::VARIANT_SLACK >= 1.0f)
+		return Intern(file.c_str());
+	needed = Clamp(needed, GraphicsNS::MIN_VARIANT_SCALE, 1.0f);
+
+	float scale = needed;
+	for (UINT i = 0; i < TextureRegistryNS::VARIANT_TIER_COUNT; ++i)
+	{
+		float tier = TextureRegistryNS::VARIANT_TIERS[i];
+		if (tier >= needed && tier <= needed * TextureRegistryNS::VARIANT_SLACK)
+		{
+			scale = tier;
+			break;
+		}
+	}
+
+	// Rounded up to the two digits of the name so it is never drawn larger than its texels
+	scale = ceilf(scale * 100.0f - 0.001f) / 100.0f;
+	return Intern(Graphics::VariantName(file.c_str(), scale).c_str());
+}
+
+//----------------------------------------------------------------------------------------------------
+
+float TextureRegistry::GetVariantScale(AssetId id) const
+{
+	if (id == TextureRegistryNS::NO_ASSET || id > entries.size())
+		return 1.0f;
+	return entries[id - 1]->scale;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureHandle TextureRegistry::Acquire(const char *file)
+{
+	return Acquire(Intern(file));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+TextureHandle TextureRegistry::Acquire(AssetId id)
+{
+	if (id == TextureRegistryNS::NO_ASSET || id > entries.size() || graphics == NULL)
+		return TextureHandle();
+
+	Entry *entry = entries[id - 1];
+	if (entry->texture)
+	{
+		hits++;
+		return TextureHandle(this, id, entry->texture);
+	}
+
+	misses++;
+	if (!Load(id))
+		return TextureHandle();
+	TextureHandle handle(this, id, entry->texture);
+	EnforceBudget(); // the new texture is held, others make room
+	return handle;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TextureRegistry::Prefetch(AssetId id)
+{
+	if (id == TextureRegistryNS::NO_ASSET || id > entries.size() || graphics == NULL)
+		return false;
+
+	if (entries[id - 1]->texture)
+		residency.Touch(id);
+	else
+		QueuePreloads(&id, 1);
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureRegistry::Pin(AssetId id)
+{
+	if (id != TextureRegistryNS::NO_ASSET && id <= entries.size())
+		AddRef(id);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureRegistry::Unpin(AssetId id)
+{
+	if (id != TextureRegistryNS::NO_ASSET && id <= entries.size())
+		Release(id);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureRegistry::QueuePreloads(const AssetId *ids, UINT count)
+{
+	if (graphics == NULL)
+		return;
+
+	for (UINT i = 0; i < count; ++i)
+	{
+		AssetId id = ids[i];
+		if (id == TextureRegistryNS::NO_ASSET || id > entries.size())
+			continue;
+		Entry *entry = entries[id - 1];
+		if (entry->texture || entry->queued)
+			continue;
+		entry->queued = true;
+		preloads.push_back(id);
+		if (loader)
+			loader->Queue(id, entry->file.c_str(), TRANSCOLOR);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINT TextureRegistry::FinishPreloads()
+{
+	// Textures are created in the order the files finish decoding
+	UINT loaded = 0;
+	AssetLoad load;
+	while (loader && loader->Wait(load))
+	{
+		if (AddPreload(load))
+			loaded++;
+	}
+	return loaded + LoadQueued();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINT TextureRegistry::PollPreloads()
+{
+	UINT loaded = 0;
+	AssetLoad load;
+	while (loader && loader->Poll(load))
+	{
+		if (AddPreload(load))
+			loaded++;
+	}
+
+	// Files still queued once nothing is pending were never handed to the loader
+	if (loader == NULL || loader->GetPending() == 0)
+		loaded += LoadQueued();
+	return loaded;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TextureRegistry::AddPreload(AssetLoad &load)
+{
+	Entry *entry = entries[load.id - 1];
+	entry->queued = false;
+	if (load.copy == NULL)
+		return false;
+
+	// An Acquire that came before the decode finished loaded the file itself
+	if (entry->texture)
+	{
+		loader->Release(load);
+		return false;
+	}
+
+	graphics->AddDecodedTexture(entry->file.c_str(), load.transcolor, (LP_TEXTURE)load.copy);
+	if (!Load(load.id))
+		return false;
+	prefetches++;
+	EnforceBudget();
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINT TextureRegistry::LoadQueued()
+{
+	// Without a loader, or the loader was shut down
+	UINT loaded = 0;
+	for (size_t i = 0; i < preloads.size(); ++i)
+	{
+		Entry *entry = entries[preloads[i] - 1];
+		if (!entry->queued)
+			continue;
+		entry->queued = false;
+		if (!entry->texture && Load(preloads[i]))
+		{
+			prefetches++;
+			loaded++;
+			EnforceBudget();
+		}
+	}
+	preloads.clear();
+	return loaded;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureRegistry::SetBudget(UINT bytes)
+{
+	residency.SetBudget(bytes);
+	EnforceBudget();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureRegistry::OnLostDevice()
+{
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		if (entries[i]->texture)
+			entries[i]->texture->OnLostDevice();
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureRegistry::OnResetDevice()
+{
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		if (entries[i]->texture)
+			entries[i]->texture->OnResetDevice();
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureRegistry::AddRef(AssetId id)
+{
+	if (entries[id - 1]->refs++ == 0)
+		residency.SetInUse(id, true);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureRegistry::Release(AssetId id)
+{
+	Entry *entry = entries[id - 1];
+	if (entry->refs == 0 || --entry->refs > 0)
+		return;
+
+	// Last handle gone, the texture stays loaded until the budget needs its memory
+	residency.SetInUse(id, false);
+	EnforceBudget();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TextureRegistry::Load(AssetId id)
+{
+	Entry *entry = entries[id - 1];
+	TextureManager *texture = new TextureManager();
+	if (!texture->Initialize(graphics, entry->file.c_str()))
+	{
+		SafeDelete(texture);
+		return false;
+	}
+	loads++;
+	entry->texture = texture;
+	residency.Add(id, texture->GetWidth() * texture->GetHeight() * TextureRegistryNS::BYTES_PER_TEXEL);
+	if (entry->refs > 0)
+		residency.SetInUse(id, true);	// pinned before it was loaded
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TextureRegistry::EnforceBudget()
+{
+	UINT id;
+	while (residency.NextEviction(id))
+	{
+		// Released through the graphics first, the recorder must not reuse its id for another texture
+		entries[id - 1]->texture->OnLostDevice();
+		SafeDelete(entries[id - 1]->texture);
+		residency.Remove(id);
+		evictions++;
+	}
+}
@@ -0,0 +1,157 @@
+#ifndef _TEXTURE_REGISTRY_H_
+#define _TEXTURE_REGISTRY_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "AssetLoader.h"
+#include "Constants.h"
+#include "Graphics.h"
+#include "ResidencyManager.h"
+#include "TextureManager.h"
+
+// Interned name of an asset file, the same file always gets the same id
+typedef UINT AssetId;
+
+namespace TextureRegistryNS
+{
+	const AssetId NO_ASSET = 0;
+	const UINT BYTES_PER_TEXEL = 4;		// textures are loaded as 32 bit
+
+	// Shared variants, like mip levels, used when at most VARIANT_SLACK times the size needed.
+	// Otherwise a variant of exactly the size needed is made.
+	const float VARIANT_TIERS[] = { 0.25f, 0.5f };
+	const UINT VARIANT_TIER_COUNT = sizeof(VARIANT_TIERS) / sizeof(VARIANT_TIERS[0]);
+	const float VARIANT_SLACK = 1.1f;
+}
+
+class TextureRegistry;
+
+// Counted reference to a texture of a TextureRegistry. Copying a handle is cheap, a texture
+// is never evicted while a handle holds it. The TextureManager pointer stays the same
+// for as long as the texture is held, also across device resets.
+class TextureHandle
+{
+public:
+	TextureHandle();
+	TextureHandle(const TextureHandle &other);
+	~TextureHandle();
+	TextureHandle& operator=(const TextureHandle &other);
+
+	void Reset();	// let go of the texture, the handle is empty afterwards
+
+	TextureManager* Get() const		{ return texture; }
+	AssetId GetId() const			{ return id; }
+	bool IsValid() const			{ return texture != NULL; }
+
+private:
+	friend class TextureRegistry;
+	TextureHandle(TextureRegistry *r, AssetId id, TextureManager *t);
+
+private:
+	TextureRegistry *registry;
+	AssetId id;
+	TextureManager *texture;
+};
+
+// Loads every texture file once and hands out handles to it.
+// A texture no handle holds stays loaded until it is the least recently used one and the
+// textures loaded are over the memory budget. Prefetch starts loading a texture ahead of its
+// first use, a pin keeps it from being evicted until then.
+// Must outlive the handles it gave out.
+class TextureRegistry
+{
+public:
+	TextureRegistry();
+	virtual ~TextureRegistry();
+
+	// Files are decoded on the loader threads when one is given
+	void Initialize(Graphics *g, AssetLoader *l = NULL);
+
+	// Id of file. Paths differing only in case, slash direction or a leading "./" get the same id.
+	AssetId Intern(const char *file);
+	const char* GetFile(AssetId id) const;
+
+	// Id of the smallest variant of a file that is still sharp when the file is drawn at
+	// screenScale back buffer pixels per texel, the file itself from 1 up. Draw the
+	// variant at screenScale / GetVariantScale of it.
+	AssetId InternVariant(AssetId id, float screenScale);
+	float GetVariantScale(AssetId id) const;	// size of the image relative to its file
+
+	// Handle to the texture of file, loaded on the first request.
+	// Post: the handle is empty if the file cannot be loaded
+	TextureHandle Acquire(const char *file);
+	TextureHandle Acquire(AssetId id);
+
+	// Queue a texture that is about to be used as a preload, without holding it or waiting for it.
+	// An Acquire before PollPreloads created it loads the file on the spot.
+	// Post: returns false if id is not interned
+	bool Prefetch(const char *file)		{ return Prefetch(Intern(file)); }
+	bool Prefetch(AssetId id);
+
+	// Keep a texture from being evicted, whether it is loaded yet or not, until it is unpinned.
+	// Pin a prefetched texture until it is acquired. Every Pin needs an Unpin.
+	void Pin(AssetId id);
+	void Unpin(AssetId id);
+
+	// Load several textures at once, without holding them. QueuePreloads hands the files to the
+	// loader threads and returns, FinishPreloads creates each texture as its file is decoded.
+	// Other work can be done on the main thread in between. Without a loader FinishPreloads
+	// loads the files one after the other.
+	void QueuePreloads(const AssetId *ids, UINT count);
+	UINT FinishPreloads();	// returns the number of textures loaded
+	// Create the textures of the files decoded so far without waiting for the rest, call once a frame
+	UINT PollPreloads();	// returns the number of textures loaded
+
+	// Bytes of textures kept loaded, textures no handle holds are evicted to stay under it
+	void SetBudget(UINT bytes);
+	UINT GetBudget() const			{ return residency.GetBudget(); }
+
+	// Release or recreate every texture held, call around a device reset
+	void OnLostDevice();
+	void OnResetDevice();
+
+	UINT GetLoads() const			{ return loads; }			// files read from disk
+	UINT GetHits() const			{ return hits; }			// requests served by a texture already loaded
+	UINT GetMisses() const			{ return misses; }			// requests that had to load the file
+	UINT GetPrefetches() const		{ return prefetches; }		// files loaded ahead of use
+	UINT GetEvictions() const		{ return evictions; }		// textures freed to stay under budget
+	UINT GetBytesResident() const	{ return residency.GetBytesResident(); }	// video memory of the textures loaded
+	UINT GetResidentCount() const	{ return residency.GetResidentCount(); }	// textures loaded
+	UINT GetAssetCount() const		{ return (UINT)entries.size(); }
+
+private:
+	friend class TextureHandle;
+	void AddRef(AssetId id);
+	void Release(AssetId id);
+	bool Load(AssetId id);
+	bool AddPreload(AssetLoad &load);	// create the texture of a decoded file
+	UINT LoadQueued();		// load the queued files the loader will not decode
+	void EnforceBudget();	// evict until within budget
+
+	struct Entry
+	{
+		std::string file;			// as first interned, TextureManager keeps a pointer to it
+		float scale;				// below 1 for a variant
+		TextureManager *texture;	// NULL while not loaded
+		UINT refs;					// handles and pins
+		bool queued;				// waiting for FinishPreloads
+	};
+
+private:
+	Graphics *graphics;
+	AssetLoader *loader;
+	std::vector<Entry*> entries;			// indexed by id - 1
+	std::map<std::string, AssetId> ids;		// by normalized path
+	ResidencyManager residency;
+	std::vector<AssetId> preloads;			// queued, in order
+	UINT loads;
+	UINT hits;
+	UINT misses;
+	UINT prefetches;
+	UINT evictions;
+};
+
+#endif // _TEXTURE_REGISTRY_H_
@@ -0,0 +1,22 @@
+#ifndef _TEXTURE_SINK_H_
+#define _TEXTURE_SINK_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdint.h>
+
+// What the AssetLoader workers decode files into. Graphics decodes into system memory textures;
+// the load benchmark in Spacewar/Tests decodes into plain pixels, without a device.
+class TextureSink
+{
+public:
+	virtual ~TextureSink() {}
+
+	// Called on the loader threads, several at once.
+	// Post: returns the decoded image, owned by the caller, NULL if the file could not be decoded
+	virtual void* DecodeImage(const char *file, uint32_t transcolor) = 0;
+
+	// Free an image from DecodeImage
+	virtual void ReleaseImage(void *image) = 0;
+};
+
+#endif // _TEXTURE_SINK_H_
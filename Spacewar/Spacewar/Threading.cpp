@@ -0,0 +1,313 @@
+#include <limits.h>
+#ifdef _WIN32
+#include <process.h>
+#endif
+
+#include "Threading.h"
+
+#ifdef _WIN32
+
+Lock::Lock()
+{
+	InitializeCriticalSection(&section);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Lock::~Lock()
+{
+	DeleteCriticalSection(&section);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Lock::Enter()
+{
+	EnterCriticalSection(&section);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Lock::Leave()
+{
+	LeaveCriticalSection(&section);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Semaphore::Semaphore()
+	: handle (CreateSemaphore(NULL, 0, LONG_MAX, NULL))
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Semaphore::~Semaphore()
+{
+	if (handle)
+		CloseHandle(handle);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Semaphore::IsCreated() const
+{
+	return handle != NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Semaphore::Release(uint32_t count)
+{
+	ReleaseSemaphore(handle, (LONG)count, NULL);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Semaphore::Wait()
+{
+	WaitForSingleObject(handle, INFINITE);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Signal::Signal()
+	: handle (CreateEvent(NULL, FALSE, FALSE, NULL))
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Signal::~Signal()
+{
+	if (handle)
+		CloseHandle(handle);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Signal::IsCreated() const
+{
+	return handle != NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Signal::Set()
+{
+	SetEvent(handle);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Signal::Wait()
+{
+	WaitForSingleObject(handle, INFINITE);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Thread::Thread()
+	: handle (NULL)
+	, proc (NULL)
+	, param (NULL)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Thread::~Thread()
+{
+	Join();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Thread::Start(void (*p)(void *param), void *pa)
+{
+	Join();
+	proc = p;
+	param = pa;
+	handle = (HANDLE)_beginthreadex(NULL, 0, Run, this, 0, NULL);
+	return handle != NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Thread::Join()
+{
+	if (handle == NULL)
+		return;
+	WaitForSingleObject(handle, INFINITE);
+	CloseHandle(handle);
+	handle = NULL;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+unsigned __stdcall Thread::Run(void *thread)
+{
+	Thread *t = (Thread*)thread;
+	t->proc(t->param);
+	return 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t GetProcessorCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors;
+}
+
+#else
+
+Lock::Lock()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Lock::~Lock()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Lock::Enter()
+{
+	mutex.lock();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Lock::Leave()
+{
+	mutex.unlock();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Semaphore::Semaphore()
+	: count (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Semaphore::~Semaphore()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Semaphore::IsCreated() const
+{
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Semaphore::Release(uint32_t n)
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	count = count > UINT32_MAX - n ? UINT32_MAX : count + n;
+	released.notify_all();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Semaphore::Wait()
+{
+	std::unique_lock<std::mutex> guard(mutex);
+	while (count == 0)
+		released.wait(guard);
+	count--;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Signal::Signal()
+	: set (false)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Signal::~Signal()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Signal::IsCreated() const
+{
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Signal::Set()
+{
+	std::lock_guard<std::mutex> guard(mutex);
+	set = true;
+	changed.notify_one();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Signal::Wait()
+{
+	std::unique_lock<std::mutex> guard(mutex);
+	while (!set)
+		changed.wait(guard);
+	set = false;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Thread::Thread()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Thread::~Thread()
+{
+	Join();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool Thread::Start(void (*proc)(void *param), void *param)
+{
+	Join();
+	try
+	{
+		thread = std::thread(proc, param);
+	}
+	catch (const std::system_error&)
+	{
+		return false;
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void Thread::Join()
+{
+	if (thread.joinable())
+		thread.join();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t GetProcessorCount()
+{
+	uint32_t count = std::thread::hardware_concurrency();
+	return count > 0 ? count : 1;
+}
+
+#endif // _WIN32
@@ -0,0 +1,106 @@
+#ifndef _THREADING_H_
+#define _THREADING_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdint.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// The threading the AssetLoader needs. Win32 on Windows, Visual Studio 2010 has no std::thread,
+// the C++11 thread library elsewhere so the loader also runs in Spacewar/Tests.
+
+// Guards data shared between threads, one thread inside at a time
+class Lock
+{
+public:
+	Lock();
+	~Lock();
+	void Enter();
+	void Leave();
+
+private:
+	Lock(const Lock&);
+	Lock& operator=(const Lock&);
+#ifdef _WIN32
+	CRITICAL_SECTION section;
+#else
+	std::mutex mutex;
+#endif
+};
+
+// Counts releases, each Wait takes one or blocks until there is one
+class Semaphore
+{
+public:
+	Semaphore();
+	~Semaphore();
+	bool IsCreated() const;
+	void Release(uint32_t count);
+	void Wait();
+
+private:
+	Semaphore(const Semaphore&);
+	Semaphore& operator=(const Semaphore&);
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	std::mutex mutex;
+	std::condition_variable released;
+	uint32_t count;
+#endif
+};
+
+// Auto reset event, Wait blocks until Set and clears it again
+class Signal
+{
+public:
+	Signal();
+	~Signal();
+	bool IsCreated() const;
+	void Set();
+	void Wait();
+
+private:
+	Signal(const Signal&);
+	Signal& operator=(const Signal&);
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	std::mutex mutex;
+	std::condition_variable changed;
+	bool set;
+#endif
+};
+
+// Runs proc(param) on a thread of its own
+class Thread
+{
+public:
+	Thread();
+	~Thread();		// joins
+
+	// Post: returns false if the thread could not be created
+	bool Start(void (*proc)(void *param), void *param);
+	void Join();	// wait for proc to return
+
+private:
+	Thread(const Thread&);
+	Thread& operator=(const Thread&);
+#ifdef _WIN32
+	static unsigned __stdcall Run(void *thread);
+	HANDLE handle;
+	void (*proc)(void *param);
+	void *param;
+#else
+	std::thread thread;
+#endif
+};
+
+uint32_t GetProcessorCount();
+
+#endif // _THREADING_H_
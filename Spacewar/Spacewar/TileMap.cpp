@@ -0,0 +1,189 @@
+#include "TileMap.h"
+
+TileMap::TileMap()
+	: graphics (NULL)
+	, tileTypeCount (0)
+	, columnCount (0)
+	, head (0)
+	, left (0.0f)
+	, queueHead (0)
+	, queueCount (0)
+	, fillTile (TileMapNS::EMPTY)
+	, bodyTile (TileMapNS::EMPTY)
+	, tileSize (1.0f)
+	, y (0.0f)
+	, initialized (false)
+{
+	ZeroMemory(tileTypes, sizeof(tileTypes));
+	ZeroMemory(tiles, sizeof(tiles));
+	ZeroMemory(heights, sizeof(heights));
+	ZeroMemory(queue, sizeof(queue));
+	ZeroMemory(queueHeights, sizeof(queueHeights));
+	ZeroMemory(&spriteData, sizeof(spriteData));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TileMap::Initialize(Graphics *g, float size, float top)
+{
+	if (g == NULL || size <= 0.0f)
+		return false;
+
+	// Enough columns to cover the screen while one is partly scrolled out
+	columnCount = (int)(GAME_WIDTH / size) + 2;
+	if (columnCount > TileMapNS::MAX_COLUMNS)
+		return false;
+
+	graphics = g;
+	tileSize = size;
+	y = top;
+	head = 0;
+	left = 0.0f;
+	queueHead = 0;
+	queueCount = 0;
+	initialized = true;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+BYTE TileMap::AddTileType(TextureManager *texture)
+{
+	if (texture == NULL || tileTypeCount >= TileMapNS::MAX_TILE_TYPES)
+		return TileMapNS::EMPTY;
+	tileTypes[tileTypeCount++] = texture;
+	return (BYTE)tileTypeCount;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TileMap::Fill(BYTE tile, float x)
+{
+	for (int i = 0; i < columnCount; ++i)
+	{
+		tiles[i] = tile;
+		heights[i] = 0;
+	}
+	fillTile = tile;
+	head = 0;
+	left = x;
+	queueHead = 0;
+	queueCount = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TileMap::QueueColumn(BYTE tile, BYTE height)
+{
+	if (queueCount >= TileMapNS::QUEUE_SIZE)
+		return false;
+	int slot = (queueHead + queueCount) % TileMapNS::QUEUE_SIZE;
+	queue[slot] = tile;
+	queueHeights[slot] = height;
+	queueCount++;
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TileMap::Follow(float viewLeft)
+{
+	if (!initialized)
+		return;
+
+	while (left + tileSize <= viewLeft)
+	{
+		// Column 0 left the screen, reuse its slot for the column entering on the right
+		left += tileSize;
+		if (queueCount > 0)
+		{
+			tiles[head] = queue[queueHead];
+			heights[head] = queueHeights[queueHead];
+			queueHead = (queueHead + 1) % TileMapNS::QUEUE_SIZE;
+			queueCount--;
+		}
+		else
+		{
+			tiles[head] = fillTile;
+			heights[head] = 0;
+		}
+		head = (head + 1) % columnCount;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TileMap::Draw(COLOR_ARGB color)
+{
+	if (!initialized)
+		return;
+
+	for (int column = 0; column < columnCount; ++column)
+	{
+		int slot = (head + column) % columnCount;
+		float x = GetColumnX(column);
+		DrawTile(tiles[slot], x, y - heights[slot] * tileSize, color);
+		for (int row = 0; row < heights[slot]; ++row)
+			DrawTile(bodyTile, x, y - row * tileSize, color);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TileMap::DrawTile(BYTE tile, float x, float top, COLOR_ARGB color)
+{
+	if (tile == TileMapNS::EMPTY || tile > tileTypeCount)
+		return;
+
+	const TextureManager *texture = tileTypes[tile - 1];
+	spriteData.texture = texture->GetTexture();	// fresh texture in case of device reset
+	spriteData.width = texture->GetWidth();
+	spriteData.height = texture->GetHeight();
+	spriteData.rect.right = spriteData.width;
+	spriteData.rect.bottom = spriteData.height;
+	spriteData.scale = tileSize / spriteData.width;
+	spriteData.x = x;
+	spriteData.y = top;
+	graphics->DrawSprite(spriteData, color);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int TileMap::GetColumnAt(float x) const
+{
+	float position = x - left;
+	if (position < 0.0f)
+		return -1;
+	return (int)(position / tileSize);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+BYTE TileMap::GetTile(int column) const
+{
+	if (column < 0 || column >= columnCount)
+		return TileMapNS::EMPTY;
+	return tiles[(head + column) % columnCount];
+}
+
+//----------------------------------------------------------------------------------------------------
+
+BYTE TileMap::GetHeight(int column) const
+{
+	if (column < 0 || column >= columnCount)
+		return 0;
+	return heights[(head + column) % columnCount];
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool TileMap::IsSolidBetween(float from, float to) const
+{
+	int last = GetColumnAt(to);
+	for (int column = GetColumnAt(from); column <= last; ++column)
+	{
+		if (IsSolid(column))
+			return true;
+	}
+	return false;
+}
@@ -0,0 +1,92 @@
+#ifndef _TILE_MAP_H_
+#define _TILE_MAP_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include "Constants.h"
+#include "Graphics.h"
+#include "TextureManager.h"
+
+namespace TileMapNS
+{
+	const BYTE EMPTY = 0;				// no tile (gap), tile types start at 1
+	const int MAX_TILE_TYPES = 16;
+	const int MAX_COLUMNS = 32;			// ring capacity
+	const int QUEUE_SIZE = 64;			// columns waiting to scroll in
+}
+
+// A single row of tiles in world coordinates, used for the ground.
+// Tiles are stored as a ring buffer of tile ids covering the screen plus the world x of
+// the first one, so following the camera and collision queries only touch the columns
+// involved. Columns entering on the right come from a queue (see QueueColumn), or repeat
+// the fill tile when the queue is empty. A column can be raised by whole rows, its tile is
+// drawn on top and the body tile fills the rows below it.
+class TileMap
+{
+public:
+	TileMap();
+
+	// Pre: tileSize = width and height of a column on screen, y = top of the strip
+	bool Initialize(Graphics *g, float tileSize, float y);
+
+	// Register a tile texture, it is scaled to tileSize when drawn.
+	// Returns the new tile id, or EMPTY if there are too many types.
+	BYTE AddTileType(TextureManager *texture);
+
+	// Set every column and the fill tile to tile, clears the queue. Column 0 starts at world x.
+	void Fill(BYTE tile, float x = 0.0f);
+	void SetFillTile(BYTE tile)				{ fillTile = tile; }
+	void SetBodyTile(BYTE tile)				{ bodyTile = tile; }
+
+	// Append a column to enter from the right, raised by height rows. Returns false if the queue is full.
+	bool QueueColumn(BYTE tile, BYTE height = 0);
+	int GetQueueSpace() const				{ return TileMapNS::QUEUE_SIZE - queueCount; }
+	// World x of the right edge of the last queued column
+	float GetQueueEnd() const				{ return left + (columnCount + queueCount) * tileSize; }
+
+	// Recycle the columns left of the screen edge at world x viewLeft, it only moves right
+	void Follow(float viewLeft);
+	// The world origin moved right by shift, see Camera::Rebase
+	void Rebase(float shift)				{ left -= shift; }
+
+	// Draw the columns as one batch in world coordinates. Call between SpriteBegin/SpriteEnd
+	void Draw(COLOR_ARGB color = GraphicsNS::WHITE);
+
+	// Column queries. Columns are counted from the leftmost one kept (0), positions are world x.
+	int GetColumnAt(float x) const;
+	BYTE GetTile(int column) const;
+	bool IsSolid(int column) const			{ return GetTile(column) != TileMapNS::EMPTY; }
+	BYTE GetHeight(int column) const;
+	float GetColumnTop(int column) const	{ return y - GetHeight(column) * tileSize; }
+	// True if any column between world x from and to is solid
+	bool IsSolidBetween(float from, float to) const;
+	float GetColumnX(int column) const		{ return left + column * tileSize; }
+
+	float GetTop() const					{ return y; }	// of columns that are not raised
+	float GetTileSize() const				{ return tileSize; }
+	int GetColumnCount() const				{ return columnCount; }
+
+private:
+	void DrawTile(BYTE tile, float x, float top, COLOR_ARGB color);
+
+private:
+	Graphics *graphics;
+	TextureManager *tileTypes[TileMapNS::MAX_TILE_TYPES];	// indexed by tile id - 1
+	int tileTypeCount;
+	BYTE tiles[TileMapNS::MAX_COLUMNS];						// ring of tile ids
+	BYTE heights[TileMapNS::MAX_COLUMNS];					// rows raised, same ring
+	int columnCount;
+	int head;												// ring index of column 0
+	float left;												// world x of column 0
+	BYTE queue[TileMapNS::QUEUE_SIZE];
+	BYTE queueHeights[TileMapNS::QUEUE_SIZE];
+	int queueHead;
+	int queueCount;
+	BYTE fillTile;
+	BYTE bodyTile;											// under raised columns
+	float tileSize;
+	float y;
+	SpriteData spriteData;
+	bool initialized;
+};
+
+#endif // _TILE_MAP_H_
@@ -0,0 +1,81 @@
+#include "TimingWheel.h"
+
+TimingWheel::TimingWheel()
+	: now (0)
+	, remainder (0.0f)
+	, count (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TimingWheel::Clear()
+{
+	for (UINT i = 0; i < TimingWheelNS::LEVELS * TimingWheelNS::SLOTS; ++i)
+		slots[i].clear();
+	count = 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TimingWheel::Schedule(int event, float delay)
+{
+	UINT64 ticks = delay > 0.0f ? (UINT64)(delay / TimingWheelNS::TICK + 0.999f) : 1;
+	if (ticks == 0)
+		ticks = 1;
+
+	Timer timer;
+	timer.tick = now + ticks;
+	timer.event = event;
+	Insert(timer);
+	count++;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TimingWheel::Insert(const Timer &timer)
+{
+	// The lowest level whose wheel reaches the tick
+	UINT64 ahead = timer.tick - now;
+	UINT level = 0;
+	while (level + 1 < TimingWheelNS::LEVELS && ahead >= ((UINT64)1 << ((level + 1) * TimingWheelNS::SLOT_BITS)))
+		level++;
+
+	if (level + 1 == TimingWheelNS::LEVELS && ahead >= ((UINT64)1 << (TimingWheelNS::LEVELS * TimingWheelNS::SLOT_BITS)))
+	{
+		// Further than the wheels reach, it comes back up when its slot is moved down
+		Timer capped = timer;
+		Slot(level, now + ((UINT64)1 << (TimingWheelNS::LEVELS * TimingWheelNS::SLOT_BITS)) - 1).push_back(capped);
+		return;
+	}
+	Slot(level, timer.tick).push_back(timer);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TimingWheel::Advance(float frameTime, std::vector<int> &due)
+{
+	remainder += frameTime;
+	while (remainder >= TimingWheelNS::TICK)
+	{
+		remainder -= TimingWheelNS::TICK;
+		now++;
+
+		// Each wheel that turned over brings the next slot of the level above down
+		for (UINT level = 1; level < TimingWheelNS::LEVELS; ++level)
+		{
+			if ((now & (((UINT64)1 << (level * TimingWheelNS::SLOT_BITS)) - 1)) != 0)
+				break;
+			moving.clear();
+			moving.swap(Slot(level, now));
+			for (size_t i = 0; i < moving.size(); ++i)
+				Insert(moving[i]);
+		}
+
+		std::vector<Timer> &slot = Slot(0, now);
+		for (size_t i = 0; i < slot.size(); ++i)
+			due.push_back(slot[i].event);
+		count -= (UINT)slot.size();
+		slot.clear();
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef _TIMING_WHEEL_H_
+#define _TIMING_WHEEL_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+
+#include "Constants.h"
+
+namespace TimingWheelNS
+{
+	const float TICK = 0.01f;		// seconds per tick, events fire on the first tick at or after they are due
+	const UINT SLOT_BITS = 8;
+	const UINT SLOTS = 1 << SLOT_BITS;	// per level
+	const UINT LEVELS = 4;			// reaches 2^32 ticks ahead, later events wait at the top level
+}
+
+// Events due at a later time, kept in hierarchical wheels of slots.
+// Level 0 has one slot per tick, each higher level one slot per turn of the level below.
+// Scheduling is O(1). A tick only looks at the slot of that tick, and on a turn of a wheel
+// moves the next slot of the level above down. The cost of a tick is the number of events
+// due plus what is moved down, however many are waiting. Events are ints chosen by the caller.
+class TimingWheel
+{
+public:
+	TimingWheel();
+
+	void Clear();	// drop every event, the time stays
+
+	// Fire event delay seconds from now, at least one tick from now
+	void Schedule(int event, float delay);
+
+	// Run the clock frameTime seconds forward. Post: the events that came due are appended to due,
+	// in the order of their ticks
+	void Advance(float frameTime, std::vector<int> &due);
+
+	UINT GetCount() const			{ return count; }	// events waiting
+	UINT64 GetTick() const			{ return now; }
+
+private:
+	struct Timer
+	{
+		UINT64 tick;	// due
+		int event;
+	};
+
+	void Insert(const Timer &timer);
+	std::vector<Timer>& Slot(UINT level, UINT64 tick)
+	{
+		return slots[level * TimingWheelNS::SLOTS + (UINT)((tick >> (level * TimingWheelNS::SLOT_BITS)) & (TimingWheelNS::SLOTS - 1))];
+	}
+
+private:
+	std::vector<Timer> slots[TimingWheelNS::LEVELS * TimingWheelNS::SLOTS];
+	std::vector<Timer> moving;		// slot being moved down, reused
+	UINT64 now;						// last tick run
+	float remainder;				// seconds toward the next tick
+	UINT count;
+};
+
+#endif // _TIMING_WHEEL_H_
@@ -0,0 +1,68 @@
+#include "UICounter.h"
+
+UICounter::UICounter()
+	: UINode()
+	, textureManager (NULL)
+	, digitWidth (0)
+	, digitHeight (0)
+	, cols (1)
+	, digits (1)
+	, firstFrame (0)
+	, value (0)
+	, maxValue (9)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool UICounter::Initialize(TextureManager *texture, int dw, int dh, int ncols, int d, int first)
+{
+	if (texture == NULL || dw <= 0 || dh <= 0 || ncols <= 0 || d <= 0 || d > 9)
+		return false;
+
+	textureManager = texture;
+	digitWidth = dw;
+	digitHeight = dh;
+	cols = ncols;
+	digits = d;
+	firstFrame = first;
+	value = 0;
+
+	maxValue = 1;
+	for (int i = 0; i < digits; ++i)
+		maxValue *= 10;
+	maxValue--;
+
+	width = (float)(digitWidth * digits);
+	height = (float)digitHeight;
+	Invalidate();
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UICounter::SetValue(int v)
+{
+	if (v < 0)
+		v = 0;
+	else if (v > maxValue)
+		v = maxValue;
+	if (value == v)
+		return;
+	value = v;
+	Invalidate();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UICounter::DrawSelf(Graphics *g, float screenX, float screenY)
+{
+	// Right to left, one digit per frame
+	int remaining = value;
+	for (int i = digits - 1; i >= 0; --i)
+	{
+		DrawFrame(g, textureManager, cols, digitWidth, digitHeight, firstFrame + remaining % 10,
+			screenX + i * digitWidth, screenY);
+		remaining /= 10;
+	}
+}
@@ -0,0 +1,36 @@
+#ifndef _UICOUNTER_H_
+#define _UICOUNTER_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include "UINode.h"
+
+// A zero padded number drawn with digit frames of a texture.
+// Frames firstFrame to firstFrame + 9 must hold the digits 0 to 9.
+class UICounter : public UINode
+{
+public:
+	UICounter();
+
+	// Pre: texture has ncols frames of digitWidth x digitHeight per row
+	//		digits = number of digits shown, values are clamped to fit
+	bool Initialize(TextureManager *texture, int digitWidth, int digitHeight, int ncols, int digits, int firstFrame = 0);
+
+	void SetValue(int v);
+	int GetValue() const		{ return value; }
+	int GetMaxValue() const		{ return maxValue; }
+
+protected:
+	virtual void DrawSelf(Graphics *g, float screenX, float screenY);
+
+private:
+	TextureManager *textureManager;
+	int digitWidth;
+	int digitHeight;
+	int cols;
+	int digits;
+	int firstFrame;
+	int value;
+	int maxValue;
+};
+
+#endif // _UICOUNTER_H_
@@ -0,0 +1,46 @@
+#include "UIIcon.h"
+
+UIIcon::UIIcon()
+	: UINode()
+	, textureManager (NULL)
+	, frameWidth (0)
+	, frameHeight (0)
+	, cols (1)
+	, frame (0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool UIIcon::Initialize(TextureManager *texture, int fw, int fh, int ncols, int f)
+{
+	if (texture == NULL || fw <= 0 || fh <= 0 || ncols <= 0)
+		return false;
+
+	textureManager = texture;
+	frameWidth = fw;
+	frameHeight = fh;
+	cols = ncols;
+	frame = f;
+	width = (float)fw;
+	height = (float)fh;
+	Invalidate();
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UIIcon::SetFrame(int f)
+{
+	if (frame == f)
+		return;
+	frame = f;
+	Invalidate();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UIIcon::DrawSelf(Graphics *g, float screenX, float screenY)
+{
+	DrawFrame(g, textureManager, cols, frameWidth, frameHeight, frame, screenX, screenY);
+}
@@ -0,0 +1,30 @@
+#ifndef _UIICON_H_
+#define _UIICON_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include "UINode.h"
+
+// One frame of a texture made of equal sized frames, such as the HUD sheet
+class UIIcon : public UINode
+{
+public:
+	UIIcon();
+
+	// Pre: texture has ncols frames of frameWidth x frameHeight per row
+	bool Initialize(TextureManager *texture, int frameWidth, int frameHeight, int ncols, int frame);
+
+	void SetFrame(int f);
+	int GetFrame() const		{ return frame; }
+
+protected:
+	virtual void DrawSelf(Graphics *g, float screenX, float screenY);
+
+private:
+	TextureManager *textureManager;
+	int frameWidth;
+	int frameHeight;
+	int cols;
+	int frame;
+};
+
+#endif // _UIICON_H_
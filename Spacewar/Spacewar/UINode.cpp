@@ -0,0 +1,138 @@
+#include "UINode.h"
+
+UINode::UINode()
+	: parent (NULL)
+	, layout (UINodeNS::FREE)
+	, spacing (0.0f)
+	, x (0.0f)
+	, y (0.0f)
+	, layoutX (0.0f)
+	, layoutY (0.0f)
+	, width (0.0f)
+	, height (0.0f)
+	, visible (true)
+	, dirty (true)
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+UINode::~UINode()
+{
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UINode::AddChild(UINode *child)
+{
+	if (child == NULL)
+		return;
+	child->parent = this;
+	children.push_back(child);
+	Invalidate();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UINode::SetLayout(UINodeNS::LAYOUT l, float s)
+{
+	layout = l;
+	spacing = s;
+	Invalidate();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UINode::SetPosition(float newX, float newY)
+{
+	if (x == newX && y == newY)
+		return;
+	x = newX;
+	y = newY;
+	Invalidate();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UINode::SetVisible(bool v)
+{
+	if (visible == v)
+		return;
+	visible = v;
+	Invalidate();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UINode::Layout(float rootX, float rootY)
+{
+	layoutX = rootX;
+	layoutY = rootY;
+	if (children.empty())
+		return;
+
+	// Containers are as large as the area their children cover
+	float right = 0.0f;
+	float bottom = 0.0f;
+	float cursor = 0.0f;
+	for (size_t i = 0; i < children.size(); ++i)
+	{
+		UINode *child = children[i];
+		float childX = (layout == UINodeNS::ROW) ? cursor : child->x;
+		child->Layout(layoutX + childX, layoutY + child->y);
+
+		// A child container only knows its size after its own layout
+		cursor = childX + child->width + spacing;
+		if (childX + child->width > right)
+			right = childX + child->width;
+		if (child->y + child->height > bottom)
+			bottom = child->y + child->height;
+	}
+	width = right;
+	height = bottom;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UINode::Draw(Graphics *g, float originX, float originY)
+{
+	if (!visible)
+		return;
+
+	DrawSelf(g, originX + layoutX, originY + layoutY);
+	for (size_t i = 0; i < children.size(); ++i)
+		children[i]->Draw(g, originX, originY);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UINode::Invalidate()
+{
+	UINode *root = this;
+	while (root->parent)
+		root = root->parent;
+	root->dirty = true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void UINode::DrawFrame(Graphics *g, TextureManager *texture, int cols, int frameWidth, int frameHeight,
+	int frame, float screenX, float screenY)
+{
+	if (texture == NULL || cols <= 0)
+		return;
+
+	SpriteData spriteData;
+	ZeroMemory(&spriteData, sizeof(spriteData));
+	spriteData.texture = texture->GetTexture();	// fresh texture in case of device reset
+	spriteData.width = frameWidth;
+	spriteData.height = frameHeight;
+	spriteData.x = screenX;
+	spriteData.y = screenY;
+	spriteData.scale = 1.0f;
+	spriteData.rect.left = (frame % cols) * frameWidth;
+	spriteData.rect.top = (frame / cols) * frameHeight;
+	spriteData.rect.right = spriteData.rect.left + frameWidth;
+	spriteData.rect.bottom = spriteData.rect.top + frameHeight;
+	g->DrawSprite(spriteData);
+}
@@ -0,0 +1,72 @@
+#ifndef _UINODE_H_
+#define _UINODE_H_
+#define WIN32_LEAN_AND_MEAN
+
+#include <vector>
+
+#include "Constants.h"
+#include "Graphics.h"
+#include "TextureManager.h"
+
+namespace UINodeNS
+{
+	enum LAYOUT
+	{
+		FREE,	// children are placed at their own position
+		ROW		// children are placed left to right, only their y position is used
+	};
+}
+
+// A node of the retained UI tree.
+// Positions are relative to the parent, Layout resolves them relative to the root.
+// Nodes do not own their children. Any change that affects the look of a node marks the
+// whole tree dirty so the owner (see HudLayer) knows it has to compose it again.
+class UINode
+{
+public:
+	UINode();
+	virtual ~UINode();
+
+	void AddChild(UINode *child);
+	void SetLayout(UINodeNS::LAYOUT l, float s = 0.0f);	// s = space between children of a ROW
+	void SetPosition(float newX, float newY);
+	void SetVisible(bool v);
+
+	// Resolve the position of this node and its children, x/y = position relative to the root
+	void Layout(float rootX, float rootY);
+
+	// Draw this node and its children, originX/originY = where the root is drawn
+	void Draw(Graphics *g, float originX, float originY);
+
+	// Mark the root dirty
+	void Invalidate();
+	bool IsDirty() const			{ return dirty; }
+	void ClearDirty()				{ dirty = false; }
+	float GetWidth() const			{ return width; }
+	float GetHeight() const			{ return height; }
+	bool GetVisible() const			{ return visible; }
+
+protected:
+	// Draw only this node at screen position x, y
+	virtual void DrawSelf(Graphics *g, float screenX, float screenY) {}
+
+	// Draw one frame of a texture made of equal sized frames
+	static void DrawFrame(Graphics *g, TextureManager *texture, int cols, int frameWidth, int frameHeight,
+		int frame, float screenX, float screenY);
+
+protected:
+	UINode *parent;
+	std::vector<UINode*> children;
+	UINodeNS::LAYOUT layout;
+	float spacing;
+	float x;			// position relative to the parent
+	float y;
+	float layoutX;		// position relative to the root, set by Layout
+	float layoutY;
+	float width;		// leaves set their own size, containers get theirs from Layout
+	float height;
+	bool visible;
+	bool dirty;			// only meaningful on the root
+};
+
+#endif // _UINODE_H_
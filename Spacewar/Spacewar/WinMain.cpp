@@ -4,6 +4,7 @@
 #include <Windows.h>
 #include <stdlib.h>				// for detecting memory leaks
 #include <crtdbg.h>				// for detecting memory leaks
+#include <string.h>
 
 #include "GameplayState.h"
 
@@ -32,6 +33,10 @@ int WINAPI WinMain( HINSTANCE hInstance,
 	HWND hwnd = NULL;
 	game = new GameplayState();
 
+	// -headless keeps the window hidden, for stress runs on a build machine
+	if (strstr(lpCmdLine, "-headless") != NULL)
+		nCmdShow = SW_HIDE;
+
 	// Create the window
 	if (!CreateMainWindow(hwnd, hInstance, nCmdShow))
 		return 1;
@@ -39,6 +44,7 @@ int WINAPI WinMain( HINSTANCE hInstance,
 	try 
 	{
 		// Initialize game
+		game->ParseCommandLine(lpCmdLine);
 		game->Initialize(hwnd);
 
 		// Main message loop
@@ -0,0 +1,152 @@
+// Times decoding the startup files on one thread against the AssetLoader threads, the /bench load
+// command without the game or a device:
+//   LoadBenchmark [workers] [rounds]
+// Run from Spacewar/Spacewar, the file names start with ./Assets. The loader decodes through a
+// sink that keeps plain pixels, nothing is uploaded or drawn. Each round decodes every file once,
+// workers 0 = one per core besides the main thread. Fails if the threads decode other pixels.
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "AssetLoader.h"
+#include "BenchmarkFiles.h"
+#include "GameError.h"
+#include "PngDecoder.h"
+
+using namespace BenchmarkFilesNS;
+
+namespace
+{
+	const uint32_t TRANSCOLOR = 0x00ff00ff;		// the game's, magenta with no alpha
+
+	struct Image
+	{
+		uint32_t width;
+		uint32_t height;
+		std::vector<uint32_t> pixels;
+	};
+
+	// The decode Graphics does for a PNG file, into memory instead of a system memory texture
+	class PixelSink : public TextureSink
+	{
+	public:
+		void* DecodeImage(const char *file, uint32_t transcolor)
+		{
+			std::vector<uint8_t> bytes;
+			FILE *fp = fopen(file, "rb");
+			if (fp == NULL)
+				return NULL;
+			fseek(fp, 0, SEEK_END);
+			long size = ftell(fp);
+			fseek(fp, 0, SEEK_SET);
+			bool read = size > 0;
+			if (read)
+			{
+				bytes.resize(size);
+				read = fread(&bytes[0], 1, size, fp) == (size_t)size;
+			}
+			fclose(fp);
+
+			uint32_t width, height;
+			if (!read || !PngDecoder::ReadHeader(&bytes[0], (uint32_t)bytes.size(), width, height))
+				return NULL;
+			Image *image = new Image;
+			image->width = width;
+			image->height = height;
+			image->pixels.resize((size_t)width * height);
+			PngDecoder decoder;
+			if (!decoder.Decode(&bytes[0], (uint32_t)bytes.size(), transcolor, &image->pixels[0], width))
+			{
+				delete image;
+				return NULL;
+			}
+			return image;
+		}
+
+		void ReleaseImage(void *image)
+		{
+			delete (Image*)image;
+		}
+	};
+
+	double GetMs(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	uint32_t Checksum(const Image *image)
+	{
+		uint32_t sum = image->width * 31 + image->height;
+		for (size_t i = 0; i < image->pixels.size(); ++i)
+			sum = sum * 31 + image->pixels[i];
+		return sum;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t workers = argc > 1 ? (uint32_t)atoi(argv[1]) : 0;
+	int rounds = argc > 2 ? atoi(argv[2]) : 5;
+	if (rounds < 1)
+	{
+		printf("usage: LoadBenchmark [workers] [rounds]\n");
+		return 2;
+	}
+
+	PixelSink sink;
+	std::vector<uint32_t> sums(STARTUP_COUNT, 0);
+	int failed = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round)
+	{
+		for (int i = 0; i < STARTUP_COUNT; ++i)
+		{
+			Image *image = (Image*)sink.DecodeImage(STARTUP_FILES[i], TRANSCOLOR);
+			if (image == NULL)
+			{
+				printf("can not decode %s\n", STARTUP_FILES[i]);
+				failed++;
+				continue;
+			}
+			sums[i] = Checksum(image);
+			sink.ReleaseImage(image);
+		}
+	}
+	double serialMs = GetMs(start);
+
+	AssetLoader loader;
+	int differ = 0;
+	double parallelMs = 0.0;
+	try
+	{
+		loader.Initialize(&sink, workers);
+		start = std::chrono::steady_clock::now();
+		for (int round = 0; round < rounds; ++round)
+			for (int i = 0; i < STARTUP_COUNT; ++i)
+				loader.Queue(i, STARTUP_FILES[i], TRANSCOLOR);
+		AssetLoad load;
+		while (loader.Wait(load))
+		{
+			if (load.copy == NULL)
+				failed++;
+			else if (Checksum((const Image*)load.copy) != sums[load.id])
+				differ++;
+			loader.Release(load);
+		}
+		parallelMs = GetMs(start);
+	}
+	catch (const GameError &e)
+	{
+		printf("%s\n", e.what());
+		return 1;
+	}
+	uint32_t threads = loader.GetWorkerCount();
+	loader.Shutdown();
+
+	printf("%d files x %d: 1 thread %.1f ms, %u threads %.1f ms (%.1fx)\n", STARTUP_COUNT, rounds, serialMs, threads, parallelMs,
+		parallelMs > 0.0 ? serialMs / parallelMs : 0.0);
+	if (failed || differ)
+		printf("%d failed, %d differ\n", failed, differ);
+	return failed == 0 && differ == 0 ? 0 : 1;
+}
@@ -0,0 +1,517 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "PngDecoder.h"
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool passed, const char *what)
+	{
+		if (!passed)
+		{
+			printf("FAILED: %s\n", what);
+			failures++;
+		}
+	}
+
+	// PNG color types and filter types
+	const uint8_t GRAY = 0;
+	const uint8_t RGB = 2;
+	const uint8_t PALETTE = 3;
+	const uint8_t GRAY_ALPHA = 4;
+	const uint8_t RGBA = 6;
+	const uint8_t FILTER_NONE = 0;
+	const uint8_t FILTER_PAETH = 4;
+
+	const uint32_t TRANSCOLOR = 0x00ff00ff;		// the game's, magenta with no alpha
+	const uint32_t PAD = 0xdeadbeef;			// past the width of each destination row
+
+	uint32_t Channels(uint8_t colorType)
+	{
+		return colorType == RGBA ? 4 : colorType == RGB ? 3 : colorType == GRAY_ALPHA ? 2 : 1;
+	}
+
+	uint32_t Crc(const uint8_t *data, size_t size)
+	{
+		uint32_t crc = 0xffffffff;
+		for (size_t i = 0; i < size; ++i)
+		{
+			crc ^= data[i];
+			for (int k = 0; k < 8; ++k)
+				crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+		}
+		return ~crc;
+	}
+
+	uint32_t Adler(const std::vector<uint8_t> &data)
+	{
+		uint32_t a = 1, b = 0;
+		for (size_t i = 0; i < data.size(); ++i)
+		{
+			a = (a + data[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		return b << 16 | a;
+	}
+
+	void PutBigEndian(std::vector<uint8_t> &out, uint32_t value)
+	{
+		out.push_back((uint8_t)(value >> 24));
+		out.push_back((uint8_t)(value >> 16));
+		out.push_back((uint8_t)(value >> 8));
+		out.push_back((uint8_t)value);
+	}
+
+	void PutChunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &body)
+	{
+		PutBigEndian(png, (uint32_t)body.size());
+		size_t start = png.size();
+		png.insert(png.end(), type, type + 4);
+		png.insert(png.end(), body.begin(), body.end());
+		PutBigEndian(png, Crc(&png[start], png.size() - start));
+	}
+
+	// zlib stream of stored blocks, blockSize bytes each
+	std::vector<uint8_t> DeflateStored(const std::vector<uint8_t> &raw, size_t blockSize)
+	{
+		std::vector<uint8_t> out;
+		out.push_back(0x78);
+		out.push_back(0x01);
+		size_t offset = 0;
+		do
+		{
+			size_t length = raw.size() - offset < blockSize ? raw.size() - offset : blockSize;
+			out.push_back(offset + length == raw.size() ? 1 : 0);
+			out.push_back((uint8_t)length);
+			out.push_back((uint8_t)(length >> 8));
+			out.push_back((uint8_t)~length);
+			out.push_back((uint8_t)(~length >> 8));
+			out.insert(out.end(), raw.begin() + offset, raw.begin() + offset + length);
+			offset += length;
+		} while (offset < raw.size());
+		PutBigEndian(out, Adler(raw));
+		return out;
+	}
+
+	// Deflate bits are written from the lowest bit of each byte up, Huffman codes from their top bit
+	struct BitWriter
+	{
+		std::vector<uint8_t> out;
+		uint32_t count;
+
+		BitWriter() : count(0) {}
+		void Put(uint32_t value, uint32_t n)
+		{
+			for (uint32_t i = 0; i < n; ++i, ++count)
+			{
+				if (count % 8 == 0)
+					out.push_back(0);
+				out.back() |= (uint8_t)(((value >> i) & 1) << (count % 8));
+			}
+		}
+		void PutCode(uint32_t code, uint32_t n)
+		{
+			for (uint32_t i = n; i-- > 0; )
+				Put(code >> i, 1);
+		}
+		void PutLiteral(uint32_t symbol)
+		{
+			if (symbol < 144)
+				PutCode(0x30 + symbol, 8);
+			else if (symbol < 256)
+				PutCode(0x190 + symbol - 144, 9);
+			else
+				PutCode(symbol - 256, 7);
+		}
+	};
+
+	// zlib stream of one fixed Huffman block, repeated bytes as copies from distance 1
+	std::vector<uint8_t> DeflateFixed(const std::vector<uint8_t> &raw)
+	{
+		BitWriter writer;
+		writer.out.push_back(0x78);
+		writer.out.push_back(0x01);
+		writer.count = 16;
+		writer.Put(1, 1);
+		writer.Put(1, 2);
+		size_t i = 0;
+		while (i < raw.size())
+		{
+			writer.PutLiteral(raw[i]);
+			size_t repeat = 0;
+			while (i + 1 + repeat < raw.size() && raw[i + 1 + repeat] == raw[i] && repeat < 10)
+				repeat++;
+			if (repeat >= 3)
+			{
+				writer.PutLiteral(257 + (uint32_t)repeat - 3);	// lengths 3 to 10 have no extra bits
+				writer.PutCode(0, 5);							// distance 1
+			}
+			else
+				repeat = 0;
+			i += 1 + repeat;
+		}
+		writer.PutLiteral(256);
+		PutBigEndian(writer.out, Adler(raw));
+		return writer.out;
+	}
+
+	std::vector<uint8_t> MakePng(uint32_t width, uint32_t height, uint8_t colorType, const std::vector<uint8_t> &zlib,
+		const std::vector<uint8_t> &palette = std::vector<uint8_t>(), const std::vector<uint8_t> &transparency = std::vector<uint8_t>(),
+		size_t idatSize = 0)
+	{
+		const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		std::vector<uint8_t> png(signature, signature + 8);
+		std::vector<uint8_t> header;
+		PutBigEndian(header, width);
+		PutBigEndian(header, height);
+		header.push_back(8);
+		header.push_back(colorType);
+		header.push_back(0);
+		header.push_back(0);
+		header.push_back(0);
+		PutChunk(png, "IHDR", header);
+		if (!palette.empty())
+			PutChunk(png, "PLTE", palette);
+		if (!transparency.empty())
+			PutChunk(png, "tRNS", transparency);
+
+		// Split across IDAT chunks of idatSize bytes, one chunk if 0
+		size_t step = idatSize ? idatSize : zlib.size();
+		for (size_t offset = 0; offset < zlib.size(); offset += step)
+		{
+			size_t end = offset + step < zlib.size() ? offset + step : zlib.size();
+			PutChunk(png, "IDAT", std::vector<uint8_t>(zlib.begin() + offset, zlib.begin() + end));
+		}
+		PutChunk(png, "IEND", std::vector<uint8_t>());
+		return png;
+	}
+
+	int Paeth(int a, int b, int c)
+	{
+		int pa = b > c ? b - c : c - b;
+		int pb = a > c ? a - c : c - a;
+		int pc = a + b - 2 * c;
+		pc = pc < 0 ? -pc : pc;
+		return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+	}
+
+	// Filtered scanlines of the rows of pixels, each row with filter
+	std::vector<uint8_t> Filter(const std::vector<uint8_t> &pixels, uint32_t width, uint32_t height, uint32_t bpp, const uint8_t *filters)
+	{
+		uint32_t rowBytes = width * bpp;
+		std::vector<uint8_t> out;
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			out.push_back(filters[y]);
+			for (uint32_t x = 0; x < rowBytes; ++x)
+			{
+				int a = x >= bpp ? pixels[y * rowBytes + x - bpp] : 0;
+				int b = y > 0 ? pixels[(y - 1) * rowBytes + x] : 0;
+				int c = x >= bpp && y > 0 ? pixels[(y - 1) * rowBytes + x - bpp] : 0;
+				const int predictors[5] = { 0, a, b, (a + b) >> 1, Paeth(a, b, c) };
+				out.push_back((uint8_t)(pixels[y * rowBytes + x] - predictors[filters[y]]));
+			}
+		}
+		return out;
+	}
+
+	uint32_t ToArgb(uint8_t colorType, const uint8_t *p)
+	{
+		switch (colorType)
+		{
+		case RGBA:			return (uint32_t)p[3] << 24 | (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+		case RGB:			return 0xff000000 | (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+		case GRAY_ALPHA:	return (uint32_t)p[1] << 24 | (uint32_t)p[0] * 0x010101;
+		default:			return 0xff000000 | (uint32_t)p[0] * 0x010101;
+		}
+	}
+
+	// Decode into rows pitch pixels apart, then drop the padding
+	bool Decode(const std::vector<uint8_t> &png, uint32_t transcolor, std::vector<uint32_t> &pixels)
+	{
+		uint32_t width = 0, height = 0;
+		pixels.clear();
+		if (!PngDecoder::ReadHeader(&png[0], (uint32_t)png.size(), width, height))
+			return false;
+		const uint32_t pitch = width + 3;
+		std::vector<uint32_t> dest(pitch * height, PAD);
+		PngDecoder decoder;
+		if (!decoder.Decode(&png[0], (uint32_t)png.size(), transcolor, &dest[0], pitch))
+			return false;
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < pitch; ++x)
+			{
+				if (x < width)
+					pixels.push_back(dest[y * pitch + x]);
+				else if (dest[y * pitch + x] != PAD)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// Rows of no filter
+	std::vector<uint8_t> Unfiltered(const std::vector<uint8_t> &pixels, uint32_t height)
+	{
+		const uint8_t none[16] = { 0 };
+		return Filter(pixels, (uint32_t)pixels.size() / height, height, 1, none);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestColorTypes()
+{
+	std::vector<uint32_t> out;
+
+	const uint8_t gray[] = { 0x00, 0x80, 0xff, 0x10 };
+	const uint32_t grayArgb[] = { 0xff000000, 0xff808080, 0xffffffff, 0xff101010 };
+	std::vector<uint8_t> raw(gray, gray + 4);
+	Check(Decode(MakePng(2, 2, GRAY, DeflateStored(Unfiltered(raw, 2), 1000)), 0, out)
+		&& out == std::vector<uint32_t>(grayArgb, grayArgb + 4), "gray");
+
+	const uint8_t grayAlpha[] = { 0x40, 0xff, 0x80, 0x00, 0xc0, 0x7f };
+	const uint32_t grayAlphaArgb[] = { 0xff404040, 0x00808080, 0x7fc0c0c0 };
+	raw.assign(grayAlpha, grayAlpha + 6);
+	Check(Decode(MakePng(3, 1, GRAY_ALPHA, DeflateStored(Unfiltered(raw, 1), 1000)), 0, out)
+		&& out == std::vector<uint32_t>(grayAlphaArgb, grayAlphaArgb + 3), "gray and alpha");
+
+	const uint8_t rgb[] = { 0x11, 0x22, 0x33, 0xff, 0x00, 0x80 };
+	const uint32_t rgbArgb[] = { 0xff112233, 0xffff0080 };
+	raw.assign(rgb, rgb + 6);
+	Check(Decode(MakePng(1, 2, RGB, DeflateStored(Unfiltered(raw, 2), 1000)), 0, out)
+		&& out == std::vector<uint32_t>(rgbArgb, rgbArgb + 2), "RGB");
+
+	// Five pixels, four converted together and one on its own
+	const uint8_t rgba[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 0xff, 0x80, 0x40, 0x20 };
+	const uint32_t rgbaArgb[] = { 0x04010203, 0x08050607, 0x0c090a0b, 0x100d0e0f, 0x20ff8040 };
+	raw.assign(rgba, rgba + 20);
+	Check(Decode(MakePng(5, 1, RGBA, DeflateStored(Unfiltered(raw, 1), 1000)), 0, out)
+		&& out == std::vector<uint32_t>(rgbaArgb, rgbaArgb + 5), "RGBA");
+
+	// Entries past the palette are opaque black, past tRNS opaque
+	const uint8_t indices[] = { 0, 1, 2, 3 };
+	const uint8_t plte[] = { 0xff, 0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0xff };
+	const uint8_t trns[] = { 0x00, 0x80 };
+	const uint32_t paletteArgb[] = { 0x00ff0000, 0x8000ff00, 0xff0000ff, 0xff000000 };
+	raw.assign(indices, indices + 4);
+	Check(Decode(MakePng(4, 1, PALETTE, DeflateStored(Unfiltered(raw, 1), 1000), std::vector<uint8_t>(plte, plte + 9),
+		std::vector<uint8_t>(trns, trns + 2)), 0, out) && out == std::vector<uint32_t>(paletteArgb, paletteArgb + 4), "palette");
+
+	// tRNS of gray and RGB images is a 16 bit color made transparent
+	const uint8_t grayKey[] = { 0x00, 0x80 };
+	const uint32_t grayKeyed[] = { 0xff000000, 0x00808080, 0xffffffff, 0xff101010 };
+	raw.assign(gray, gray + 4);
+	Check(Decode(MakePng(2, 2, GRAY, DeflateStored(Unfiltered(raw, 2), 1000), std::vector<uint8_t>(),
+		std::vector<uint8_t>(grayKey, grayKey + 2)), 0, out) && out == std::vector<uint32_t>(grayKeyed, grayKeyed + 4), "gray tRNS");
+
+	const uint8_t rgbKey[] = { 0x00, 0xff, 0x00, 0x00, 0x00, 0x80 };
+	const uint32_t rgbKeyed[] = { 0xff112233, 0x00ff0080 };
+	raw.assign(rgb, rgb + 6);
+	Check(Decode(MakePng(1, 2, RGB, DeflateStored(Unfiltered(raw, 2), 1000), std::vector<uint8_t>(),
+		std::vector<uint8_t>(rgbKey, rgbKey + 6)), 0, out) && out == std::vector<uint32_t>(rgbKeyed, rgbKeyed + 2), "RGB tRNS");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestFilters()
+{
+	// Rows of every filter in every color type, wide enough for the 16 byte up filter loop
+	const uint32_t width = 7, height = 10;
+	const uint8_t filters[height] = { 0, 1, 2, 3, 4, 4, 3, 2, 1, 4 };
+	const uint8_t colorTypes[] = { GRAY, GRAY_ALPHA, RGB, RGBA };
+	for (int t = 0; t < 4; ++t)
+	{
+		uint32_t bpp = Channels(colorTypes[t]);
+		std::vector<uint8_t> pixels(width * height * bpp);
+		uint32_t seed = 12345;
+		for (size_t i = 0; i < pixels.size(); ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			pixels[i] = (uint8_t)(seed >> 16);
+		}
+
+		std::vector<uint32_t> expected;
+		for (uint32_t i = 0; i < width * height; ++i)
+			expected.push_back(ToArgb(colorTypes[t], &pixels[i * bpp]));
+
+		std::vector<uint32_t> out;
+		std::vector<uint8_t> scanlines = Filter(pixels, width, height, bpp, filters);
+		char what[64];
+		sprintf(what, "filters of color type %d", colorTypes[t]);
+		Check(Decode(MakePng(width, height, colorTypes[t], DeflateStored(scanlines, 1000)), 0, out) && out == expected, what);
+
+		// Each filter on its own, from the first row
+		for (uint8_t filter = FILTER_NONE; filter <= FILTER_PAETH; ++filter)
+		{
+			const uint8_t same[height] = { filter, filter, filter, filter, filter, filter, filter, filter, filter, filter };
+			sprintf(what, "filter %d of color type %d", filter, colorTypes[t]);
+			Check(Decode(MakePng(width, height, colorTypes[t], DeflateStored(Filter(pixels, width, height, bpp, same), 1000)), 0, out)
+				&& out == expected, what);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestDeflate()
+{
+	// Runs of a color and its rows repeated, as fixed Huffman copies
+	const uint32_t width = 16, height = 6;
+	std::vector<uint8_t> pixels;
+	for (uint32_t i = 0; i < width * height; ++i)
+	{
+		const uint8_t color[4] = { (uint8_t)(i / 20 * 40), 0x80, 0x80, 0xff };
+		pixels.insert(pixels.end(), color, color + 4);
+	}
+	std::vector<uint32_t> expected;
+	for (uint32_t i = 0; i < width * height; ++i)
+		expected.push_back(ToArgb(RGBA, &pixels[i * 4]));
+	const uint8_t filters[height] = { 0, 1, 2, 2, 3, 4 };
+	std::vector<uint8_t> scanlines = Filter(pixels, width, height, 4, filters);
+
+	std::vector<uint32_t> out;
+	Check(Decode(MakePng(width, height, RGBA, DeflateFixed(scanlines)), 0, out) && out == expected, "fixed Huffman");
+	Check(Decode(MakePng(width, height, RGBA, DeflateStored(scanlines, 50)), 0, out) && out == expected, "several stored blocks");
+	Check(Decode(MakePng(width, height, RGBA, DeflateFixed(scanlines), std::vector<uint8_t>(), std::vector<uint8_t>(), 7), 0, out)
+		&& out == expected, "split across IDAT chunks");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestDamaged()
+{
+	const uint32_t width = 5, height = 4;
+	std::vector<uint8_t> pixels(width * height * 3);
+	for (size_t i = 0; i < pixels.size(); ++i)
+		pixels[i] = (uint8_t)(i * 13);
+	const uint8_t filters[height] = { 1, 2, 3, 4 };
+	std::vector<uint8_t> scanlines = Filter(pixels, width, height, 3, filters);
+	std::vector<uint8_t> good = MakePng(width, height, RGB, DeflateFixed(scanlines));
+	std::vector<uint32_t> out;
+	Check(Decode(good, 0, out), "undamaged file decodes");
+
+	// Cut anywhere before the end of the image data, only IEND may be missing
+	bool cutsRejected = true;
+	for (size_t size = 0; size < good.size() - 12; ++size)
+	{
+		std::vector<uint8_t> cut(good.begin(), good.begin() + size);
+		std::vector<uint32_t> dest(width * height);
+		PngDecoder decoder;
+		cutsRejected = cutsRejected && (cut.empty() || !decoder.Decode(&cut[0], (uint32_t)cut.size(), 0, &dest[0], width));
+	}
+	Check(cutsRejected, "truncated files rejected");
+	Check(PngDecoder().Decode(&good[0], (uint32_t)good.size(), 0, NULL, width) == false, "no destination");
+
+	std::vector<uint8_t> bad = good;
+	bad[1] = 'Q';
+	Check(!Decode(bad, 0, out), "bad signature");
+
+	// Header fields the decoder does not handle, the header is at byte 16
+	const size_t fields[] = { 24, 25, 26, 27, 28 };
+	const uint8_t values[] = { 16, 5, 1, 1, 1 };
+	for (int i = 0; i < 5; ++i)
+	{
+		bad = good;
+		bad[fields[i]] = values[i];
+		Check(!Decode(bad, 0, out), "header field not handled");
+	}
+	bad = good;
+	bad[16] = bad[17] = bad[18] = bad[19] = 0;
+	Check(!Decode(bad, 0, out), "zero width");
+	bad[18] = 0x40;
+	bad[19] = 0x01;
+	Check(!Decode(bad, 0, out), "too wide");
+
+	// More rows than the data holds
+	bad = good;
+	bad[23] = height + 1;
+	Check(!Decode(bad, 0, out), "image data short");
+
+	// A filter type past Paeth
+	std::vector<uint8_t> badFilter = scanlines;
+	badFilter[0] = 5;
+	Check(!Decode(MakePng(width, height, RGB, DeflateStored(badFilter, 1000)), 0, out), "unknown filter");
+
+	// Damaged zlib streams: the header, a stored length and its complement, the reserved block type
+	std::vector<uint8_t> zlib = DeflateStored(scanlines, 1000);
+	zlib[0] = 0x79;
+	Check(!Decode(MakePng(width, height, RGB, zlib), 0, out), "bad zlib header");
+	zlib = DeflateStored(scanlines, 1000);
+	zlib[5]++;
+	Check(!Decode(MakePng(width, height, RGB, zlib), 0, out), "stored length mismatch");
+	zlib = DeflateStored(scanlines, 1000);
+	zlib[2] = 0x07;
+	Check(!Decode(MakePng(width, height, RGB, zlib), 0, out), "reserved block type");
+
+	// A copy from before the start
+	BitWriter writer;
+	writer.out.push_back(0x78);
+	writer.out.push_back(0x01);
+	writer.count = 16;
+	writer.Put(1, 1);
+	writer.Put(1, 2);
+	writer.PutLiteral(257);
+	writer.PutCode(0, 5);
+	writer.PutLiteral(256);
+	Check(!Decode(MakePng(1, 1, GRAY, writer.out), 0, out), "copy from before the start");
+
+	// Chunk length past the end of the file
+	bad = good;
+	bad[33] = 0x7f;
+	Check(!Decode(bad, 0, out), "chunk longer than the file");
+
+	// No image data
+	std::vector<uint8_t> empty = MakePng(width, height, RGB, std::vector<uint8_t>());
+	Check(!Decode(empty, 0, out), "no IDAT");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestColorKey()
+{
+	// Pixels equal to transcolor in all four channels become transparent black, in the four
+	// pixel conversion (the first four) and the one at a time one (the last)
+	const uint8_t rgba[] = { 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0xff, 0x00, 0x00, 0x00, 0xff, 0x12, 0x34, 0x56, 0x78,
+		0xff, 0x00, 0xff, 0x00 };
+	std::vector<uint8_t> raw(rgba, rgba + 20);
+	std::vector<uint8_t> png = MakePng(5, 1, RGBA, DeflateStored(Unfiltered(raw, 1), 1000));
+	std::vector<uint32_t> out;
+	const uint32_t keyed[] = { 0x00000000, 0xffff00ff, 0xff000000, 0x78123456, 0x00000000 };
+	Check(Decode(png, TRANSCOLOR, out) && out == std::vector<uint32_t>(keyed, keyed + 5), "magenta with no alpha keyed");
+
+	// 0 is no key
+	const uint32_t plain[] = { 0x00ff00ff, 0xffff00ff, 0xff000000, 0x78123456, 0x00ff00ff };
+	Check(Decode(png, 0, out) && out == std::vector<uint32_t>(plain, plain + 5), "no key");
+
+	// Opaque colors are keyed too, in every color type
+	Check(Decode(png, 0xffff00ff, out) && out[1] == 0 && out[0] == 0x00ff00ff, "opaque key");
+	const uint8_t gray[] = { 0x80, 0x81 };
+	raw.assign(gray, gray + 2);
+	Check(Decode(MakePng(2, 1, GRAY, DeflateStored(Unfiltered(raw, 1), 1000)), 0xff808080, out)
+		&& out[0] == 0 && out[1] == 0xff818181, "gray keyed");
+	const uint8_t indices[] = { 0, 1 };
+	const uint8_t plte[] = { 0xff, 0x00, 0xff, 0x00, 0x00, 0x00 };
+	raw.assign(indices, indices + 2);
+	Check(Decode(MakePng(2, 1, PALETTE, DeflateStored(Unfiltered(raw, 1), 1000), std::vector<uint8_t>(plte, plte + 6)), 0xffff00ff, out)
+		&& out[0] == 0 && out[1] == 0xff000000, "palette keyed");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int main()
+{
+	TestColorTypes();
+	TestFilters();
+	TestDeflate();
+	TestDamaged();
+	TestColorKey();
+
+	if (failures == 0)
+		printf("PngDecoder: all tests passed\n");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+#include <stdio.h>
+
+#include "ResidencyManager.h"
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool passed, const char *what)
+	{
+		if (!passed)
+		{
+			printf("FAILED: %s\n", what);
+			failures++;
+		}
+	}
+
+	// Evict like TextureRegistry::EnforceBudget, returns the number evicted
+	int Evict(ResidencyManager &residency, unsigned int *evicted = NULL)
+	{
+		int count = 0;
+		unsigned int id;
+		while (residency.NextEviction(id))
+		{
+			residency.Remove(id);
+			if (evicted)
+				evicted[count] = id;
+			count++;
+		}
+		return count;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestHitAndMiss()
+{
+	ResidencyManager residency;
+	residency.SetBudget(100);
+	Check(!residency.IsResident(1), "miss before add");
+	Check(!residency.IsResident(1000), "miss past the last slot");
+
+	residency.Add(1, 40);
+	Check(residency.IsResident(1), "hit after add");
+	Check(residency.GetBytesResident() == 40, "bytes after add");
+	Check(residency.GetResidentCount() == 1, "count after add");
+
+	// Added again after a reload, counted once
+	residency.Add(1, 30);
+	Check(residency.GetBytesResident() == 30, "bytes after re-add");
+	Check(residency.GetResidentCount() == 1, "count after re-add");
+
+	residency.Remove(1);
+	Check(!residency.IsResident(1), "miss after remove");
+	Check(residency.GetBytesResident() == 0 && residency.GetResidentCount() == 0, "empty after remove");
+	residency.Remove(1);
+	Check(residency.GetResidentCount() == 0, "second remove ignored");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestLruOrder()
+{
+	ResidencyManager residency;
+	residency.SetBudget(1000);
+	for (unsigned int id = 1; id <= 4; ++id)
+		residency.Add(id, 100);
+	residency.Touch(1);		// 2 3 4 1
+
+	unsigned int evicted[4];
+	residency.SetBudget(0);
+	Check(Evict(residency, evicted) == 4, "all evicted at budget 0");
+	Check(evicted[0] == 2 && evicted[1] == 3 && evicted[2] == 4 && evicted[3] == 1, "least recently used first");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestUnderBudget()
+{
+	ResidencyManager residency;
+	residency.SetBudget(250);
+	for (unsigned int id = 1; id <= 5; ++id)
+	{
+		residency.Add(id, 100);
+		Evict(residency);
+		Check(residency.GetBytesResident() <= residency.GetBudget(), "within budget after each add");
+	}
+	Check(residency.GetResidentCount() == 2, "two fit the budget");
+	Check(residency.IsResident(4) && residency.IsResident(5), "the last two are kept");
+
+	unsigned int id;
+	Check(!residency.NextEviction(id), "nothing to evict within budget");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestInUseNeverEvicted()
+{
+	ResidencyManager residency;
+	residency.SetBudget(1000);
+	residency.Add(1, 100);
+	residency.Add(2, 100);
+	residency.Add(3, 100);
+	residency.SetInUse(1, true);
+	residency.SetInUse(3, true);
+	residency.Touch(1);		// ignored while in use
+
+	unsigned int evicted[3];
+	residency.SetBudget(0);
+	Check(Evict(residency, evicted) == 1 && evicted[0] == 2, "only the texture not in use is evicted");
+	Check(residency.IsResident(1) && residency.IsResident(3), "in use kept over budget");
+	Check(residency.IsInUse(1) && residency.IsInUse(3), "still in use");
+
+	// Once let go it counts as just used and can be evicted again
+	residency.SetInUse(3, false);
+	residency.SetInUse(1, false);
+	Check(Evict(residency, evicted) == 2 && evicted[0] == 3 && evicted[1] == 1, "evicted in the order let go");
+
+	// In use before it was added, like a pinned texture still loading
+	residency.SetInUse(4, true);
+	Check(!residency.IsInUse(4), "in use ignored before add");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int main()
+{
+	TestHitAndMiss();
+	TestLruOrder();
+	TestUnderBudget();
+	TestInUseNeverEvicted();
+
+	if (failures == 0)
+		printf("ResidencyManager: all tests passed\n");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "ShadowCache.h"
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool passed, const char *what)
+	{
+		if (!passed)
+		{
+			printf("FAILED: %s\n", what);
+			failures++;
+		}
+	}
+
+	const uint32_t CLEAR = 0x00000000;
+	const uint32_t RED = 0xffff0000;
+	const uint32_t BLUE = 0xff0000ff;
+	const uint32_t PAD = 0xdeadbeef;	// between the rows of a pitch wider than the image
+
+	// width x height pixels rows pitch apart, the pitch padding set to PAD
+	std::vector<uint32_t> MakeImage(uint32_t pitch, uint32_t width, uint32_t height, uint32_t (*pixel)(uint32_t x, uint32_t y))
+	{
+		std::vector<uint32_t> image(pitch * height, PAD);
+		for (uint32_t y = 0; y < height; ++y)
+			for (uint32_t x = 0; x < width; ++x)
+				image[y * pitch + x] = pixel(x, y);
+		return image;
+	}
+
+	bool SamePixels(const uint32_t *a, uint32_t pitchA, const uint32_t *b, uint32_t pitchB, uint32_t width, uint32_t height)
+	{
+		for (uint32_t y = 0; y < height; ++y)
+			if (memcmp(a + y * pitchA, b + y * pitchB, width * sizeof(uint32_t)) != 0)
+				return false;
+		return true;
+	}
+
+	// Flat art: a clear border around a red block, runs go on across row ends
+	uint32_t Sprite(uint32_t x, uint32_t y)			{ return x >= 2 && x < 6 && y >= 1 && y < 4 ? RED : CLEAR; }
+	// Every pixel different, does not pack
+	uint32_t Noise(uint32_t x, uint32_t y)			{ return 0xff000000 | (x * 7919 + y * 104729); }
+	uint32_t Flat(uint32_t, uint32_t)				{ return BLUE; }
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestPackRoundTrip()
+{
+	// pitch 11 for a width of 8, runs cross the row ends
+	const uint32_t pitch = 11, width = 8, height = 5;
+	std::vector<uint32_t> image = MakeImage(pitch, width, height, Sprite);
+	std::vector<uint32_t> runs;
+	uint32_t used = ShadowCache::Pack(&image[0], pitch, width, height, runs, width * height);
+	Check(used > 0 && used == runs.size(), "sprite packs");
+	Check(runs[0] == width + 2 && runs[1] == CLEAR, "first run crosses the row end");
+
+	// Unpacked at another pitch, the padding is left alone
+	const uint32_t destPitch = 13;
+	std::vector<uint32_t> dest(destPitch * height, PAD);
+	ShadowCache::Unpack(&runs[0], runs.size(), &dest[0], destPitch, width);
+	Check(SamePixels(&image[0], pitch, &dest[0], destPitch, width, height), "sprite round trip");
+	bool padKept = true;
+	for (uint32_t y = 0; y < height; ++y)
+		for (uint32_t x = width; x < destPitch; ++x)
+			padKept = padKept && dest[y * destPitch + x] == PAD;
+	Check(padKept, "unpack writes only width pixels a row");
+
+	// Runs longer than MAX_RUN are split
+	const uint32_t bigWidth = 300, bigHeight = 500;
+	std::vector<uint32_t> flat = MakeImage(bigWidth, bigWidth, bigHeight, Flat);
+	used = ShadowCache::Pack(&flat[0], bigWidth, bigWidth, bigHeight, runs, 16);
+	uint32_t total = bigWidth * bigHeight;
+	uint32_t runsNeeded = (total + ShadowCacheNS::MAX_RUN - 1) / ShadowCacheNS::MAX_RUN;
+	Check(used == runsNeeded * 2, "long run split at MAX_RUN");
+	Check(runs[0] == ShadowCacheNS::MAX_RUN && runs[used - 2] == total - (runsNeeded - 1) * ShadowCacheNS::MAX_RUN, "split lengths");
+	std::vector<uint32_t> bigDest(total, PAD);
+	ShadowCache::Unpack(&runs[0], runs.size(), &bigDest[0], bigWidth, bigWidth);
+	Check(bigDest == flat, "split run round trip");
+
+	// Gives up past the limit
+	std::vector<uint32_t> noise = MakeImage(width, width, height, Noise);
+	Check(ShadowCache::Pack(&noise[0], width, width, height, runs, width * height) == 0 && runs.empty(), "noise over the limit");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestStoreRestore()
+{
+	const uint32_t pitch = 10, width = 8, height = 5;
+	std::vector<uint32_t> sprite = MakeImage(pitch, width, height, Sprite);
+	std::vector<uint32_t> noise = MakeImage(pitch, width, height, Noise);
+
+	ShadowCache cache;
+	Check(cache.Store("sprite", &sprite[0], pitch, width, height), "sprite stored");
+	Check(cache.Store("noise", &noise[0], pitch, width, height), "noise stored");
+	Check(cache.GetCount() == 2, "two kept");
+	Check(cache.GetBytesUnpacked() == 2 * width * height * sizeof(uint32_t), "unpacked bytes");
+	Check(cache.GetBytesHeld() < cache.GetBytesUnpacked(), "sprite kept packed");
+
+	uint32_t w = 0, h = 0;
+	Check(cache.GetSize("sprite", w, h) && w == width && h == height, "size kept");
+	std::vector<uint32_t> dest(pitch * height, PAD);
+	Check(cache.Restore("sprite", &dest[0], pitch) && SamePixels(&sprite[0], pitch, &dest[0], pitch, width, height), "packed restore");
+	Check(cache.Restore("noise", &dest[0], pitch) && SamePixels(&noise[0], pitch, &dest[0], pitch, width, height), "plain restore");
+	Check(!cache.Restore("missing", &dest[0], pitch), "missing not restored");
+	Check(cache.GetRestores() == 2, "restores counted");
+
+	// Counts go back to what the other copy takes
+	uint32_t noiseBytes = width * height * sizeof(uint32_t);
+	cache.Remove("sprite");
+	Check(!cache.Contains("sprite") && cache.GetCount() == 1, "sprite removed");
+	Check(cache.GetBytesHeld() == noiseBytes && cache.GetBytesUnpacked() == noiseBytes, "bytes after remove");
+	cache.Remove("sprite");
+	Check(cache.GetBytesHeld() == noiseBytes, "second remove ignored");
+	cache.Clear();
+	Check(cache.GetCount() == 0 && cache.GetBytesHeld() == 0 && cache.GetBytesUnpacked() == 0, "empty after clear");
+
+	// Without packing the sprite is kept plain
+	cache.SetPacking(false);
+	Check(cache.Store("sprite", &sprite[0], pitch, width, height) && cache.GetBytesHeld() == noiseBytes, "plain when packing is off");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestCapacity()
+{
+	const uint32_t width = 8, height = 4;
+	const uint32_t bytes = width * height * sizeof(uint32_t);
+	std::vector<uint32_t> noise = MakeImage(width, width, height, Noise);
+	std::vector<uint32_t> big = MakeImage(width, width, height * 2, Noise);
+
+	ShadowCache cache;
+	cache.SetCapacity(bytes * 2);
+	Check(cache.Store("a", &noise[0], width, width, height), "first fits");
+	Check(cache.Store("b", &noise[0], width, width, height), "second fits");
+	Check(!cache.Store("c", &noise[0], width, width, height), "third over capacity");
+	Check(cache.GetRejected() == 1 && !cache.Contains("c") && cache.GetBytesHeld() == bytes * 2, "rejected copy not kept");
+
+	// Replacing a copy counts only the difference
+	Check(cache.Store("a", &noise[0], width, width, height), "same size replaces");
+	Check(cache.GetBytesHeld() == bytes * 2 && cache.GetCount() == 2, "bytes after replace");
+
+	// A replacement that does not fit leaves the old copy kept
+	Check(!cache.Store("a", &big[0], width, width, height * 2), "larger replacement rejected");
+	Check(cache.Contains("a") && cache.GetBytesHeld() == bytes * 2, "old copy kept after a rejected replace");
+	std::vector<uint32_t> dest(width * height, PAD);
+	uint32_t w = 0, h = 0;
+	Check(cache.GetSize("a", w, h) && h == height, "old size kept");
+	Check(cache.Restore("a", &dest[0], width) && dest == noise, "old pixels kept");
+
+	cache.Remove("b");
+	Check(cache.Store("a", &big[0], width, width, height * 2), "larger replacement fits once there is room");
+	Check(cache.GetBytesHeld() == bytes * 2 && cache.GetCount() == 1, "bytes after the larger replace");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int main()
+{
+	TestPackRoundTrip();
+	TestStoreRestore();
+	TestCapacity();
+
+	if (failures == 0)
+		printf("ShadowCache: all tests passed\n");
+	return failures == 0 ? 0 : 1;
+}
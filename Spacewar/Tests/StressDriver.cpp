@@ -0,0 +1,155 @@
+// Runs the stress mode without the game or a device, for scaling curves on any machine:
+//   StressDriver <spawns per second> <seconds> <log.csv> [enemy share] [fly share]
+// Entities are spawned by StressTest at the rate and scroll across a screen wide world.
+// Each simulated frame moves them, tests them against the player and culls them to the screen,
+// the same three sections the game times. Frames are simulated at 64 a second, a step that
+// adds up exactly in float, so each report covers the same frames. A run takes as long as the work does,
+// not as long as the seconds asked for.
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "StressTest.h"
+
+namespace
+{
+	const float FRAME_TIME = 1.0f / 64.0f;
+	const float WIDTH = 1440.0f;						// GAME_WIDTH
+	const float SIZE = 64.0f;							// entity size
+	const float SPEED = (WIDTH + SIZE) / StressTestNS::LIFETIME;	// the slowest scroll
+	const float PLAYER_X = WIDTH / 3.0f;
+	const float PLAYER_Y = 600.0f;
+	const float RADIUS = 32.0f;
+
+	struct Body
+	{
+		float x;
+		float y;
+		bool active;
+	};
+
+	long long Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Activate count free bodies of pool at the right edge
+	void Spawn(std::vector<Body> &pool, int count, float y)
+	{
+		for (size_t i = 0; i < pool.size() && count > 0; ++i)
+		{
+			if (pool[i].active)
+				continue;
+			pool[i].x = WIDTH;
+			pool[i].y = y;
+			pool[i].active = true;
+			count--;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 4)
+	{
+		printf("usage: StressDriver <spawns per second> <seconds> <log.csv> [enemy share] [fly share]\n");
+		return 2;
+	}
+	float rate = (float)atof(argv[1]);
+	float seconds = (float)atof(argv[2]);
+	float enemyShare = argc > 4 ? (float)atof(argv[4]) : 0.5f;
+	float flyShare = argc > 5 ? (float)atof(argv[5]) : 0.5f;
+
+	StressTest stress;
+	stress.Start(rate, enemyShare, flyShare);
+	stress.SetDuration(seconds);
+	if (!stress.IsRunning() || seconds <= 0.0f)
+	{
+		printf("rate and seconds must be above 0\n");
+		return 2;
+	}
+	if (!stress.OpenLog(argv[3]))
+	{
+		printf("can not create %s\n", argv[3]);
+		return 1;
+	}
+
+	Body none = { 0.0f, 0.0f, false };
+	std::vector<Body> pools[3];
+	pools[0].resize(stress.GetSpinnerPool(), none);
+	pools[1].resize(stress.GetFlyPool(), none);
+	pools[2].resize(stress.GetPickupPool(), none);
+	const float heights[3] = { PLAYER_Y, PLAYER_Y - 96.0f, PLAYER_Y - 48.0f };
+
+	const long long frequency = 1000000000;	// ticks are nanoseconds
+	std::vector<const Body*> visible;
+	float spawnTime = 0.0f;
+	int hits = 0;
+	while (!stress.IsFinished())
+	{
+		// Tick: spawn batches and move
+		long long start = Now();
+		spawnTime += FRAME_TIME;
+		while (spawnTime >= StressTestNS::SPAWN_INTERVAL)
+		{
+			spawnTime -= StressTestNS::SPAWN_INTERVAL;
+			int counts[3];
+			stress.TakeBatch(counts[0], counts[1], counts[2]);
+			for (int p = 0; p < 3; ++p)
+				Spawn(pools[p], counts[p], heights[p]);
+		}
+		int entities = 0;
+		for (int p = 0; p < 3; ++p)
+		{
+			for (size_t i = 0; i < pools[p].size(); ++i)
+			{
+				Body &body = pools[p][i];
+				if (!body.active)
+					continue;
+				body.x -= SPEED * FRAME_TIME;
+				body.active = body.x > -SIZE;
+				entities += body.active;
+			}
+		}
+		long long end = Now();
+		stress.AddTime(StressTestNS::TICK, end - start);
+
+		// Collisions: every active body against the player
+		start = end;
+		for (int p = 0; p < 3; ++p)
+		{
+			for (size_t i = 0; i < pools[p].size(); ++i)
+			{
+				const Body &body = pools[p][i];
+				float dx = body.x - PLAYER_X;
+				float dy = body.y - PLAYER_Y;
+				hits += body.active && dx * dx + dy * dy < 4.0f * RADIUS * RADIUS;
+			}
+		}
+		end = Now();
+		stress.AddTime(StressTestNS::COLLISIONS, end - start);
+
+		// Render: the draw list culled to the screen
+		start = end;
+		visible.clear();
+		for (int p = 0; p < 3; ++p)
+		{
+			for (size_t i = 0; i < pools[p].size(); ++i)
+			{
+				const Body &body = pools[p][i];
+				if (body.active && body.x < WIDTH && body.x + SIZE > 0.0f)
+					visible.push_back(&body);
+			}
+		}
+		end = Now();
+		stress.AddTime(StressTestNS::RENDER, end - start);
+
+		stress.EndFrame(FRAME_TIME, entities, frequency);
+	}
+	stress.Stop();
+
+	printf("%s (%d hits, %d drawn last frame)\n", stress.GetReport(), hits, (int)visible.size());
+	return 0;
+}
@@ -0,0 +1,141 @@
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "StressTest.h"
+
+namespace
+{
+	int failures = 0;
+
+	void Check(bool passed, const char *what)
+	{
+		if (!passed)
+		{
+			printf("FAILED: %s\n", what);
+			failures++;
+		}
+	}
+
+	// Ends frames of frameTime until one report was made
+	void RunReport(StressTest &stress, float frameTime, int entities, long long ticks, long long frequency)
+	{
+		int frames = (int)(StressTestNS::REPORT_INTERVAL / frameTime + 0.5f);
+		for (int i = 0; i < frames; ++i)
+		{
+			stress.AddTime(StressTestNS::TICK, ticks);
+			stress.AddTime(StressTestNS::COLLISIONS, ticks);
+			stress.AddTime(StressTestNS::RENDER, ticks);
+			stress.EndFrame(frameTime, entities, frequency);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestBatches()
+{
+	StressTest stress;
+	Check(!stress.IsRunning(), "stopped until started");
+
+	// 100 a second is 5 a batch: a quarter spinners, a quarter flies, half pickups
+	stress.Start(100.0f);
+	Check(stress.IsRunning(), "running after start");
+	int totals[3] = { 0, 0, 0 };
+	for (int i = 0; i < 4; ++i)
+	{
+		int spinners, flies, pickups;
+		stress.TakeBatch(spinners, flies, pickups);
+		totals[0] += spinners;
+		totals[1] += flies;
+		totals[2] += pickups;
+	}
+	Check(totals[0] == 5 && totals[1] == 5 && totals[2] == 10, "fractions carry over between batches");
+
+	// Pools hold what lives LIFETIME seconds, plus one
+	Check(stress.GetSpinnerPool() == 126 && stress.GetFlyPool() == 126 && stress.GetPickupPool() == 251, "pool sizes");
+	stress.Start(1000000.0f);
+	Check(stress.GetPickupPool() == StressTestNS::MAX_POOL, "pools are capped");
+
+	// Shares are clamped, all enemies and no flies
+	stress.Start(100.0f, 2.0f, -1.0f);
+	int spinners, flies, pickups;
+	stress.TakeBatch(spinners, flies, pickups);
+	Check(spinners == 5 && flies == 0 && pickups == 0, "shares clamped to 0..1");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestReport()
+{
+	StressTest stress;
+	stress.Start(200.0f);
+
+	// 2 ms of each section a frame at 1000 ticks a second, 10 frames a second
+	RunReport(stress, 0.1f, 42, 2, 1000);
+	Check(stress.GetAverage(StressTestNS::TICK) > 1.99f && stress.GetAverage(StressTestNS::TICK) < 2.01f, "average of the report");
+	Check(strcmp(stress.GetReport(), "Stress 200/s, 42 entities: tick 2.00 ms, collisions 2.00 ms, render 2.00 ms, 10 fps") == 0,
+		"report text");
+
+	// Numbers too long for the buffer end the report early without writing past it
+	stress.Start(3.0e38f);
+	RunReport(stress, 0.1f, INT_MAX, LLONG_MAX / 16, 1);
+	const char *report = stress.GetReport();
+	size_t length = strlen(report);
+	Check(length == StressTestNS::BUFFER_SIZE - 1, "truncated report fills the buffer");
+	Check(strncmp(report, "Stress ", 7) == 0, "truncated report keeps its start");
+	Check(strstr(report, "fps") == NULL, "nothing appended after the buffer filled");
+	Check(stress.GetAverage(StressTestNS::RENDER) > 0.0f, "averages still worked out when truncated");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void TestLog()
+{
+	const char *file = "StressTestTest.csv";
+	StressTest stress;
+	stress.Start(50.0f);
+	stress.SetDuration(3.0f);
+	Check(stress.OpenLog(file), "log opened");
+	for (int i = 0; i < 3; ++i)
+	{
+		Check(!stress.IsFinished(), "not finished before the duration");
+		RunReport(stress, 0.25f, 7, 1, 1000);
+	}
+	Check(stress.IsFinished(), "finished after the duration");
+	stress.Stop();
+
+	// A header and one line a report
+	FILE *log = fopen(file, "r");
+	Check(log != NULL, "log written");
+	if (log == NULL)
+		return;
+	char line[256];
+	int lines = 0;
+	float seconds = 0.0f;
+	while (fgets(line, sizeof(line), log))
+	{
+		if (lines == 0)
+			Check(strncmp(line, "seconds,rate,entities,", 22) == 0, "log header");
+		else
+			Check(sscanf(line, "%f,", &seconds) == 1, "log line starts with the time");
+		lines++;
+	}
+	fclose(log);
+	remove(file);
+	Check(lines == 4, "one line a report");
+	Check(seconds > 2.99f && seconds < 3.01f, "last line at the duration");
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int main()
+{
+	TestBatches();
+	TestReport();
+	TestLog();
+
+	if (failures == 0)
+		printf("StressTest: all tests passed\n");
+	return failures == 0 ? 0 : 1;
+}